@@ -1,9 +1,37 @@
 #include "array.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 void array_destroy(const Array *const self) {
     assert(self != NULL);
     assert(self->array != NULL);
     free(self->array);
 }
+
+void array_copy(Array *const restrict self, const Array *const restrict source,
+                const size_t element_size) {
+    assert(self != NULL);
+    assert(self->array != NULL);
+    assert(source != NULL);
+    assert(source->array != NULL);
+    assert(element_size > 0);
+
+    array_resize(self, source->length, element_size);
+    memcpy(self->array, source->array, element_size * source->length);
+}
+
+void array_resize(Array *const self, const size_t length,
+                  const size_t element_size) {
+    assert(self != NULL);
+    assert(self->array != NULL);
+    assert(element_size > 0);
+
+    if (self->capacity < length || self->capacity / 2 > length) {
+        self->capacity = length > 0 ? length : 1;
+        self->array = realloc_or_exit(self->array,
+                                      element_size * self->capacity,
+                                      "failed to resize array");
+    }
+    self->length = length;
+}
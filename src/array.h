@@ -3,10 +3,23 @@
 #include <assert.h>
 
 #include "array_defs.h"
+#include "frame_arena.h"
 #include "utils.h"
 
 void array_destroy(const Array *const self);
 
+// Copy the elements of source, the capacity is fitted to the length when it is
+// too small or more than twice too large.
+[[gnu::nonnull]]
+void array_copy(Array *const restrict self, const Array *const restrict source,
+                const size_t element_size);
+
+// Set the length, the capacity is fitted like array_copy(). The elements past
+// the previous length are uninitialized.
+[[gnu::nonnull]]
+void array_resize(Array *const self, const size_t length,
+                  const size_t element_size);
+
 #define DEFINE_ARRAY(name, Name, type)                           \
     [[gnu::nonnull(1)]]                                          \
     void name##_array_init(Name##Array *const self,              \
@@ -56,3 +69,43 @@ void array_destroy(const Array *const self);
             self->array[i] = self->array[i + 1];                              \
         }                                                                     \
     }
+
+// Arrays allocated in a frame arena, freed when it is reset instead of by
+// array_destroy().
+#define DEFINE_ARENA_ARRAY(name, Name, type)                                   \
+    [[gnu::nonnull]]                                                           \
+    void name##_array_init_in_arena(Name##Array *const restrict self,          \
+                                    const size_t default_capacity,             \
+                                    FrameArena *const restrict arena);         \
+    [[gnu::nonnull(1, 3)]]                                                     \
+    void name##_array_push_in_arena(Name##Array *const restrict self,          \
+                                    type value,                                \
+                                    FrameArena *const restrict arena);
+
+#define ARENA_ARRAY_IMPLEMENTATION(name, Name, type)                          \
+    void name##_array_init_in_arena(Name##Array *const restrict self,         \
+                                    const size_t default_capacity,            \
+                                    FrameArena *const restrict arena) {       \
+        assert(self != NULL);                                                 \
+        assert(0 < default_capacity);                                         \
+        assert(arena != NULL);                                                \
+        self->array = frame_arena_alloc(                                      \
+            arena, sizeof(*self->array) * default_capacity);                  \
+        self->length = 0;                                                     \
+        self->capacity = default_capacity;                                    \
+    }                                                                         \
+                                                                              \
+    void name##_array_push_in_arena(Name##Array *const restrict self,         \
+                                    type value,                               \
+                                    FrameArena *const restrict arena) {       \
+        assert(self != NULL);                                                 \
+        assert(self->array != NULL);                                          \
+        assert(arena != NULL);                                                \
+        if (self->length == self->capacity) {                                 \
+            self->array = frame_arena_resize(                                 \
+                arena, self->array, sizeof(*self->array) * self->capacity,    \
+                sizeof(*self->array) * self->capacity * 2);                   \
+            self->capacity *= 2;                                              \
+        }                                                                     \
+        self->array[self->length++] = value;                                  \
+    }
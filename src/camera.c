@@ -197,25 +197,24 @@ void camera_update_frustum_planes(Camera *const self) {
                                                  sin_b);
 }
 
-[[gnu::nonnull]]
-static bool is_aabb_forward_plane(const Aabb *const restrict aabb,
-                                  const Plane *const restrict plane) {
-    assert(aabb != NULL);
-    assert(plane != NULL);
-    const v3f extents = v3f_mul(aabb->size, 0.5f);
-    const float r = v3f_dot(extents, v3f_abs(plane->normal));
-    const v3f center = v3f_add(aabb->position, extents);
-    return -r <= v3f_dot(plane->normal, center) - plane->distance;
-}
-
 bool camera_aabb_in_frustum(const Camera *const restrict self,
-                            const Aabb *const restrict aabb) {
+                            const Aabb *const restrict aabb,
+                            uint8_t *const restrict plane_mask) {
     assert(self != NULL);
     assert(aabb != NULL);
-    return (is_aabb_forward_plane(aabb, &self->frustum_planes.planes[0]) &&
-            is_aabb_forward_plane(aabb, &self->frustum_planes.planes[1]) &&
-            is_aabb_forward_plane(aabb, &self->frustum_planes.planes[2]) &&
-            is_aabb_forward_plane(aabb, &self->frustum_planes.planes[3]) &&
-            is_aabb_forward_plane(aabb, &self->frustum_planes.planes[4]) &&
-            is_aabb_forward_plane(aabb, &self->frustum_planes.planes[5]));
+
+    const v3f extents = v3f_mul(aabb->size, 0.5f);
+    const v3f center = v3f_add(aabb->position, extents);
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < 6; ++i) {
+        const Plane *const plane = &self->frustum_planes.planes[i];
+        // The bounding box is within r of its center along the normal.
+        const float r = v3f_dot(extents, v3f_abs(plane->normal));
+        const float distance =
+            v3f_dot(plane->normal, center) - plane->distance;
+        if (distance < -r) return false;
+        if (distance < r) mask |= 1 << i;
+    }
+    if (plane_mask != NULL) *plane_mask = mask;
+    return true;
 }
@@ -27,6 +27,10 @@ void camera_rotate(Camera *const self, const v2f rotation);
 [[gnu::nonnull]]
 void camera_update_frustum_planes(Camera *const self);
 
-[[gnu::nonnull]]
+// Return false when the bounding box is outside the view frustum, otherwise set
+// the planes of the frustum crossing it in plane_mask, unless it is NULL. The
+// plane mask is 0 when the bounding box is inside the frustum.
+[[gnu::nonnull(1, 2)]]
 bool camera_aabb_in_frustum(const Camera *const restrict self,
-                            const Aabb *const restrict aabb);
+                            const Aabb *const restrict aabb,
+                            uint8_t *const restrict plane_mask);
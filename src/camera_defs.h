@@ -2,6 +2,9 @@
 
 #include "vec_defs.h"
 
+// Bit i of a plane mask stands for the plane i of the view frustum.
+#define CAMERA_FRUSTUM_PLANE_MASK_ALL ((1 << 6) - 1)
+
 typedef struct {
     v3f normal;
     float distance;
@@ -24,12 +27,13 @@ typedef struct {
         };
         Plane planes[6];
     } frustum_planes_in_camera_space;
+    // In the same order as frustum_planes_in_camera_space.
     union {
         struct {
             Plane near;
+            Plane bottom;
             Plane left;
             Plane right;
-            Plane bottom;
             Plane top;
             Plane far;
         };
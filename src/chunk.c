@@ -0,0 +1,209 @@
+#include "chunk.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chunk_mesh.h"
+#include "log.h"
+#include "utils.h"
+
+Chunk *chunk_create(const int x, const int z, const int8_t player_index) {
+    assert(0 <= player_index && player_index < 4);
+    Chunk *const self = malloc_or_exit(sizeof(*self), "failed to create chunk");
+
+    for (uint8_t i = 0; i < CHUNK_SECTIONS_NUMBER; ++i) {
+        chunk_section_init(&self->sections[i], BLOCK_TYPE_AIR);
+    }
+    memset(self->occupancy, 0, sizeof(self->occupancy));
+
+    for (uint8_t i = 0; i < 2; ++i) {
+        for (uint8_t j = 0; j < CHUNK_SECTIONS_NUMBER; ++j) {
+            chunk_mesh_init(&self->meshes[i][j], 64, 64);
+        }
+        chunk_mesh_init(&self->greedy_meshes[i], 256, 256);
+        for (uint8_t j = 0; j < MESH_LOD_LEVELS_NUMBER; ++j) {
+            chunk_mesh_init(&self->lod_meshes[i][j], 64, 64);
+        }
+    }
+
+    chunk_reset(self, x, z, player_index);
+    return self;
+}
+
+void chunk_reset(Chunk *const self, const int x, const int z,
+                 const int8_t player_index) {
+    assert(self != NULL);
+    assert(0 <= player_index && player_index < 4);
+    log_debugf("load chunk (%d, %d)", x, z);
+
+    self->x = x;
+    self->z = z;
+    self->aabb.position = (v3f){x * CHUNK_SIZE, 0.0f, z * CHUNK_SIZE};
+    self->aabb.size = (v3f){CHUNK_SIZE, 0.0f, CHUNK_SIZE};
+    self->pending = true;
+    self->unloaded = false;
+    self->modified = false;
+
+    for (uint8_t i = 0; i < 4; ++i) {
+        self->loaded_by[i] = false;
+    }
+    self->loaded_by[player_index] = true;
+
+    for (uint8_t i = 0; i < 2; ++i) {
+        for (uint8_t j = 0; j < CHUNK_SECTIONS_NUMBER; ++j) {
+            chunk_mesh_clear(&self->meshes[i][j]);
+        }
+        chunk_mesh_clear(&self->greedy_meshes[i]);
+        for (uint8_t j = 0; j < MESH_LOD_LEVELS_NUMBER; ++j) {
+            chunk_mesh_clear(&self->lod_meshes[i][j]);
+        }
+    }
+    atomic_init(&self->front_meshes, 0);
+    self->built_meshes = 0;
+    self->stale_meshes = CHUNK_MESH_ALL;
+    self->greedy_mesh_overflows = false;
+    atomic_init(&self->mesh_requests, 0);
+    self->mesh_dirty_sections = CHUNK_SECTION_MASK_ALL;
+    self->dirty_meshes = CHUNK_MESH_WHOLE_CHUNK;
+    self->mesh_queued = false;
+    atomic_init(&self->render_cost, 0);
+}
+
+void chunk_destroy(Chunk *const self) {
+    assert(self != NULL);
+    for (uint8_t i = 0; i < 2; ++i) {
+        for (uint8_t j = 0; j < CHUNK_SECTIONS_NUMBER; ++j) {
+            chunk_mesh_destroy(&self->meshes[i][j]);
+        }
+        chunk_mesh_destroy(&self->greedy_meshes[i]);
+        for (uint8_t j = 0; j < MESH_LOD_LEVELS_NUMBER; ++j) {
+            chunk_mesh_destroy(&self->lod_meshes[i][j]);
+        }
+    }
+    for (uint8_t i = 0; i < CHUNK_SECTIONS_NUMBER; ++i) {
+        chunk_section_destroy(&self->sections[i]);
+    }
+    free(self);
+}
+
+[[gnu::nonnull]]
+static inline void chunk_height_clear(ChunkHeight *const self) {
+    assert(self != NULL);
+    self->min_y = CHUNK_HEIGHT;
+    self->max_y = -1;
+}
+
+void chunk_update_occupancy(Chunk *const self) {
+    assert(self != NULL);
+
+    for (int i = 0; i < CHUNK_SECTIONS_NUMBER; ++i) {
+        const ChunkSection *const section = &self->sections[i];
+        ChunkRowMask(*const rows)[CHUNK_SIZE] =
+            &self->occupancy[i * CHUNK_SECTION_HEIGHT];
+
+        if (chunk_section_is_uniform(section)) {
+            const ChunkRowMask row =
+                chunk_section_is_empty(section) ? 0 : CHUNK_ROW_MASK_FULL;
+            for (int y = 0; y < CHUNK_SECTION_HEIGHT; ++y) {
+                for (int z = 0; z < CHUNK_SIZE; ++z) {
+                    rows[y][z] = row;
+                }
+            }
+            continue;
+        }
+
+        for (int y = 0; y < CHUNK_SECTION_HEIGHT; ++y) {
+            for (int z = 0; z < CHUNK_SIZE; ++z) {
+                ChunkRowMask row = 0;
+                for (int x = 0; x < CHUNK_SIZE; ++x) {
+                    if (chunk_section_get_block(section,
+                                                chunk_section_index(x, y, z)) !=
+                        BLOCK_TYPE_AIR) {
+                        row |= 1u << x;
+                    }
+                }
+                rows[y][z] = row;
+            }
+        }
+    }
+}
+
+void chunk_update_heightmap(Chunk *const self) {
+    assert(self != NULL);
+
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            chunk_height_clear(&self->heightmap[z][x]);
+        }
+    }
+
+    for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+        for (int z = 0; z < CHUNK_SIZE; ++z) {
+            for (unsigned int row = self->occupancy[y][z]; row != 0;
+                 row &= row - 1) {
+                ChunkHeight *const height =
+                    &self->heightmap[z][__builtin_ctz(row)];
+                if (height->max_y < 0) height->min_y = y;
+                height->max_y = y;
+            }
+        }
+    }
+
+    chunk_update_aabb(self);
+}
+
+void chunk_update_aabb(Chunk *const self) {
+    assert(self != NULL);
+
+    int min_y = CHUNK_HEIGHT;
+    int max_y = -1;
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            min_y = min_int(min_y, self->heightmap[z][x].min_y);
+            max_y = max_int(max_y, self->heightmap[z][x].max_y);
+        }
+    }
+
+    if (max_y < 0) {
+        self->aabb.position.y = -1.0f;
+        self->aabb.size.y = -1.0f;
+        return;
+    }
+    self->aabb.position.y = min_y;
+    self->aabb.size.y = max_y + 1.0f - min_y;
+}
+
+void chunk_set_block(Chunk *const self, const int x, const int y, const int z,
+                     const BlockType type) {
+    assert(self != NULL);
+    assert(0 <= y && y < CHUNK_HEIGHT);
+
+    chunk_section_set_block(
+        &self->sections[y / CHUNK_SECTION_HEIGHT],
+        chunk_section_index(x, y % CHUNK_SECTION_HEIGHT, z), type);
+
+    if (type != BLOCK_TYPE_AIR) {
+        self->occupancy[y][z] |= 1u << x;
+    } else {
+        self->occupancy[y][z] &= ~(1u << x);
+    }
+
+    ChunkHeight *const height = &self->heightmap[z][x];
+    if (type != BLOCK_TYPE_AIR) {
+        height->min_y = min_int(height->min_y, y);
+        height->max_y = max_int(height->max_y, y);
+    } else if (y == height->max_y || y == height->min_y) {
+        while (height->max_y >= height->min_y &&
+               !chunk_block_is_solid(self, x, height->max_y, z)) {
+            --height->max_y;
+        }
+        while (height->min_y <= height->max_y &&
+               !chunk_block_is_solid(self, x, height->min_y, z)) {
+            ++height->min_y;
+        }
+        if (height->min_y > height->max_y) chunk_height_clear(height);
+    }
+
+    chunk_update_aabb(self);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "chunk_defs.h"
+#include "chunk_section.h"
+
+[[gnu::returns_nonnull]]
+Chunk *chunk_create(const int x, const int z, const int8_t player_index);
+
+// Reuse a chunk for new coordinates, keeping its allocations. The blocks are
+// left as is until the chunk is generated.
+[[gnu::nonnull]]
+void chunk_reset(Chunk *const self, const int x, const int z,
+                 const int8_t player_index);
+
+[[gnu::nonnull]]
+void chunk_destroy(Chunk *const self);
+
+// Compute the occupancy from the blocks.
+[[gnu::nonnull]]
+void chunk_update_occupancy(Chunk *const self);
+
+// Compute the heightmap and the AABB from the occupancy.
+[[gnu::nonnull]]
+void chunk_update_heightmap(Chunk *const self);
+
+// Compute the AABB from the heightmap.
+[[gnu::nonnull]]
+void chunk_update_aabb(Chunk *const self);
+
+[[gnu::nonnull]]
+static inline bool chunk_need_to_be_loaded(const Chunk *const self) {
+    assert(self != NULL);
+    return self->loaded_by[0] || self->loaded_by[1] || self->loaded_by[2] ||
+           self->loaded_by[3];
+}
+
+[[gnu::nonnull]]
+static inline BlockType chunk_get_block(const Chunk *const self, const int x,
+                                        const int y, const int z) {
+    assert(self != NULL);
+    assert(0 <= y && y < CHUNK_HEIGHT);
+    return chunk_section_get_block(
+        &self->sections[y / CHUNK_SECTION_HEIGHT],
+        chunk_section_index(x, y % CHUNK_SECTION_HEIGHT, z));
+}
+
+[[gnu::nonnull]]
+static inline ChunkRowMask chunk_get_row_mask(const Chunk *const self,
+                                              const int y, const int z) {
+    assert(self != NULL);
+    assert(0 <= y && y < CHUNK_HEIGHT);
+    assert(0 <= z && z < CHUNK_SIZE);
+    return self->occupancy[y][z];
+}
+
+[[gnu::nonnull]]
+static inline bool chunk_block_is_solid(const Chunk *const self, const int x,
+                                        const int y, const int z) {
+    assert(0 <= x && x < CHUNK_SIZE);
+    return chunk_get_row_mask(self, y, z) >> x & 1;
+}
+
+// Blocks of a row whose neighbour on the -x side is solid, the first one being
+// the last block of the row of the left chunk.
+static inline ChunkRowMask chunk_row_mask_left_neighbours(
+    const ChunkRowMask row, const ChunkRowMask left_row) {
+    return (ChunkRowMask)(row << 1 | left_row >> (CHUNK_SIZE - 1)) &
+           CHUNK_ROW_MASK_FULL;
+}
+
+// Blocks of a row whose neighbour on the +x side is solid, the last one being
+// the first block of the row of the right chunk.
+static inline ChunkRowMask chunk_row_mask_right_neighbours(
+    const ChunkRowMask row, const ChunkRowMask right_row) {
+    return (ChunkRowMask)(row >> 1 | (right_row & 1) << (CHUNK_SIZE - 1));
+}
+
+// Set a block, updating the occupancy, the heightmap and the AABB.
+[[gnu::nonnull]]
+void chunk_set_block(Chunk *const self, const int x, const int y, const int z,
+                     const BlockType type);
+
+// Return the y above the highest non air block of the column, 0 if the column
+// is empty.
+[[gnu::nonnull]]
+static inline int chunk_get_height(const Chunk *const self, const int x,
+                                   const int z) {
+    assert(self != NULL);
+    assert(0 <= x && x < CHUNK_SIZE);
+    assert(0 <= z && z < CHUNK_SIZE);
+    return self->heightmap[z][x].max_y + 1;
+}
@@ -0,0 +1,3 @@
+#include "chunk_array.h"
+
+ARRAY_IMPLEMENTATION(chunk, Chunk, Chunk *)
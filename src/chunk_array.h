@@ -0,0 +1,6 @@
+#pragma once
+
+#include "array.h"
+#include "chunk_array_defs.h"
+
+DEFINE_ARRAY(chunk, Chunk, Chunk *)
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "array_defs.h"
+#include "chunk_defs.h"
+
+DEFINE_ARRAY_TYPE(Chunk, Chunk *);
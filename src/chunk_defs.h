@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "block.h"
+#include "chunk_mesh_defs.h"
+#include "chunk_section_defs.h"
+#include "collision_defs.h"
+#include "config.h"
+
+// Lowest and highest non air blocks of a column, an empty column has a
+// min_y of CHUNK_HEIGHT and a max_y of -1.
+typedef struct {
+    int16_t min_y, max_y;
+} ChunkHeight;
+
+// One bit per block of a row along the x axis, set if the block is not air.
+typedef uint16_t ChunkRowMask;
+static_assert(CHUNK_SIZE <= sizeof(ChunkRowMask) * 8);
+
+#define CHUNK_ROW_MASK_FULL ((ChunkRowMask)((1u << CHUNK_SIZE) - 1))
+
+// One bit per section of a chunk.
+typedef uint16_t ChunkSectionMask;
+static_assert(CHUNK_SECTIONS_NUMBER <= sizeof(ChunkSectionMask) * 8);
+
+#define CHUNK_SECTION_MASK_ALL \
+    ((ChunkSectionMask)((1u << CHUNK_SECTIONS_NUMBER) - 1))
+
+// Bit flags of the kinds of meshes of a chunk, from the most to the least
+// detailed.
+typedef enum : uint8_t {
+    CHUNK_MESH_DETAILED = 1 << 0,
+    CHUNK_MESH_GREEDY = 1 << 1,
+    // Followed by one bit per level of detail, see CHUNK_MESH_LOD().
+    CHUNK_MESH_ALL = (1 << (MESH_LOD_LEVELS_NUMBER + 2)) - 1,
+} ChunkMeshKind;
+
+// Kinds of the meshes covering the whole chunk.
+#define CHUNK_MESH_WHOLE_CHUNK (CHUNK_MESH_ALL & ~CHUNK_MESH_DETAILED)
+
+#define CHUNK_MESH_LOD(level) \
+    ((ChunkMeshKind)(CHUNK_MESH_GREEDY << 1 << (level)))
+
+// Bits of the mesh buffer masks for the greedy mesh and the levels of detail,
+// in the order of their kinds. The bits below are the meshes of the sections.
+#define CHUNK_GREEDY_MESH_BIT CHUNK_SECTIONS_NUMBER
+#define CHUNK_LOD_MESH_BIT(level) (CHUNK_GREEDY_MESH_BIT + 1 + (level))
+static_assert(CHUNK_LOD_MESH_BIT(MESH_LOD_LEVELS_NUMBER - 1) < 32);
+
+typedef struct Chunk {
+    int x, z;
+    Aabb aabb;
+    // The meshes are double buffered: the render threads draw the front
+    // buffers while the chunk mesher builds the back ones.
+    ChunkMesh meshes[2][CHUNK_SECTIONS_NUMBER];  // one per section
+    // Mesh with the adjacent coplanar faces of the same block merged, used
+    // when the chunk is too far for the outlines to be drawn.
+    ChunkMesh greedy_meshes[2];
+    // Surfaces of the heightmap, used for the far chunks.
+    ChunkMesh lod_meshes[2][MESH_LOD_LEVELS_NUMBER];
+    // Index of the front buffer of each mesh, swapped by
+    // chunk_mesher_collect().
+    _Atomic uint32_t front_meshes;
+    // Kinds of meshes built at least once and kinds whose front buffers are
+    // outdated, only written by the main thread.
+    ChunkMeshKind built_meshes;
+    ChunkMeshKind stale_meshes;
+    // The greedy mesh has too many vertices to be indexed, the section meshes
+    // are drawn in its place. Only written by the main thread.
+    bool greedy_mesh_overflows;
+    // Kinds of meshes waited for by the render threads.
+    _Atomic uint8_t mesh_requests;
+    // Protected by the mutex of the chunk mesher, the outdated section meshes
+    // and the outdated kinds of CHUNK_MESH_WHOLE_CHUNK.
+    ChunkSectionMask mesh_dirty_sections;
+    ChunkMeshKind dirty_meshes;
+    // Queued, being built or waiting to be collected.
+    bool mesh_queued;
+    // Kinds of meshes and back buffers of the current build.
+    ChunkMeshKind meshing_kinds;
+    uint32_t meshing_buffers;
+    bool meshing_greedy_mesh_overflows;
+    // Time taken by its last render in ns, used to balance the render threads.
+    _Atomic uint32_t render_cost;
+    // The chunk is waiting for the chunk generator, its blocks must not be
+    // read until it is collected by world_update().
+    bool pending;
+    // The chunk was unloaded while it was generated, it will be destroyed once
+    // the generator hands it back.
+    bool unloaded;
+    // The blocks were edited since the chunk was generated or loaded from the
+    // disk, it must be saved when it is unloaded.
+    bool modified;
+    bool loaded_by[4];
+    ChunkSection sections[CHUNK_SECTIONS_NUMBER];  // from bottom to top
+    ChunkHeight heightmap[CHUNK_SIZE][CHUNK_SIZE];  // heightmap[z][x]
+    ChunkRowMask occupancy[CHUNK_HEIGHT][CHUNK_SIZE];  // occupancy[y][z]
+} Chunk;
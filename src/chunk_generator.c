@@ -0,0 +1,415 @@
+#include "chunk_generator.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chunk.h"
+#include "chunk_array.h"
+#include "chunk_queue.h"
+#include "chunk_section.h"
+#ifndef __wasm__
+#include "chunk_storage.h"
+#endif
+#include "log.h"
+#include "perlin_noise.h"
+#include "threads.h"
+#include "utils.h"
+#include "vec.h"
+
+typedef struct {
+    int max_y;
+    int max_stone_y;
+    int min_snow_y;
+    bool is_desert;
+} ChunkColumn;
+
+// The noises are the values of perlin_noise() for the column, with the seeds
+// seed to seed + 3.
+[[gnu::nonnull]]
+static void chunk_column_init(ChunkColumn *const self,
+                              const float terrain_height_noise,
+                              const float desert_noise,
+                              const float surface_layer_thickness_noise,
+                              const float min_snow_min_height_variation_noise) {
+    assert(self != NULL);
+    assert(0.0f <= terrain_height_noise);
+    assert(terrain_height_noise <= 1.0f);
+    assert(0.0f <= desert_noise);
+    assert(desert_noise <= 1.0f);
+    assert(0.0f <= surface_layer_thickness_noise &&
+           surface_layer_thickness_noise <= 1.0f);
+    assert(0.0f <= min_snow_min_height_variation_noise);
+    assert(min_snow_min_height_variation_noise <= 1.0f);
+
+    const float terrain_height =
+        powf(terrain_height_noise, CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_POW);
+    self->max_y = terrain_height * (CHUNK_GENERATION_MAX_TERRAIN_HEIGHT -
+                                    CHUNK_GENERATION_MIN_TERRAIN_HEIGHT) +
+                  CHUNK_GENERATION_MIN_TERRAIN_HEIGHT;
+
+    const int surface_layer_thickness =
+        surface_layer_thickness_noise *
+            (CHUNK_GENERATION_SURFACE_LAYER_MAX_THICKNESS -
+             CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS) +
+        CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS;
+    assert(CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS <=
+           surface_layer_thickness);
+    assert(surface_layer_thickness <=
+           CHUNK_GENERATION_SURFACE_LAYER_MAX_THICKNESS);
+
+    self->max_stone_y = self->max_y - surface_layer_thickness;
+
+    self->is_desert = desert_noise > CHUNK_GENERATION_DESERT_NOISE_THRESHOLD;
+
+    const int min_snow_min_height_variation =
+        min_snow_min_height_variation_noise *
+            CHUNK_GENERATION_MIN_SNOW_HEIGHT_VARIATION * 2 -
+        CHUNK_GENERATION_MIN_SNOW_HEIGHT_VARIATION;
+    self->min_snow_y =
+        CHUNK_GENERATION_MIN_SNOW_HEIGHT + min_snow_min_height_variation;
+}
+
+[[gnu::nonnull]]
+static inline BlockType chunk_column_get_block_type(
+    const ChunkColumn *const self, const int y) {
+    assert(self != NULL);
+    if (y == 0) return BLOCK_TYPE_BEDROCK;
+    if (y <= self->max_stone_y) return BLOCK_TYPE_STONE;
+    if (y > self->max_y) return BLOCK_TYPE_AIR;
+    if (y > self->min_snow_y) return BLOCK_TYPE_SNOW;
+    if (self->is_desert) return BLOCK_TYPE_SAND;
+    if (y == self->max_y) return BLOCK_TYPE_GRASS;
+    return BLOCK_TYPE_DIRT;
+}
+
+[[gnu::nonnull]]
+static void chunk_generate(Chunk *const self, const uint32_t seed) {
+    assert(self != NULL);
+
+#if !defined(PROD) && !defined(LOG_LEVEL_ERROR)
+    const uint64_t start = get_time_microseconds();
+#endif
+
+    const v2i chunk_origin = {
+        .x = self->x * CHUNK_SIZE,
+        .y = self->z * CHUNK_SIZE,
+    };
+
+    float terrain_height_noises[CHUNK_SIZE * CHUNK_SIZE];
+    float desert_noises[CHUNK_SIZE * CHUNK_SIZE];
+    float surface_layer_thickness_noises[CHUNK_SIZE * CHUNK_SIZE];
+    float min_snow_min_height_variation_noises[CHUNK_SIZE * CHUNK_SIZE];
+    perlin_noise_grid_coarse(
+        terrain_height_noises, chunk_origin, CHUNK_SIZE, CHUNK_SIZE, seed,
+        CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_FREQUENCY,
+        CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_DEPTH,
+        CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_RESOLUTION);
+    perlin_noise_grid_coarse(desert_noises, chunk_origin, CHUNK_SIZE,
+                             CHUNK_SIZE, seed + 1,
+                             CHUNK_GENERATION_DESERT_NOISE_FREQUENCY,
+                             CHUNK_GENERATION_DESERT_NOISE_DEPTH,
+                             CHUNK_GENERATION_DESERT_NOISE_RESOLUTION);
+    perlin_noise_grid_coarse(surface_layer_thickness_noises, chunk_origin,
+                             CHUNK_SIZE, CHUNK_SIZE, seed + 2,
+                             CHUNK_GENERATION_SURFACE_LAYER_NOISE_FREQUENCY,
+                             CHUNK_GENERATION_SURFACE_LAYER_NOISE_DEPTH,
+                             CHUNK_GENERATION_SURFACE_LAYER_NOISE_RESOLUTION);
+    perlin_noise_grid_coarse(
+        min_snow_min_height_variation_noises, chunk_origin, CHUNK_SIZE,
+        CHUNK_SIZE, seed + 3, CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_FREQUENCY,
+        CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_DEPTH,
+        CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_RESOLUTION);
+
+    ChunkColumn columns[CHUNK_SIZE][CHUNK_SIZE];  // columns[z][x]
+    int min_stone_y = CHUNK_HEIGHT;
+    int max_y = 0;
+    for (int z = 0; z < CHUNK_SIZE; ++z) {
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            ChunkColumn *const column = &columns[z][x];
+            const int i = z * CHUNK_SIZE + x;
+            chunk_column_init(column, terrain_height_noises[i],
+                              desert_noises[i],
+                              surface_layer_thickness_noises[i],
+                              min_snow_min_height_variation_noises[i]);
+            // The bedrock is always at the bottom.
+            self->heightmap[z][x] = (ChunkHeight){
+                .min_y = 0,
+                .max_y = max_int(column->max_y, 0),
+            };
+            min_stone_y = min_int(min_stone_y, column->max_stone_y);
+            max_y = max_int(max_y, column->max_y);
+        }
+    }
+
+    BlockType blocks[CHUNK_SECTION_VOLUME];
+    for (int i = 0; i < CHUNK_SECTIONS_NUMBER; ++i) {
+        ChunkSection *const section = &self->sections[i];
+        const int section_y = i * CHUNK_SECTION_HEIGHT;
+
+        // Most sections are entirely above or below the surface.
+        if (section_y > max_y) {
+            chunk_section_clear(section, BLOCK_TYPE_AIR);
+            continue;
+        }
+        if (section_y > 0 &&
+            section_y + CHUNK_SECTION_HEIGHT - 1 <= min_stone_y) {
+            chunk_section_clear(section, BLOCK_TYPE_STONE);
+            continue;
+        }
+
+        for (int y = 0; y < CHUNK_SECTION_HEIGHT; ++y) {
+            for (int z = 0; z < CHUNK_SIZE; ++z) {
+                for (int x = 0; x < CHUNK_SIZE; ++x) {
+                    blocks[chunk_section_index(x, y, z)] =
+                        chunk_column_get_block_type(&columns[z][x],
+                                                    section_y + y);
+                }
+            }
+        }
+        chunk_section_fill(section, blocks);
+    }
+    chunk_update_occupancy(self);
+    chunk_update_aabb(self);
+
+    log_debugf("generated chunk (%d, %d) in %f ms", self->x, self->z,
+               (get_time_microseconds() - start) / 1000.0f);
+}
+
+[[gnu::nonnull]]
+static void chunk_generator_process(const ChunkGenerator *const restrict self,
+                                    Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+#ifndef __wasm__
+    if (self->storage != NULL && chunk_storage_load(self->storage, chunk)) {
+        chunk_update_occupancy(chunk);
+        chunk_update_heightmap(chunk);
+        return;
+    }
+#endif
+    chunk_generate(chunk, self->seed);
+}
+
+[[gnu::nonnull]]
+static int chunk_generator_get_priority(const ChunkGenerator *const self,
+                                        const Chunk *const chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+    int priority = INT_MAX;
+    for (uint8_t i = 0; i < 4; ++i) {
+        if (!self->has_player[i]) continue;
+        const int dx = chunk->x - self->player_chunk_positions[i].x;
+        const int dz = chunk->z - self->player_chunk_positions[i].y;
+        priority = min_int(priority, dx * dx + dz * dz);
+    }
+    return priority;
+}
+
+// Called with the mutex locked once a chunk is generated.
+[[gnu::nonnull]]
+static void chunk_generator_add_generated(ChunkGenerator *const restrict self,
+                                          Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    chunk_array_push(&self->generated_chunks, chunk);
+}
+
+#ifndef __wasm__
+[[gnu::nonnull]]
+static void *chunk_generator_thread(void *const data) {
+    assert(data != NULL);
+
+    ChunkGenerator *const self = data;
+
+    mutex_lock(&self->mutex);
+    while (true) {
+        while (self->running && chunk_queue_is_empty(&self->queue)) {
+            pthread_cond_wait(&self->queue_condition, &self->mutex);
+        }
+        if (!self->running) break;
+
+        Chunk *const chunk = chunk_queue_pop(&self->queue);
+        mutex_unlock(&self->mutex);
+
+        chunk_generator_process(self, chunk);
+
+        mutex_lock(&self->mutex);
+        chunk_generator_add_generated(self, chunk);
+        pthread_cond_broadcast(&self->generated_condition);
+    }
+    mutex_unlock(&self->mutex);
+
+    return NULL;
+}
+#endif
+
+void chunk_generator_init(ChunkGenerator *const restrict self,
+                          const uint32_t seed,
+                          ChunkStorage *const restrict storage) {
+    assert(self != NULL);
+
+    chunk_queue_init(&self->queue, (WORLD_LOAD_DISTANCE * 2 + 1) *
+                                       (WORLD_LOAD_DISTANCE * 2 + 1));
+    chunk_array_init(&self->generated_chunks, WORLD_LOAD_DISTANCE * 2 + 1);
+    for (uint8_t i = 0; i < 4; ++i) {
+        self->has_player[i] = false;
+    }
+    self->seed = seed;
+    self->storage = storage;
+
+#ifndef __wasm__
+    pthread_mutex_init(&self->mutex, NULL);
+    pthread_cond_init(&self->queue_condition, NULL);
+    pthread_cond_init(&self->generated_condition, NULL);
+    self->running = true;
+    for (size_t i = 0; i < CHUNK_GENERATION_THREADS_NUMBER; ++i) {
+        const int return_code = pthread_create(
+            &self->threads[i], NULL, chunk_generator_thread, self);
+        if (return_code != 0) {
+            log_errorf("failed to create chunk generation thread: %s",
+                       strerror(return_code));
+            exit(EXIT_FAILURE);
+        }
+    }
+#endif
+}
+
+void chunk_generator_destroy(ChunkGenerator *const self) {
+    assert(self != NULL);
+
+#ifndef __wasm__
+    mutex_lock(&self->mutex);
+    self->running = false;
+    pthread_cond_broadcast(&self->queue_condition);
+    mutex_unlock(&self->mutex);
+
+    for (size_t i = 0; i < CHUNK_GENERATION_THREADS_NUMBER; ++i) {
+        const int return_code = pthread_join(self->threads[i], NULL);
+        if (return_code != 0) {
+            log_errorf("failed to join chunk generation thread: %s",
+                       strerror(return_code));
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    pthread_cond_destroy(&self->generated_condition);
+    pthread_cond_destroy(&self->queue_condition);
+    mutex_destroy(&self->mutex);
+#endif
+
+    // The other chunks are still owned by the world.
+    for (size_t i = 0; i < self->generated_chunks.length; ++i) {
+        if (self->generated_chunks.array[i]->unloaded) {
+            chunk_destroy(self->generated_chunks.array[i]);
+        }
+    }
+
+    array_destroy((const Array *)&self->generated_chunks);
+    chunk_queue_destroy(&self->queue);
+}
+
+void chunk_generator_push(ChunkGenerator *const restrict self,
+                          Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(chunk->pending);
+
+    mutex_lock(&self->mutex);
+    chunk_queue_push(&self->queue, chunk,
+                     chunk_generator_get_priority(self, chunk));
+#ifndef __wasm__
+    pthread_cond_signal(&self->queue_condition);
+#endif
+    mutex_unlock(&self->mutex);
+}
+
+bool chunk_generator_cancel(ChunkGenerator *const restrict self,
+                            Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(chunk->pending);
+
+    mutex_lock(&self->mutex);
+    const bool removed = chunk_queue_remove(&self->queue, chunk);
+    if (!removed) chunk->unloaded = true;
+    mutex_unlock(&self->mutex);
+    return removed;
+}
+
+void chunk_generator_wait(ChunkGenerator *const restrict self,
+                          Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(chunk->pending);
+    assert(!chunk->unloaded);
+
+    mutex_lock(&self->mutex);
+    if (chunk_queue_remove(&self->queue, chunk)) {
+        mutex_unlock(&self->mutex);
+        chunk_generator_process(self, chunk);
+        mutex_lock(&self->mutex);
+        chunk_generator_add_generated(self, chunk);
+        mutex_unlock(&self->mutex);
+        return;
+    }
+
+    while (true) {
+        for (size_t i = 0; i < self->generated_chunks.length; ++i) {
+            if (self->generated_chunks.array[i] == chunk) {
+                mutex_unlock(&self->mutex);
+                return;
+            }
+        }
+#ifndef __wasm__
+        pthread_cond_wait(&self->generated_condition, &self->mutex);
+#else
+        assert(false && "pending chunk neither queued nor generated");
+        return;
+#endif
+    }
+}
+
+void chunk_generator_collect(ChunkGenerator *const restrict self,
+                             ChunkArray *const restrict chunks) {
+    assert(self != NULL);
+    assert(chunks != NULL);
+
+#ifdef __wasm__
+    // Without threads, spread the generation over the frames.
+    for (int i = 0; i < CHUNK_GENERATION_CHUNKS_PER_FRAME &&
+                    !chunk_queue_is_empty(&self->queue);
+         ++i) {
+        Chunk *const chunk = chunk_queue_pop(&self->queue);
+        chunk_generator_process(self, chunk);
+        chunk_generator_add_generated(self, chunk);
+    }
+#endif
+
+    mutex_lock(&self->mutex);
+    for (size_t i = 0; i < self->generated_chunks.length; ++i) {
+        chunk_array_push(chunks, self->generated_chunks.array[i]);
+    }
+    self->generated_chunks.length = 0;
+    mutex_unlock(&self->mutex);
+}
+
+void chunk_generator_set_player_position(ChunkGenerator *const self,
+                                         const int8_t player_index,
+                                         const v2i chunk_position) {
+    assert(self != NULL);
+    assert(0 <= player_index && player_index < 4);
+
+    mutex_lock(&self->mutex);
+    self->player_chunk_positions[player_index] = chunk_position;
+    self->has_player[player_index] = true;
+    for (size_t i = 0; i < self->queue.length; ++i) {
+        self->queue.array[i].priority =
+            chunk_generator_get_priority(self, self->queue.array[i].chunk);
+    }
+    chunk_queue_heapify(&self->queue);
+    mutex_unlock(&self->mutex);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "chunk_array_defs.h"
+#include "chunk_generator_defs.h"
+
+[[gnu::nonnull(1)]]
+void chunk_generator_init(ChunkGenerator *const restrict self,
+                          const uint32_t seed,
+                          ChunkStorage *const restrict storage);
+
+[[gnu::nonnull]]
+void chunk_generator_destroy(ChunkGenerator *const self);
+
+[[gnu::nonnull]]
+void chunk_generator_push(ChunkGenerator *const restrict self,
+                          Chunk *const restrict chunk);
+
+// Remove a chunk from the generator, return false if the chunk is already
+// being generated: it is then flagged as unloaded and still handed back by
+// chunk_generator_collect().
+[[gnu::nonnull]]
+bool chunk_generator_cancel(ChunkGenerator *const restrict self,
+                            Chunk *const restrict chunk);
+
+// Block until the chunk is generated, generating it on the calling thread if
+// no worker has started it yet. It still needs to be collected.
+[[gnu::nonnull]]
+void chunk_generator_wait(ChunkGenerator *const restrict self,
+                          Chunk *const restrict chunk);
+
+// Move the generated chunks at the end of the chunks array.
+[[gnu::nonnull]]
+void chunk_generator_collect(ChunkGenerator *const restrict self,
+                             ChunkArray *const restrict chunks);
+
+[[gnu::nonnull]]
+void chunk_generator_set_player_position(ChunkGenerator *const self,
+                                         const int8_t player_index,
+                                         const v2i chunk_position);
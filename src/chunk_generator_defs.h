@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef __wasm__
+#include <pthread.h>
+#endif
+#include <stdint.h>
+
+#include "chunk_array_defs.h"
+#include "chunk_queue_defs.h"
+#include "config.h"
+#include "vec_defs.h"
+
+typedef struct ChunkStorage ChunkStorage;
+
+typedef struct {
+    // Chunks waiting to be generated, the ones nearest to a player first.
+    ChunkQueue queue;
+    // Generated chunks waiting to be collected by the world.
+    ChunkArray generated_chunks;
+    v2i player_chunk_positions[4];
+    bool has_player[4];
+    uint32_t seed;
+    // Saved chunks are loaded instead of being generated, NULL to always
+    // generate them.
+    ChunkStorage *storage;
+#ifndef __wasm__
+    pthread_mutex_t mutex;
+    pthread_cond_t queue_condition;
+    pthread_cond_t generated_condition;
+    pthread_t threads[CHUNK_GENERATION_THREADS_NUMBER];
+    bool running;
+#endif
+} ChunkGenerator;
@@ -0,0 +1,111 @@
+#include "chunk_map.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "utils.h"
+
+static inline size_t chunk_map_hash(const int x, const int z) {
+    uint32_t hash = (uint32_t)x * 0x9e3779b1u ^ (uint32_t)z * 0x85ebca77u;
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+[[gnu::nonnull]]
+static inline size_t chunk_map_find_slot(const ChunkMap *const self,
+                                         const int x, const int z) {
+    assert(self != NULL);
+
+    const size_t mask = self->capacity - 1;
+    size_t i = chunk_map_hash(x, z) & mask;
+    while (self->slots[i].chunk != NULL &&
+           (self->slots[i].x != x || self->slots[i].z != z)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+[[gnu::nonnull]]
+static void chunk_map_grow(ChunkMap *const self) {
+    assert(self != NULL);
+
+    ChunkMapSlot *const old_slots = self->slots;
+    const size_t old_capacity = self->capacity;
+
+    chunk_map_init(self, old_capacity * 2);
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_slots[i].chunk == NULL) continue;
+        const size_t j = chunk_map_find_slot(self, old_slots[i].x,
+                                             old_slots[i].z);
+        self->slots[j] = old_slots[i];
+        ++self->length;
+    }
+    free(old_slots);
+}
+
+void chunk_map_init(ChunkMap *const self, const size_t capacity) {
+    assert(self != NULL);
+    assert(capacity > 0 && (capacity & (capacity - 1)) == 0 &&
+           "capacity must be a power of 2");
+
+    self->slots = malloc_or_exit(sizeof(*self->slots) * capacity,
+                                 "failed to allocate chunk map");
+    self->capacity = capacity;
+    self->length = 0;
+    for (size_t i = 0; i < capacity; ++i) {
+        self->slots[i].chunk = NULL;
+    }
+}
+
+void chunk_map_destroy(const ChunkMap *const self) {
+    assert(self != NULL);
+    free(self->slots);
+}
+
+Chunk *chunk_map_get(const ChunkMap *const self, const int x, const int z) {
+    assert(self != NULL);
+    return self->slots[chunk_map_find_slot(self, x, z)].chunk;
+}
+
+void chunk_map_insert(ChunkMap *const self, const int x, const int z,
+                      Chunk *const chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+    // Keep the load factor under 1/2 so probe sequences stay short.
+    if ((self->length + 1) * 2 > self->capacity) chunk_map_grow(self);
+
+    const size_t i = chunk_map_find_slot(self, x, z);
+    assert(self->slots[i].chunk == NULL && "chunk already in the map");
+    self->slots[i] = (ChunkMapSlot){.x = x, .z = z, .chunk = chunk};
+    ++self->length;
+}
+
+Chunk *chunk_map_remove(ChunkMap *const self, const int x, const int z) {
+    assert(self != NULL);
+
+    const size_t mask = self->capacity - 1;
+    size_t i = chunk_map_find_slot(self, x, z);
+    Chunk *const chunk = self->slots[i].chunk;
+    if (chunk == NULL) return NULL;
+
+    // Backward shift deletion: move back the following entries of the cluster
+    // that would not be reachable anymore, so no tombstone is needed.
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (self->slots[j].chunk == NULL) break;
+        const size_t home =
+            chunk_map_hash(self->slots[j].x, self->slots[j].z) & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            self->slots[i] = self->slots[j];
+            i = j;
+        }
+    }
+    self->slots[i].chunk = NULL;
+    --self->length;
+    return chunk;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "chunk_map_defs.h"
+
+[[gnu::nonnull]]
+void chunk_map_init(ChunkMap *const self, const size_t capacity);
+
+[[gnu::nonnull]]
+void chunk_map_destroy(const ChunkMap *const self);
+
+[[gnu::nonnull]]
+Chunk *chunk_map_get(const ChunkMap *const self, const int x, const int z);
+
+[[gnu::nonnull]]
+void chunk_map_insert(ChunkMap *const self, const int x, const int z,
+                      Chunk *const chunk);
+
+[[gnu::nonnull]]
+Chunk *chunk_map_remove(ChunkMap *const self, const int x, const int z);
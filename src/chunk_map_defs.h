@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+
+typedef struct Chunk Chunk;
+
+typedef struct {
+    int x, z;
+    Chunk *chunk;  // NULL if the slot is empty
+} ChunkMapSlot;
+
+// Open addressing hash map from chunk coordinates to chunks.
+typedef struct {
+    ChunkMapSlot *slots;
+    size_t capacity;  // always a power of 2
+    size_t length;
+} ChunkMap;
@@ -0,0 +1,400 @@
+#include "chunk_mesh.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "array.h"
+#include "camera.h"
+#include "chunk_triangle_array.h"
+#include "chunk_vertex_array.h"
+#include "config.h"
+#include "frame_arena.h"
+#include "mesh.h"
+#include "render_tiles.h"
+#include "textures.h"
+#include "triangle3D_array.h"
+#include "utils.h"
+#include "vec.h"
+#include "vertex_transform.h"
+
+// The vertices are converted to structure of arrays by batches before being
+// transformed.
+#define CHUNK_MESH_TRANSFORM_BATCH_SIZE 256
+
+static const Color block_top_colors[] = {
+#define BLOCK(name, name_string, top_color, ...) top_color,
+    BLOCKS
+#undef BLOCK
+};
+
+static const Color block_side_colors[] = {
+#define BLOCK(name, name_string, top_color, side_color, ...) side_color,
+    BLOCKS
+#undef BLOCK
+};
+
+static const Color block_bottom_colors[] = {
+#define BLOCK(name, name_string, top_color, side_color, bottom_color, ...) \
+    bottom_color,
+    BLOCKS
+#undef BLOCK
+};
+
+static const Texture *const block_top_textures[] = {
+#define BLOCK(name, name_string, top_color, _side_color, _bottom_color, \
+              top_texture, ...)                                         \
+    top_texture,
+    BLOCKS
+#undef BLOCK
+};
+
+static const Texture *const block_side_textures[] = {
+#define BLOCK(name, name_string, top_color, _side_color, _bottom_color, \
+              top_texture, side_texture, ...)                           \
+    side_texture,
+    BLOCKS
+#undef BLOCK
+};
+
+static const Texture *const block_bottom_textures[] = {
+#define BLOCK(name, name_string, top_color, _side_color, _bottom_color, \
+              top_texture, side_texture, bottom_texture)                \
+    bottom_texture,
+    BLOCKS
+#undef BLOCK
+};
+
+void chunk_mesh_init(ChunkMesh *const self,
+                     const size_t preallocate_vertices_size,
+                     const size_t preallocate_triangles_size) {
+    assert(self != NULL);
+    chunk_vertex_array_init(&self->vertices, preallocate_vertices_size);
+    chunk_triangle_array_init(&self->triangles, preallocate_triangles_size);
+    self->min_y = 0;
+    self->max_y = 0;
+    memset(self->groups, 0, sizeof(self->groups));
+}
+
+void chunk_mesh_destroy(const ChunkMesh *const self) {
+    assert(self != NULL);
+    array_destroy((const Array *)&self->vertices);
+    array_destroy((const Array *)&self->triangles);
+}
+
+void chunk_mesh_clear(ChunkMesh *const self) {
+    assert(self != NULL);
+    self->vertices.length = 0;
+    self->triangles.length = 0;
+    self->min_y = 0;
+    self->max_y = 0;
+    memset(self->groups, 0, sizeof(self->groups));
+}
+
+// Coordinate of the vertex along the normal axis of the face.
+static inline uint16_t chunk_vertex_get_plane(const ChunkVertex vertex,
+                                              const ChunkFace face) {
+    switch (face) {
+        case CHUNK_FACE_FRONT:
+        case CHUNK_FACE_BACK:
+            return vertex.z;
+        case CHUNK_FACE_LEFT:
+        case CHUNK_FACE_RIGHT:
+            return vertex.x;
+        case CHUNK_FACE_TOP:
+        case CHUNK_FACE_BOTTOM:
+            return vertex.y;
+        default:
+            assert(false && "unreachable");
+            __builtin_unreachable();
+    }
+}
+
+// Number of vertices of the groups once the vertices are split by face, the
+// triangles must already be grouped.
+[[gnu::nonnull]]
+static size_t chunk_mesh_count_group_vertices(
+    const ChunkMesh *const restrict self, uint32_t *const restrict vertex_remap,
+    const size_t source_vertices_length) {
+    assert(self != NULL);
+    assert(vertex_remap != NULL);
+
+    memset(vertex_remap, 0xff, sizeof(*vertex_remap) * source_vertices_length);
+    size_t vertices_length = 0;
+    for (ChunkFace face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const ChunkMeshGroup *const group = &self->groups[face];
+        for (uint32_t i = group->triangles_start; i < group->triangles_end;
+             ++i) {
+            const ChunkTriangle *const triangle = &self->triangles.array[i];
+            const uint16_t indices[] = {triangle->v1, triangle->v2,
+                                        triangle->v3};
+            for (uint8_t j = 0; j < 3; ++j) {
+                if (vertex_remap[indices[j]] == face) continue;
+                vertex_remap[indices[j]] = face;
+                ++vertices_length;
+            }
+        }
+    }
+    return vertices_length;
+}
+
+// Index of the source vertex in the group of the face, the vertex is copied
+// at the end of the group on its first use. vertex_remap holds
+// face << 16 | index for the vertices already copied.
+[[gnu::nonnull]]
+static inline uint16_t chunk_mesh_get_group_vertex(
+    ChunkMesh *const restrict self, const ChunkMesh *const restrict source,
+    uint32_t *const restrict vertex_remap, const ChunkFace face,
+    const uint16_t index) {
+    assert(self != NULL);
+    assert(source != NULL);
+    assert(vertex_remap != NULL);
+    assert(index < source->vertices.length);
+
+    if (vertex_remap[index] >> 16 == face) return (uint16_t)vertex_remap[index];
+
+    ChunkMeshGroup *const group = &self->groups[face];
+    const uint32_t i = group->vertices_end++;
+    assert(i < self->vertices.length);
+    const ChunkVertex vertex = source->vertices.array[index];
+    self->vertices.array[i] = vertex;
+    vertex_remap[index] = (uint32_t)face << 16 | i;
+
+    const uint16_t plane = chunk_vertex_get_plane(vertex, face);
+    if (plane < group->min_plane) group->min_plane = plane;
+    if (plane > group->max_plane) group->max_plane = plane;
+    return i;
+}
+
+void chunk_mesh_copy(ChunkMesh *const restrict self,
+                     const ChunkMesh *const restrict source,
+                     uint32_t *const restrict vertex_remap) {
+    assert(self != NULL);
+    assert(source != NULL);
+    assert(vertex_remap != NULL);
+
+    // Counting sort of the triangles by face.
+    uint32_t ends[CHUNK_FACE_COUNT] = {};
+    for (size_t i = 0; i < source->triangles.length; ++i) {
+        ++ends[source->triangles.array[i].face];
+    }
+    uint32_t start = 0;
+    for (ChunkFace face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        self->groups[face].triangles_start = start;
+        start += ends[face];
+        self->groups[face].triangles_end = start;
+        ends[face] = self->groups[face].triangles_start;
+    }
+    array_resize((Array *)&self->triangles, source->triangles.length,
+                 sizeof(*self->triangles.array));
+    for (size_t i = 0; i < source->triangles.length; ++i) {
+        const ChunkTriangle *const triangle = &source->triangles.array[i];
+        self->triangles.array[ends[triangle->face]++] = *triangle;
+    }
+
+    const size_t vertices_length = chunk_mesh_count_group_vertices(
+        self, vertex_remap, source->vertices.length);
+    assert(vertices_length <= CHUNK_MESH_MAX_VERTICES);
+    array_resize((Array *)&self->vertices, vertices_length,
+                 sizeof(*self->vertices.array));
+
+    memset(vertex_remap, 0xff,
+           sizeof(*vertex_remap) * source->vertices.length);
+    uint32_t vertices_start = 0;
+    for (ChunkFace face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        ChunkMeshGroup *const group = &self->groups[face];
+        group->vertices_start = vertices_start;
+        group->vertices_end = vertices_start;
+        group->min_plane = UINT16_MAX;
+        group->max_plane = 0;
+        for (uint32_t i = group->triangles_start; i < group->triangles_end;
+             ++i) {
+            ChunkTriangle *const triangle = &self->triangles.array[i];
+            triangle->v1 = chunk_mesh_get_group_vertex(self, source,
+                                                       vertex_remap, face,
+                                                       triangle->v1);
+            triangle->v2 = chunk_mesh_get_group_vertex(self, source,
+                                                       vertex_remap, face,
+                                                       triangle->v2);
+            triangle->v3 = chunk_mesh_get_group_vertex(self, source,
+                                                       vertex_remap, face,
+                                                       triangle->v3);
+        }
+        vertices_start = group->vertices_end;
+    }
+    assert(vertices_start == vertices_length);
+
+    self->min_y = self->vertices.length == 0 ? 0 : UINT16_MAX;
+    self->max_y = 0;
+    for (size_t i = 0; i < self->vertices.length; ++i) {
+        const uint16_t y = self->vertices.array[i].y;
+        if (y < self->min_y) self->min_y = y;
+        if (y > self->max_y) self->max_y = y;
+    }
+}
+
+// Coordinates of the vertex along the u and v axes of the texture of the face.
+static inline int chunk_vertex_get_u(const ChunkVertex vertex,
+                                     const ChunkFace face) {
+    return face == CHUNK_FACE_LEFT || face == CHUNK_FACE_RIGHT ? vertex.z
+                                                               : vertex.x;
+}
+
+static inline int chunk_vertex_get_v(const ChunkVertex vertex,
+                                     const ChunkFace face) {
+    return face == CHUNK_FACE_TOP || face == CHUNK_FACE_BOTTOM ? vertex.z
+                                                               : vertex.y;
+}
+
+[[gnu::nonnull]]
+static inline Triangle3D *chunk_triangle_decode(
+    const ChunkTriangle *const restrict self,
+    const ChunkVertex *const restrict vertices,
+    const v4f *const restrict view_vertices,
+    const v4f *const restrict screen_vertices,
+    FrameArena *const restrict arena) {
+    assert(self != NULL);
+    assert(vertices != NULL);
+    assert(view_vertices != NULL);
+    assert(screen_vertices != NULL);
+    assert(arena != NULL);
+
+    const ChunkVertex v1 = vertices[self->v1];
+    const ChunkVertex v2 = vertices[self->v2];
+    const ChunkVertex v3 = vertices[self->v3];
+    const int u1 = chunk_vertex_get_u(v1, self->face);
+    const int u2 = chunk_vertex_get_u(v2, self->face);
+    const int u3 = chunk_vertex_get_u(v3, self->face);
+    const int v1_v = chunk_vertex_get_v(v1, self->face);
+    const int v2_v = chunk_vertex_get_v(v2, self->face);
+    const int v3_v = chunk_vertex_get_v(v3, self->face);
+    const float width = max3_int(u1, u2, u3) - min3_int(u1, u2, u3);
+    const float height =
+        max3_int(v1_v, v2_v, v3_v) - min3_int(v1_v, v2_v, v3_v);
+
+    v2f uvs[3];
+    for (uint8_t i = 0; i < 3; ++i) {
+        uvs[i] = (v2f){(self->uvs >> (2 * i) & 1) * width,
+                       (self->uvs >> (2 * i + 1) & 1) * height};
+    }
+
+    const Texture *texture;
+    Color color;
+    if (self->face == CHUNK_FACE_TOP) {
+        texture = block_top_textures[self->block];
+        color = block_top_colors[self->block];
+    } else if (self->face == CHUNK_FACE_BOTTOM) {
+        texture = block_bottom_textures[self->block];
+        color = block_bottom_colors[self->block];
+    } else {
+        texture = block_side_textures[self->block];
+        color = block_side_colors[self->block];
+    }
+
+    Triangle3D *const triangle = triangle3D_init_v4f(
+        &view_vertices[self->v1], &view_vertices[self->v2],
+        &view_vertices[self->v3], uvs[0], uvs[1], uvs[2], self->edges, texture,
+        color, arena);
+    triangle->screen_v1 = &screen_vertices[self->v1];
+    triangle->screen_v2 = &screen_vertices[self->v2];
+    triangle->screen_v3 = &screen_vertices[self->v3];
+    return triangle;
+}
+
+// Whether the camera, relative to the chunk, is behind every face of the group.
+[[gnu::nonnull]]
+static inline bool chunk_mesh_group_is_back_facing(
+    const ChunkMeshGroup *const group, const ChunkFace face, const v3f eye) {
+    assert(group != NULL);
+
+    switch (face) {
+        case CHUNK_FACE_FRONT:
+            return eye.z >= group->max_plane;
+        case CHUNK_FACE_BACK:
+            return eye.z <= group->min_plane;
+        case CHUNK_FACE_LEFT:
+            return eye.x >= group->max_plane;
+        case CHUNK_FACE_RIGHT:
+            return eye.x <= group->min_plane;
+        case CHUNK_FACE_TOP:
+            return eye.y <= group->min_plane;
+        case CHUNK_FACE_BOTTOM:
+            return eye.y >= group->max_plane;
+        default:
+            assert(false && "unreachable");
+            __builtin_unreachable();
+    }
+}
+
+void chunk_mesh_render(const ChunkMesh *const restrict self, const int chunk_x,
+                       const int chunk_z, const Camera *const restrict camera,
+                       RenderTiles *const restrict tiles,
+                       const size_t thread_index) {
+    assert(self != NULL);
+    assert(camera != NULL);
+    assert(tiles != NULL);
+
+    // The triangles are only clipped against the planes of the frustum
+    // crossing the mesh.
+    const Aabb aabb = {
+        .position = {chunk_x * CHUNK_SIZE, self->min_y, chunk_z * CHUNK_SIZE},
+        .size = {CHUNK_SIZE, self->max_y - self->min_y, CHUNK_SIZE},
+    };
+    uint8_t plane_mask;
+    if (!camera_aabb_in_frustum(camera, &aabb, &plane_mask)) return;
+
+    m4f view_matrix;
+    camera_get_view_matrix(camera, view_matrix);
+
+    const int origin_x = chunk_x * CHUNK_SIZE;
+    const int origin_z = chunk_z * CHUNK_SIZE;
+    const v3f eye = {camera->position.x - origin_x, camera->position.y,
+                     camera->position.z - origin_z};
+    FrameArena *const arena = render_tiles_get_arena(tiles, thread_index);
+    // Only the vertices of the groups facing the camera are transformed.
+    v4f *const view_vertices = frame_arena_alloc(
+        arena, sizeof(*view_vertices) * self->vertices.length);
+    v4f *const screen_vertices = frame_arena_alloc(
+        arena, sizeof(*screen_vertices) * self->vertices.length);
+
+    Triangle3DArray viewed_triangles;
+    triangle3D_array_init_in_arena(&viewed_triangles, self->triangles.length,
+                                   arena);
+    for (ChunkFace face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        const ChunkMeshGroup *const group = &self->groups[face];
+        if (group->triangles_start == group->triangles_end ||
+            chunk_mesh_group_is_back_facing(group, face, eye)) {
+            continue;
+        }
+
+        for (uint32_t start = group->vertices_start;
+             start < group->vertices_end;
+             start += CHUNK_MESH_TRANSFORM_BATCH_SIZE) {
+            const uint32_t length =
+                min_int(group->vertices_end - start,
+                        CHUNK_MESH_TRANSFORM_BATCH_SIZE);
+            float xs[CHUNK_MESH_TRANSFORM_BATCH_SIZE];
+            float ys[CHUNK_MESH_TRANSFORM_BATCH_SIZE];
+            float zs[CHUNK_MESH_TRANSFORM_BATCH_SIZE];
+            for (uint32_t i = 0; i < length; ++i) {
+                const ChunkVertex vertex = self->vertices.array[start + i];
+                xs[i] = origin_x + vertex.x;
+                ys[i] = vertex.y;
+                zs[i] = origin_z + vertex.z;
+            }
+            vertex_transform_soa(xs, ys, zs, length, view_matrix, camera,
+                                 &tiles->viewport, &view_vertices[start],
+                                 &screen_vertices[start]);
+        }
+
+        for (uint32_t i = group->triangles_start; i < group->triangles_end;
+             ++i) {
+            Triangle3D *const triangle = chunk_triangle_decode(
+                &self->triangles.array[i], self->vertices.array,
+                view_vertices, screen_vertices, arena);
+            mesh_view_triangle(triangle, camera, plane_mask,
+                               &viewed_triangles, arena);
+        }
+    }
+    mesh_bin_viewed_triangles(&viewed_triangles, camera, tiles, thread_index);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "camera_defs.h"
+#include "chunk_mesh_defs.h"
+#include "render_tiles_defs.h"
+
+[[gnu::nonnull]]
+void chunk_mesh_init(ChunkMesh *const self,
+                     const size_t preallocate_vertices_size,
+                     const size_t preallocate_triangles_size);
+
+[[gnu::nonnull]]
+void chunk_mesh_destroy(const ChunkMesh *const self);
+
+[[gnu::nonnull]]
+void chunk_mesh_clear(ChunkMesh *const self);
+
+// Replace the mesh by a copy of source with its triangles and vertices grouped
+// by face, with its arrays fitted to the copy. vertex_remap is overwritten and
+// has room for the vertices of source.
+[[gnu::nonnull]]
+void chunk_mesh_copy(ChunkMesh *const restrict self,
+                     const ChunkMesh *const restrict source,
+                     uint32_t *const restrict vertex_remap);
+
+// Bin the mesh of the chunk (chunk_x, chunk_z) in the tiles.
+[[gnu::nonnull]]
+void chunk_mesh_render(const ChunkMesh *const restrict self, const int chunk_x,
+                       const int chunk_z, const Camera *const restrict camera,
+                       RenderTiles *const restrict tiles,
+                       const size_t thread_index);
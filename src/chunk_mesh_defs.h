@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "chunk_triangle_array_defs.h"
+#include "chunk_triangle_defs.h"
+#include "chunk_vertex_array_defs.h"
+
+// The triangles index the vertices with 16 bits.
+#define CHUNK_MESH_MAX_VERTICES (UINT16_MAX + 1)
+
+// The triangles of the faces of a direction and the vertices they use, the
+// ranges go from start included to end excluded.
+typedef struct {
+    uint32_t triangles_start, triangles_end;
+    uint32_t vertices_start, vertices_end;
+    // Range of the coordinates of the faces along their normal axis.
+    uint16_t min_plane, max_plane;
+} ChunkMeshGroup;
+
+typedef struct {
+    ChunkVertexArray vertices;
+    ChunkTriangleArray triangles;
+    // The triangles and vertices are stored by face direction, a vertex shared
+    // by several directions is duplicated in each of their groups.
+    ChunkMeshGroup groups[CHUNK_FACE_COUNT];
+    // Range of the vertices along y, set when the mesh is copied.
+    uint16_t min_y, max_y;
+} ChunkMesh;
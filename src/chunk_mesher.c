@@ -0,0 +1,1221 @@
+// Needed for pthread_rwlockattr_setkind_np().
+#define _GNU_SOURCE
+#include "chunk_mesher.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "array.h"
+#include "chunk.h"
+#include "chunk_array.h"
+#include "chunk_map.h"
+#include "chunk_queue.h"
+#include "chunk_mesh.h"
+#include "chunk_triangle_array.h"
+#include "chunk_vertex_array.h"
+#include "log.h"
+#include "triangle.h"
+#include "utils.h"
+
+#define vertex_indices_index(x, y, z) \
+    ((y) * ((CHUNK_SIZE + 1) * (CHUNK_SIZE + 1)) + (x) * (CHUNK_SIZE + 1) + (z))
+
+[[gnu::returns_nonnull]]
+static ChunkMeshScratch *chunk_mesh_scratch_create(void) {
+    ChunkMeshScratch *const self = malloc_or_exit(
+        sizeof(*self), "failed to allocate chunk meshing scratch");
+    self->generation = 1;
+    memset(self->vertex_generations, 0, sizeof(self->vertex_generations));
+    chunk_mesh_init(&self->mesh, 1024, 1024);
+    return self;
+}
+
+[[gnu::nonnull]]
+static void chunk_mesh_scratch_destroy(ChunkMeshScratch *const self) {
+    assert(self != NULL);
+
+    chunk_mesh_destroy(&self->mesh);
+    free(self);
+}
+
+// Forget the vertices added so far, the next ones are not shared with them.
+[[gnu::nonnull]]
+static void chunk_mesh_scratch_forget_vertices(ChunkMeshScratch *const self) {
+    assert(self != NULL);
+
+    if (++self->generation == 0) {
+        memset(self->vertex_generations, 0, sizeof(self->vertex_generations));
+        self->generation = 1;
+    }
+}
+
+// Start a new mesh, forgetting the vertices of the previous one.
+[[gnu::nonnull]]
+static void chunk_mesh_scratch_begin(ChunkMeshScratch *const self) {
+    assert(self != NULL);
+
+    chunk_mesh_clear(&self->mesh);
+    chunk_mesh_scratch_forget_vertices(self);
+}
+
+[[gnu::nonnull]]
+static uint16_t chunk_get_vertex_index(ChunkMeshScratch *const self,
+                                       const int x, const int y, const int z) {
+    assert(self != NULL);
+
+    const int index = vertex_indices_index(x, y, z);
+    if (self->vertex_generations[index] == self->generation) {
+        return self->vertex_indices[index];
+    }
+
+    ChunkMesh *const mesh = &self->mesh;
+    assert(mesh->vertices.length < CHUNK_MESH_MAX_VERTICES);
+    const size_t i = chunk_vertex_array_grow(&mesh->vertices);
+    mesh->vertices.array[i] = (ChunkVertex){.x = x, .z = z, .y = y};
+    self->vertex_generations[index] = self->generation;
+    self->vertex_indices[index] = i;
+    return i;
+}
+
+// Pending chunks are treated as unloaded, the meshes are invalidated when they
+// are collected.
+[[gnu::nonnull]]
+static inline const Chunk *chunk_mesher_get_generated_chunk(
+    const ChunkMap *const chunks, const int x, const int z) {
+    assert(chunks != NULL);
+    const Chunk *const chunk = chunk_map_get(chunks, x, z);
+    if (chunk == NULL || chunk->pending) return NULL;
+    return chunk;
+}
+
+// Row (y, z) extended with the blocks of the chunks on its left and right,
+// the bit 0 is the block at x = -1 and the bit CHUNK_SIZE + 1 the one at
+// x = CHUNK_SIZE. z can be -1 or CHUNK_SIZE to read the front and back chunks.
+// The blocks of the missing chunks are solid if missing_is_solid and the rows
+// outside of the height of the chunks are empty.
+static uint32_t chunk_get_extended_row_mask(const Chunk *neighbours[3][3],
+                                            const int y, const int z,
+                                            const bool missing_is_solid) {
+    assert(neighbours != NULL);
+    assert(-1 <= z && z <= CHUNK_SIZE);
+
+    if (y < 0 || y >= CHUNK_HEIGHT) return 0;
+
+    const Chunk **const chunks =
+        neighbours[z < 0 ? 0 : (z < CHUNK_SIZE ? 1 : 2)];
+    const int chunk_z = POSITIVE_MOD(z, CHUNK_SIZE);
+    ChunkRowMask rows[3];
+    for (uint8_t i = 0; i < 3; ++i) {
+        if (chunks[i] != NULL) {
+            rows[i] = chunk_get_row_mask(chunks[i], y, chunk_z);
+        } else {
+            rows[i] = missing_is_solid ? CHUNK_ROW_MASK_FULL : 0;
+        }
+    }
+    return rows[0] >> (CHUNK_SIZE - 1) | (uint32_t)rows[1] << 1 |
+           (uint32_t)(rows[2] & 1) << (CHUNK_SIZE + 1);
+}
+
+// Blocks at x - 1, x and x + 1 of an extended row, for each x of the chunk.
+static inline ChunkRowMask extended_row_mask_left(const uint32_t row) {
+    return row & CHUNK_ROW_MASK_FULL;
+}
+
+static inline ChunkRowMask extended_row_mask_center(const uint32_t row) {
+    return row >> 1 & CHUNK_ROW_MASK_FULL;
+}
+
+static inline ChunkRowMask extended_row_mask_right(const uint32_t row) {
+    return row >> 2 & CHUNK_ROW_MASK_FULL;
+}
+
+[[gnu::nonnull]]
+static inline void chunk_generate_section_mesh(
+    const Chunk *const restrict self, const ChunkMap *const restrict chunks,
+    const uint8_t section_index, ChunkMeshScratch *const restrict scratch,
+    ChunkMesh *const restrict output) {
+    assert(self != NULL);
+    assert(chunks != NULL);
+    assert(section_index < CHUNK_SECTIONS_NUMBER);
+    assert(scratch != NULL);
+    assert(output != NULL);
+
+#if !defined(PROD) && !defined(LOG_LEVEL_ERROR)
+    const uint64_t start = get_time_microseconds();
+#endif
+
+    if (chunk_section_is_empty(&self->sections[section_index])) {
+        chunk_mesh_clear(output);
+        return;
+    }
+
+    const int min_y = section_index * CHUNK_SECTION_HEIGHT;
+    const int max_y = min_y + CHUNK_SECTION_HEIGHT;
+
+    chunk_mesh_scratch_begin(scratch);
+    ChunkMesh *const mesh = &scratch->mesh;
+
+    // neighbours[dz + 1][dx + 1]
+    const Chunk *neighbours[3][3];
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            neighbours[dz + 1][dx + 1] =
+                dx == 0 && dz == 0 ? self
+                                   : chunk_mesher_get_generated_chunk(
+                                         chunks, self->x + dx, self->z + dz);
+        }
+    }
+
+    for (int y = min_y; y < max_y; ++y) {
+        for (int z = 0; z < CHUNK_SIZE; ++z) {
+            const ChunkRowMask row = chunk_get_row_mask(self, y, z);
+            if (row == 0) continue;
+
+            // The faces against a missing chunk are hidden, but its blocks
+            // don't add outlines.
+            const uint32_t side_row =
+                chunk_get_extended_row_mask(neighbours, y, z, true);
+            const ChunkRowMask above =
+                y < CHUNK_HEIGHT - 1 ? chunk_get_row_mask(self, y + 1, z) : 0;
+            const ChunkRowMask below =
+                y > 0 ? chunk_get_row_mask(self, y - 1, z) : 0;
+
+            const ChunkRowMask front_faces =
+                row & ~extended_row_mask_center(chunk_get_extended_row_mask(
+                          neighbours, y, z - 1, true));
+            const ChunkRowMask back_faces =
+                row & ~extended_row_mask_center(chunk_get_extended_row_mask(
+                          neighbours, y, z + 1, true));
+            const ChunkRowMask left_faces =
+                row & ~extended_row_mask_left(side_row);
+            const ChunkRowMask right_faces =
+                row & ~extended_row_mask_right(side_row);
+            const ChunkRowMask top_faces = row & ~above;
+            const ChunkRowMask bottom_faces = y > 0 ? row & ~below : 0;
+
+            const uint32_t front_row =
+                chunk_get_extended_row_mask(neighbours, y, z - 1, false);
+            const uint32_t back_row =
+                chunk_get_extended_row_mask(neighbours, y, z + 1, false);
+            const uint32_t top_row =
+                chunk_get_extended_row_mask(neighbours, y + 1, z, false);
+            const uint32_t bottom_row =
+                chunk_get_extended_row_mask(neighbours, y - 1, z, false);
+
+            const ChunkRowMask blocks_front_left =
+                extended_row_mask_left(front_row);
+            const ChunkRowMask blocks_front_right =
+                extended_row_mask_right(front_row);
+            const ChunkRowMask blocks_back_left =
+                extended_row_mask_left(back_row);
+            const ChunkRowMask blocks_back_right =
+                extended_row_mask_right(back_row);
+            const ChunkRowMask blocks_top_front =
+                extended_row_mask_center(chunk_get_extended_row_mask(
+                    neighbours, y + 1, z - 1, false));
+            const ChunkRowMask blocks_top_back =
+                extended_row_mask_center(chunk_get_extended_row_mask(
+                    neighbours, y + 1, z + 1, false));
+            const ChunkRowMask blocks_top_left =
+                extended_row_mask_left(top_row);
+            const ChunkRowMask blocks_top_right =
+                extended_row_mask_right(top_row);
+            const ChunkRowMask blocks_bottom_front =
+                extended_row_mask_center(chunk_get_extended_row_mask(
+                    neighbours, y - 1, z - 1, false));
+            const ChunkRowMask blocks_bottom_back =
+                extended_row_mask_center(chunk_get_extended_row_mask(
+                    neighbours, y - 1, z + 1, false));
+            const ChunkRowMask blocks_bottom_left =
+                extended_row_mask_left(bottom_row);
+            const ChunkRowMask blocks_bottom_right =
+                extended_row_mask_right(bottom_row);
+
+            for (unsigned int blocks = front_faces | back_faces | left_faces |
+                                       right_faces | top_faces | bottom_faces;
+                 blocks != 0; blocks &= blocks - 1) {
+                const int x = __builtin_ctz(blocks);
+                const BlockType block_type = chunk_get_block(self, x, y, z);
+                assert(block_type != BLOCK_TYPE_AIR);
+
+                const bool is_front_face_visible = front_faces >> x & 1;
+                const bool is_back_face_visible = back_faces >> x & 1;
+                const bool is_left_face_visible = left_faces >> x & 1;
+                const bool is_right_face_visible = right_faces >> x & 1;
+                const bool is_top_face_visible = top_faces >> x & 1;
+                const bool is_bottom_face_visible = bottom_faces >> x & 1;
+                const bool is_below_empty = !(below >> x & 1);
+
+                const bool block_front_left = blocks_front_left >> x & 1;
+                const bool block_front_right = blocks_front_right >> x & 1;
+                const bool block_back_left = blocks_back_left >> x & 1;
+                const bool block_back_right = blocks_back_right >> x & 1;
+                const bool block_top_front = blocks_top_front >> x & 1;
+                const bool block_top_back = blocks_top_back >> x & 1;
+                const bool block_top_left = blocks_top_left >> x & 1;
+                const bool block_top_right = blocks_top_right >> x & 1;
+                const bool block_bottom_front = blocks_bottom_front >> x & 1;
+                const bool block_bottom_back = blocks_bottom_back >> x & 1;
+                const bool block_bottom_left = blocks_bottom_left >> x & 1;
+                const bool block_bottom_right = blocks_bottom_right >> x & 1;
+
+                size_t i;
+                ChunkTriangle *triangle;
+                if (is_front_face_visible) {
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(scratch, x, y, z);
+                    triangle->v2 = chunk_get_vertex_index(scratch, x, y + 1, z);
+                    triangle->v3 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_FIRST_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_FRONT;
+
+                    if (is_left_face_visible || block_front_left) {
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+                    }
+
+                    if (is_top_face_visible || block_top_front)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z);
+                    triangle->v2 = chunk_get_vertex_index(scratch, x + 1, y, z);
+                    triangle->v3 = chunk_get_vertex_index(scratch, x, y, z);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_SECOND_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_FRONT;
+
+                    if (is_right_face_visible || block_front_right)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_below_empty || block_bottom_front)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+                }
+
+                if (is_right_face_visible) {
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(scratch, x + 1, y, z);
+                    triangle->v2 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z);
+                    triangle->v3 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z + 1);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_FIRST_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_RIGHT;
+
+                    if (is_front_face_visible || block_front_right)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_top_face_visible || block_top_right)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z + 1);
+                    triangle->v2 = chunk_get_vertex_index(
+                        scratch, x + 1, y, z + 1);
+                    triangle->v3 = chunk_get_vertex_index(scratch, x + 1, y, z);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_SECOND_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_RIGHT;
+
+                    if (is_back_face_visible || block_back_right)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_below_empty || block_bottom_right)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+                }
+
+                if (is_back_face_visible) {
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(
+                        scratch, x + 1, y, z + 1);
+                    triangle->v2 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z + 1);
+                    triangle->v3 = chunk_get_vertex_index(
+                        scratch, x, y + 1, z + 1);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_FIRST_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_BACK;
+
+                    if (is_right_face_visible || block_back_right)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_top_face_visible || block_top_back)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(
+                        scratch, x, y + 1, z + 1);
+                    triangle->v2 = chunk_get_vertex_index(scratch, x, y, z + 1);
+                    triangle->v3 = chunk_get_vertex_index(
+                        scratch, x + 1, y, z + 1);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_SECOND_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_BACK;
+
+                    if (is_left_face_visible || block_back_left)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_below_empty || block_bottom_back)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+                }
+
+                if (is_left_face_visible) {
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(scratch, x, y, z + 1);
+                    triangle->v2 = chunk_get_vertex_index(
+                        scratch, x, y + 1, z + 1);
+                    triangle->v3 = chunk_get_vertex_index(scratch, x, y + 1, z);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_FIRST_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_LEFT;
+
+                    if (is_back_face_visible || block_back_left)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_top_face_visible || block_top_left)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(scratch, x, y + 1, z);
+                    triangle->v2 = chunk_get_vertex_index(scratch, x, y, z);
+                    triangle->v3 = chunk_get_vertex_index(scratch, x, y, z + 1);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_SECOND_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_LEFT;
+
+                    if (is_front_face_visible || block_front_left)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_below_empty || block_bottom_left)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+                }
+
+                // top face
+                if (is_top_face_visible) {
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(scratch, x, y + 1, z);
+                    triangle->v2 = chunk_get_vertex_index(
+                        scratch, x, y + 1, z + 1);
+                    triangle->v3 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z + 1);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_FIRST_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_TOP;
+
+                    if (is_left_face_visible || block_top_left)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_back_face_visible || block_top_back)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z + 1);
+                    triangle->v2 = chunk_get_vertex_index(
+                        scratch, x + 1, y + 1, z);
+                    triangle->v3 = chunk_get_vertex_index(scratch, x, y + 1, z);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_SECOND_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_TOP;
+
+                    if (is_right_face_visible || block_top_right)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_front_face_visible || block_top_front)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+                }
+
+                // bottom face
+                if (is_bottom_face_visible) {
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(scratch, x, y, z + 1);
+                    triangle->v2 = chunk_get_vertex_index(scratch, x, y, z);
+                    triangle->v3 = chunk_get_vertex_index(scratch, x + 1, y, z);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_FIRST_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_BOTTOM;
+
+                    if (is_left_face_visible || block_bottom_left)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_front_face_visible || block_bottom_front)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+
+                    i = chunk_triangle_array_grow(&mesh->triangles);
+                    triangle = &mesh->triangles.array[i];
+                    triangle->v1 = chunk_get_vertex_index(scratch, x + 1, y, z);
+                    triangle->v2 = chunk_get_vertex_index(
+                        scratch, x + 1, y, z + 1);
+                    triangle->v3 = chunk_get_vertex_index(scratch, x, y, z + 1);
+                    triangle->uvs = CHUNK_TRIANGLE_UVS_SECOND_HALF;
+                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+                    triangle->block = block_type;
+                    triangle->face = CHUNK_FACE_BOTTOM;
+
+                    if (is_right_face_visible || block_bottom_right)
+                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
+
+                    if (is_back_face_visible || block_bottom_back)
+                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
+                }
+            }
+        }
+    }
+
+    // Grouped by face, a vertex is at most duplicated in each group.
+    static_assert(CHUNK_FACE_COUNT * (CHUNK_SIZE + 1) *
+                      (CHUNK_SECTION_HEIGHT + 1) * (CHUNK_SIZE + 1) <=
+                  CHUNK_MESH_MAX_VERTICES);
+    chunk_mesh_copy(output, mesh, scratch->vertex_remap);
+
+    log_debugf("generated mesh for section %u of chunk (%d, %d) in %f ms",
+               section_index, self->x, self->z,
+               (get_time_microseconds() - start) / 1000.0f);
+}
+
+// Row of the neighbour chunk, a missing neighbour hides the faces on its side.
+static inline ChunkRowMask chunk_get_neighbour_row_mask(
+    const Chunk *const chunk, const int y, const int z) {
+    if (chunk == NULL) return CHUNK_ROW_MASK_FULL;
+    return chunk_get_row_mask(chunk, y, z);
+}
+
+[[gnu::nonnull(1, 2)]]
+static void chunk_get_visible_faces(
+    const Chunk *const restrict self,
+    ChunkRowMask visible[CHUNK_HEIGHT][CHUNK_SIZE], const ChunkFace face,
+    const Chunk *const restrict neighbour) {
+    assert(self != NULL);
+    assert(visible != NULL);
+
+    for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+        for (int z = 0; z < CHUNK_SIZE; ++z) {
+            const ChunkRowMask row = chunk_get_row_mask(self, y, z);
+            ChunkRowMask hidden;
+            switch (face) {
+                case CHUNK_FACE_FRONT:
+                    hidden = z > 0 ? chunk_get_row_mask(self, y, z - 1)
+                                   : chunk_get_neighbour_row_mask(
+                                         neighbour, y, CHUNK_SIZE - 1);
+                    break;
+                case CHUNK_FACE_BACK:
+                    hidden = z < CHUNK_SIZE - 1
+                                 ? chunk_get_row_mask(self, y, z + 1)
+                                 : chunk_get_neighbour_row_mask(neighbour, y,
+                                                                0);
+                    break;
+                case CHUNK_FACE_LEFT:
+                    hidden = chunk_row_mask_left_neighbours(
+                        row, chunk_get_neighbour_row_mask(neighbour, y, z));
+                    break;
+                case CHUNK_FACE_RIGHT:
+                    hidden = chunk_row_mask_right_neighbours(
+                        row, chunk_get_neighbour_row_mask(neighbour, y, z));
+                    break;
+                case CHUNK_FACE_TOP:
+                    hidden = y < CHUNK_HEIGHT - 1
+                                 ? chunk_get_row_mask(self, y + 1, z)
+                                 : 0;
+                    break;
+                case CHUNK_FACE_BOTTOM:
+                    hidden = y > 0 ? chunk_get_row_mask(self, y - 1, z)
+                                   : CHUNK_ROW_MASK_FULL;
+                    break;
+                default:
+                    assert(false && "unreachable");
+                    __builtin_unreachable();
+            }
+            visible[y][z] = row & ~hidden;
+        }
+    }
+}
+
+// Add the quad of the face covering the blocks [a, a + width[ x
+// [b, b + height[ of the slice. For the side faces, a is along the x or z axis
+// and b is the y, for the top and bottom faces, a is the x and b is the z.
+// Return false if the vertices of the quad can't be indexed.
+[[gnu::nonnull]]
+static bool chunk_add_quad(ChunkMeshScratch *const self, const ChunkFace face,
+                           const int slice, const int a, const int b,
+                           const int width, const int height,
+                           const BlockType type) {
+    assert(self != NULL);
+
+    // Only reachable by a pathological chunk, a greedy mesh has at most
+    // (CHUNK_SIZE + 1)^2 * (CHUNK_HEIGHT + 1) vertices per face.
+    if (self->mesh.vertices.length + 4 > CHUNK_MESH_MAX_VERTICES) return false;
+
+    v3i corners[4];
+    switch (face) {
+        case CHUNK_FACE_FRONT:
+            corners[0] = (v3i){a, b, slice};
+            corners[1] = (v3i){a, b + height, slice};
+            corners[2] = (v3i){a + width, b + height, slice};
+            corners[3] = (v3i){a + width, b, slice};
+            break;
+        case CHUNK_FACE_BACK:
+            corners[0] = (v3i){a + width, b, slice + 1};
+            corners[1] = (v3i){a + width, b + height, slice + 1};
+            corners[2] = (v3i){a, b + height, slice + 1};
+            corners[3] = (v3i){a, b, slice + 1};
+            break;
+        case CHUNK_FACE_LEFT:
+            corners[0] = (v3i){slice, b, a + width};
+            corners[1] = (v3i){slice, b + height, a + width};
+            corners[2] = (v3i){slice, b + height, a};
+            corners[3] = (v3i){slice, b, a};
+            break;
+        case CHUNK_FACE_RIGHT:
+            corners[0] = (v3i){slice + 1, b, a};
+            corners[1] = (v3i){slice + 1, b + height, a};
+            corners[2] = (v3i){slice + 1, b + height, a + width};
+            corners[3] = (v3i){slice + 1, b, a + width};
+            break;
+        case CHUNK_FACE_TOP:
+            corners[0] = (v3i){a, slice + 1, b};
+            corners[1] = (v3i){a, slice + 1, b + height};
+            corners[2] = (v3i){a + width, slice + 1, b + height};
+            corners[3] = (v3i){a + width, slice + 1, b};
+            break;
+        case CHUNK_FACE_BOTTOM:
+            corners[0] = (v3i){a, slice, b + height};
+            corners[1] = (v3i){a, slice, b};
+            corners[2] = (v3i){a + width, slice, b};
+            corners[3] = (v3i){a + width, slice, b + height};
+            break;
+        default:
+            assert(false && "unreachable");
+            __builtin_unreachable();
+    }
+
+    uint16_t indices[4];
+    for (uint8_t i = 0; i < 4; ++i) {
+        indices[i] = chunk_get_vertex_index(self, corners[i].x, corners[i].y,
+                                            corners[i].z);
+    }
+
+    // The texture is repeated once per block, the outline only follows the
+    // border of the quad. The far outlines are not needed since the greedy
+    // meshes are only used past MESH_FAR_OUTLINE_MAX_DISTANCE.
+    ChunkMesh *const mesh = &self->mesh;
+    size_t i = chunk_triangle_array_grow(&mesh->triangles);
+    ChunkTriangle *triangle = &mesh->triangles.array[i];
+    triangle->v1 = indices[0];
+    triangle->v2 = indices[1];
+    triangle->v3 = indices[2];
+    triangle->uvs = CHUNK_TRIANGLE_UVS_FIRST_HALF;
+    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+    triangle->block = type;
+    triangle->face = face;
+
+    i = chunk_triangle_array_grow(&mesh->triangles);
+    triangle = &mesh->triangles.array[i];
+    triangle->v1 = indices[2];
+    triangle->v2 = indices[3];
+    triangle->v3 = indices[0];
+    triangle->uvs = CHUNK_TRIANGLE_UVS_SECOND_HALF;
+    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
+    triangle->block = type;
+    triangle->face = face;
+    return true;
+}
+
+// Same faces as chunk_generate_section_mesh(), but the adjacent coplanar faces
+// of the same block type are merged into larger quads. Return false, leaving
+// the output untouched, if the vertices of the mesh can't be indexed.
+[[gnu::nonnull]]
+static bool chunk_generate_greedy_mesh(
+    const Chunk *const restrict self, const ChunkMap *const restrict chunks,
+    ChunkMeshScratch *const restrict scratch,
+    ChunkMesh *const restrict output) {
+    assert(self != NULL);
+    assert(chunks != NULL);
+    assert(scratch != NULL);
+    assert(output != NULL);
+
+#if !defined(PROD) && !defined(LOG_LEVEL_ERROR)
+    const uint64_t start = get_time_microseconds();
+#endif
+
+    chunk_mesh_scratch_begin(scratch);
+    size_t dropped_quads = 0;
+
+    const Chunk *const neighbours[CHUNK_FACE_COUNT] = {
+        [CHUNK_FACE_FRONT] =
+            chunk_mesher_get_generated_chunk(chunks, self->x, self->z - 1),
+        [CHUNK_FACE_BACK] =
+            chunk_mesher_get_generated_chunk(chunks, self->x, self->z + 1),
+        [CHUNK_FACE_LEFT] =
+            chunk_mesher_get_generated_chunk(chunks, self->x - 1, self->z),
+        [CHUNK_FACE_RIGHT] =
+            chunk_mesher_get_generated_chunk(chunks, self->x + 1, self->z),
+        [CHUNK_FACE_TOP] = NULL,
+        [CHUNK_FACE_BOTTOM] = NULL,
+    };
+
+    ChunkRowMask visible[CHUNK_HEIGHT][CHUNK_SIZE];
+    // Block types of the visible faces of a slice, mask[b][a].
+    BlockType mask[CHUNK_HEIGHT][CHUNK_SIZE];
+
+    for (ChunkFace face = 0; face < CHUNK_FACE_COUNT; ++face) {
+        // The vertices are not shared between the faces since the mesh is
+        // grouped by face when it is copied.
+        chunk_mesh_scratch_forget_vertices(scratch);
+        chunk_get_visible_faces(self, visible, face, neighbours[face]);
+
+        const bool is_horizontal =
+            face == CHUNK_FACE_TOP || face == CHUNK_FACE_BOTTOM;
+        const int slices_number = is_horizontal ? CHUNK_HEIGHT : CHUNK_SIZE;
+        const int mask_height = is_horizontal ? CHUNK_SIZE : CHUNK_HEIGHT;
+
+        for (int slice = 0; slice < slices_number; ++slice) {
+            int min_b = mask_height;
+            int max_b = -1;
+            for (int b = 0; b < mask_height; ++b) {
+                for (int a = 0; a < CHUNK_SIZE; ++a) {
+                    mask[b][a] = BLOCK_TYPE_AIR;
+                }
+
+                ChunkRowMask faces = 0;  // along a
+                if (is_horizontal) {
+                    faces = visible[slice][b];
+                } else if (face == CHUNK_FACE_FRONT ||
+                           face == CHUNK_FACE_BACK) {
+                    faces = visible[b][slice];
+                } else {
+                    for (int a = 0; a < CHUNK_SIZE; ++a) {
+                        faces |= (visible[b][a] >> slice & 1) << a;
+                    }
+                }
+                if (faces == 0) continue;
+                min_b = min_int(min_b, b);
+                max_b = b;
+
+                for (unsigned int bits = faces; bits != 0; bits &= bits - 1) {
+                    const int a = __builtin_ctz(bits);
+                    if (is_horizontal) {
+                        mask[b][a] = chunk_get_block(self, a, slice, b);
+                    } else if (face == CHUNK_FACE_FRONT ||
+                               face == CHUNK_FACE_BACK) {
+                        mask[b][a] = chunk_get_block(self, a, b, slice);
+                    } else {
+                        mask[b][a] = chunk_get_block(self, slice, b, a);
+                    }
+                }
+            }
+
+            for (int b = min_b; b <= max_b; ++b) {
+                for (int a = 0; a < CHUNK_SIZE; ++a) {
+                    const BlockType type = mask[b][a];
+                    if (type == BLOCK_TYPE_AIR) continue;
+
+                    int width = 1;
+                    while (a + width < CHUNK_SIZE &&
+                           mask[b][a + width] == type) {
+                        ++width;
+                    }
+
+                    int height = 1;
+                    for (; b + height <= max_b; ++height) {
+                        bool is_row_mergeable = true;
+                        for (int i = a; i < a + width; ++i) {
+                            if (mask[b + height][i] != type) {
+                                is_row_mergeable = false;
+                                break;
+                            }
+                        }
+                        if (!is_row_mergeable) break;
+                    }
+
+                    for (int j = b; j < b + height; ++j) {
+                        for (int i = a; i < a + width; ++i) {
+                            mask[j][i] = BLOCK_TYPE_AIR;
+                        }
+                    }
+
+                    if (!chunk_add_quad(scratch, face, slice, a, b, width,
+                                        height, type)) {
+                        ++dropped_quads;
+                    }
+                    a += width - 1;
+                }
+            }
+        }
+    }
+
+    if (dropped_quads != 0) {
+        log_debugf("too many vertices in the greedy mesh of chunk (%d, %d), "
+                   "%zu quads don't fit",
+                   self->x, self->z, dropped_quads);
+        return false;
+    }
+
+    chunk_mesh_copy(output, &scratch->mesh, scratch->vertex_remap);
+
+    log_debugf(
+        "generated greedy mesh for chunk (%d, %d) in %f ms, %zu triangles",
+        self->x, self->z, (get_time_microseconds() - start) / 1000.0f,
+        output->triangles.length);
+    return true;
+}
+
+// Height of the lowest column of the neighbour chunk along the side of the
+// cell, the walls of the border cells go down to it so that they meet the
+// neighbour whatever its level of detail. Without neighbour, no wall is added.
+static int chunk_get_lod_border_height(const Chunk *const neighbour,
+                                       const ChunkFace face, const int start,
+                                       const int cell_size, const int height) {
+    assert(face < CHUNK_FACE_TOP);
+
+    if (neighbour == NULL) return height;
+
+    int border_height = CHUNK_HEIGHT;
+    for (int i = start; i < start + cell_size; ++i) {
+        int column_height;
+        switch (face) {
+            case CHUNK_FACE_FRONT:
+                column_height = chunk_get_height(neighbour, i, CHUNK_SIZE - 1);
+                break;
+            case CHUNK_FACE_BACK:
+                column_height = chunk_get_height(neighbour, i, 0);
+                break;
+            case CHUNK_FACE_LEFT:
+                column_height = chunk_get_height(neighbour, CHUNK_SIZE - 1, i);
+                break;
+            case CHUNK_FACE_RIGHT:
+                column_height = chunk_get_height(neighbour, 0, i);
+                break;
+            default:
+                assert(false && "unreachable");
+                __builtin_unreachable();
+        }
+        border_height = min_int(border_height, column_height);
+    }
+    return border_height;
+}
+
+// Surface of the heightmap with cells of 2^(level + 1) blocks. A cell is as
+// high as its highest column and has the type of its top block, the walls
+// between two cells are single quads.
+[[gnu::nonnull]]
+static void chunk_generate_lod_mesh(const Chunk *const restrict self,
+                                    const ChunkMap *const restrict chunks,
+                                    const uint8_t level,
+                                    ChunkMeshScratch *const restrict scratch,
+                                    ChunkMesh *const restrict output) {
+    assert(self != NULL);
+    assert(chunks != NULL);
+    assert(level < MESH_LOD_LEVELS_NUMBER);
+    assert(scratch != NULL);
+    assert(output != NULL);
+
+#if !defined(PROD) && !defined(LOG_LEVEL_ERROR)
+    const uint64_t start = get_time_microseconds();
+#endif
+
+    const int cell_size = 2 << level;
+    const int cells_number = CHUNK_SIZE / cell_size;
+    // At most 5 quads per cell, so the vertices always fit.
+    static_assert(5 * 4 * (CHUNK_SIZE / 2) * (CHUNK_SIZE / 2) <=
+                  CHUNK_MESH_MAX_VERTICES);
+
+    int heights[cells_number][cells_number];
+    BlockType types[cells_number][cells_number];
+    for (int cell_z = 0; cell_z < cells_number; ++cell_z) {
+        for (int cell_x = 0; cell_x < cells_number; ++cell_x) {
+            int height = 0;
+            BlockType type = BLOCK_TYPE_AIR;
+            for (int z = cell_z * cell_size; z < (cell_z + 1) * cell_size;
+                 ++z) {
+                for (int x = cell_x * cell_size;
+                     x < (cell_x + 1) * cell_size; ++x) {
+                    const int column_height = chunk_get_height(self, x, z);
+                    if (column_height > height) {
+                        height = column_height;
+                        type = chunk_get_block(self, x, height - 1, z);
+                    }
+                }
+            }
+            heights[cell_z][cell_x] = height;
+            types[cell_z][cell_x] = type;
+        }
+    }
+
+    const Chunk *const neighbours[CHUNK_FACE_TOP] = {
+        [CHUNK_FACE_FRONT] =
+            chunk_mesher_get_generated_chunk(chunks, self->x, self->z - 1),
+        [CHUNK_FACE_BACK] =
+            chunk_mesher_get_generated_chunk(chunks, self->x, self->z + 1),
+        [CHUNK_FACE_LEFT] =
+            chunk_mesher_get_generated_chunk(chunks, self->x - 1, self->z),
+        [CHUNK_FACE_RIGHT] =
+            chunk_mesher_get_generated_chunk(chunks, self->x + 1, self->z),
+    };
+
+    chunk_mesh_scratch_begin(scratch);
+
+    for (int cell_z = 0; cell_z < cells_number; ++cell_z) {
+        for (int cell_x = 0; cell_x < cells_number; ++cell_x) {
+            const int height = heights[cell_z][cell_x];
+            if (height == 0) continue;
+
+            const BlockType type = types[cell_z][cell_x];
+            const int x = cell_x * cell_size;
+            const int z = cell_z * cell_size;
+            chunk_add_quad(scratch, CHUNK_FACE_TOP, height - 1, x, z,
+                           cell_size, cell_size, type);
+
+            const int front_height =
+                cell_z > 0 ? heights[cell_z - 1][cell_x]
+                           : chunk_get_lod_border_height(
+                                 neighbours[CHUNK_FACE_FRONT],
+                                 CHUNK_FACE_FRONT, x, cell_size, height);
+            const int back_height =
+                cell_z < cells_number - 1
+                    ? heights[cell_z + 1][cell_x]
+                    : chunk_get_lod_border_height(neighbours[CHUNK_FACE_BACK],
+                                                  CHUNK_FACE_BACK, x,
+                                                  cell_size, height);
+            const int left_height =
+                cell_x > 0 ? heights[cell_z][cell_x - 1]
+                           : chunk_get_lod_border_height(
+                                 neighbours[CHUNK_FACE_LEFT], CHUNK_FACE_LEFT,
+                                 z, cell_size, height);
+            const int right_height =
+                cell_x < cells_number - 1
+                    ? heights[cell_z][cell_x + 1]
+                    : chunk_get_lod_border_height(
+                          neighbours[CHUNK_FACE_RIGHT], CHUNK_FACE_RIGHT, z,
+                          cell_size, height);
+
+            if (front_height < height) {
+                chunk_add_quad(scratch, CHUNK_FACE_FRONT, z, x, front_height,
+                               cell_size, height - front_height, type);
+            }
+            if (back_height < height) {
+                chunk_add_quad(scratch, CHUNK_FACE_BACK, z + cell_size - 1, x,
+                               back_height, cell_size, height - back_height,
+                               type);
+            }
+            if (left_height < height) {
+                chunk_add_quad(scratch, CHUNK_FACE_LEFT, x, z, left_height,
+                               cell_size, height - left_height, type);
+            }
+            if (right_height < height) {
+                chunk_add_quad(scratch, CHUNK_FACE_RIGHT, x + cell_size - 1, z,
+                               right_height, cell_size, height - right_height,
+                               type);
+            }
+        }
+    }
+
+    chunk_mesh_copy(output, &scratch->mesh, scratch->vertex_remap);
+
+    log_debugf("generated lod %u mesh for chunk (%d, %d) in %f ms, %zu "
+               "triangles",
+               level, self->x, self->z,
+               (get_time_microseconds() - start) / 1000.0f,
+               output->triangles.length);
+}
+
+// Build the back buffers of the meshes chosen by chunk_mesher_pop().
+[[gnu::nonnull]]
+static void chunk_mesher_process(const ChunkMesher *const restrict self,
+                                 Chunk *const restrict chunk,
+                                 ChunkMeshScratch *const restrict scratch) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(scratch != NULL);
+    assert(!chunk->pending);
+
+    // The front buffers are only swapped once the chunk is collected.
+    const uint32_t back =
+        ~atomic_load_explicit(&chunk->front_meshes, memory_order_relaxed);
+    for (uint32_t buffers = chunk->meshing_buffers &
+                            CHUNK_SECTION_MASK_ALL;
+         buffers != 0; buffers &= buffers - 1) {
+        const uint8_t i = __builtin_ctz(buffers);
+        chunk_generate_section_mesh(chunk, self->chunks, i, scratch,
+                                    &chunk->meshes[back >> i & 1][i]);
+    }
+    if (chunk->meshing_buffers >> CHUNK_GREEDY_MESH_BIT & 1 &&
+        !chunk_generate_greedy_mesh(
+            chunk, self->chunks, scratch,
+            &chunk->greedy_meshes[back >> CHUNK_GREEDY_MESH_BIT & 1])) {
+        // A partial mesh would have holes, its front buffer is not swapped.
+        chunk->meshing_buffers &= ~(1u << CHUNK_GREEDY_MESH_BIT);
+        chunk->meshing_greedy_mesh_overflows = true;
+    }
+    for (uint8_t i = 0; i < MESH_LOD_LEVELS_NUMBER; ++i) {
+        if (!(chunk->meshing_buffers >> CHUNK_LOD_MESH_BIT(i) & 1)) continue;
+        chunk_generate_lod_mesh(
+            chunk, self->chunks, i, scratch,
+            &chunk->lod_meshes[back >> CHUNK_LOD_MESH_BIT(i) & 1][i]);
+    }
+}
+
+// Called with the mutex locked, take the next chunk and choose the meshes to
+// build from the requested kinds.
+[[gnu::nonnull]] [[gnu::returns_nonnull]]
+static Chunk *chunk_mesher_pop(ChunkMesher *const self) {
+    assert(self != NULL);
+    assert(!chunk_queue_is_empty(&self->queue));
+
+    Chunk *const chunk = chunk_queue_pop(&self->queue);
+    assert(chunk->mesh_queued);
+
+    chunk->meshing_kinds = atomic_load(&chunk->mesh_requests);
+    chunk->meshing_buffers = 0;
+    chunk->meshing_greedy_mesh_overflows = false;
+    if (chunk->meshing_kinds & CHUNK_MESH_DETAILED) {
+        chunk->meshing_buffers |= chunk->mesh_dirty_sections;
+        chunk->mesh_dirty_sections = 0;
+    }
+    // The buffer bits of the whole chunk meshes follow the order of their
+    // kinds from CHUNK_GREEDY_MESH_BIT.
+    const ChunkMeshKind whole_chunk_kinds =
+        chunk->meshing_kinds & chunk->dirty_meshes;
+    chunk->meshing_buffers |= (uint32_t)(whole_chunk_kinds >> 1)
+                              << CHUNK_GREEDY_MESH_BIT;
+    chunk->dirty_meshes &= ~whole_chunk_kinds;
+    return chunk;
+}
+
+// Called with the mutex locked.
+[[gnu::nonnull]]
+static void chunk_mesher_push(ChunkMesher *const restrict self,
+                              Chunk *const restrict chunk,
+                              const int priority) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(!chunk->mesh_queued);
+
+    chunk->mesh_queued = true;
+    chunk_queue_push(&self->queue, chunk, priority);
+#ifndef __wasm__
+    pthread_cond_signal(&self->queue_condition);
+#endif
+}
+
+#ifndef __wasm__
+[[gnu::nonnull]]
+static void *chunk_mesher_thread(void *const data) {
+    assert(data != NULL);
+
+    ChunkMesher *const self = data;
+    ChunkMeshScratch *const scratch = chunk_mesh_scratch_create();
+
+    while (true) {
+        mutex_lock(&self->mutex);
+        while (self->running && chunk_queue_is_empty(&self->queue)) {
+            pthread_cond_wait(&self->queue_condition, &self->mutex);
+        }
+        if (!self->running) {
+            mutex_unlock(&self->mutex);
+            break;
+        }
+        mutex_unlock(&self->mutex);
+
+        // The chunk must not be unloaded nor edited between its removal from
+        // the queue and the end of its meshing.
+        rwlock_read_lock(&self->chunks_lock);
+        mutex_lock(&self->mutex);
+        Chunk *const chunk =
+            chunk_queue_is_empty(&self->queue) ? NULL : chunk_mesher_pop(self);
+        mutex_unlock(&self->mutex);
+
+        if (chunk != NULL) {
+            chunk_mesher_process(self, chunk, scratch);
+            mutex_lock(&self->mutex);
+            chunk_array_push(&self->meshed_chunks, chunk);
+            mutex_unlock(&self->mutex);
+        }
+        rwlock_unlock(&self->chunks_lock);
+    }
+
+    chunk_mesh_scratch_destroy(scratch);
+    return NULL;
+}
+#endif
+
+void chunk_mesher_init(ChunkMesher *const restrict self,
+                       const ChunkMap *const restrict chunks) {
+    assert(self != NULL);
+    assert(chunks != NULL);
+
+    chunk_queue_init(&self->queue, (WORLD_LOAD_DISTANCE * 2 + 1) *
+                                       (WORLD_LOAD_DISTANCE * 2 + 1));
+    chunk_array_init(&self->meshed_chunks, WORLD_LOAD_DISTANCE * 2 + 1);
+    self->chunks = chunks;
+
+#ifndef __wasm__
+    pthread_mutex_init(&self->mutex, NULL);
+    pthread_cond_init(&self->queue_condition, NULL);
+
+    // The main thread must not starve behind the meshing threads.
+    pthread_rwlockattr_t attributes;
+    pthread_rwlockattr_init(&attributes);
+    pthread_rwlockattr_setkind_np(
+        &attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&self->chunks_lock, &attributes);
+    pthread_rwlockattr_destroy(&attributes);
+
+    self->running = true;
+    for (size_t i = 0; i < CHUNK_MESHING_THREADS_NUMBER; ++i) {
+        const int return_code =
+            pthread_create(&self->threads[i], NULL, chunk_mesher_thread, self);
+        if (return_code != 0) {
+            log_errorf("failed to create chunk meshing thread: %s",
+                       strerror(return_code));
+            exit(EXIT_FAILURE);
+        }
+    }
+#else
+    self->scratch = chunk_mesh_scratch_create();
+#endif
+}
+
+void chunk_mesher_destroy(ChunkMesher *const self) {
+    assert(self != NULL);
+
+#ifndef __wasm__
+    mutex_lock(&self->mutex);
+    self->running = false;
+    pthread_cond_broadcast(&self->queue_condition);
+    mutex_unlock(&self->mutex);
+
+    for (size_t i = 0; i < CHUNK_MESHING_THREADS_NUMBER; ++i) {
+        const int return_code = pthread_join(self->threads[i], NULL);
+        if (return_code != 0) {
+            log_errorf("failed to join chunk meshing thread: %s",
+                       strerror(return_code));
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    pthread_rwlock_destroy(&self->chunks_lock);
+    pthread_cond_destroy(&self->queue_condition);
+    mutex_destroy(&self->mutex);
+#else
+    chunk_mesh_scratch_destroy(self->scratch);
+#endif
+
+    array_destroy((const Array *)&self->meshed_chunks);
+    chunk_queue_destroy(&self->queue);
+}
+
+void chunk_mesher_invalidate(ChunkMesher *const restrict self,
+                             Chunk *const restrict chunk,
+                             const ChunkSectionMask sections) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+    mutex_lock(&self->mutex);
+    chunk->mesh_dirty_sections |= sections;
+    chunk->dirty_meshes = CHUNK_MESH_WHOLE_CHUNK;
+    mutex_unlock(&self->mutex);
+    chunk->stale_meshes = CHUNK_MESH_ALL;
+    // The edit may make the greedy mesh fit.
+    chunk->greedy_mesh_overflows = false;
+}
+
+void chunk_mesher_request(ChunkMesher *const restrict self,
+                          Chunk *const restrict chunk,
+                          const ChunkMeshKind kind, const int priority) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(kind != 0 && (kind & (kind - 1)) == 0 && kind <= CHUNK_MESH_ALL);
+
+    // Requested by another render thread or a previous frame.
+    if (atomic_fetch_or(&chunk->mesh_requests, kind) & kind) return;
+
+    mutex_lock(&self->mutex);
+    if (!chunk->mesh_queued) chunk_mesher_push(self, chunk, priority);
+    mutex_unlock(&self->mutex);
+}
+
+void chunk_mesher_cancel(ChunkMesher *const restrict self,
+                         Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+    mutex_lock(&self->mutex);
+    if (chunk->mesh_queued && !chunk_queue_remove(&self->queue, chunk)) {
+        for (size_t i = 0; i < self->meshed_chunks.length; ++i) {
+            if (self->meshed_chunks.array[i] == chunk) {
+                chunk_array_remove(&self->meshed_chunks, i);
+                break;
+            }
+        }
+    }
+    chunk->mesh_queued = false;
+    mutex_unlock(&self->mutex);
+}
+
+void chunk_mesher_collect(ChunkMesher *const self) {
+    assert(self != NULL);
+
+#ifdef __wasm__
+    // Without threads, spread the meshing over the frames.
+    for (int i = 0; i < CHUNK_MESHING_CHUNKS_PER_FRAME &&
+                    !chunk_queue_is_empty(&self->queue);
+         ++i) {
+        Chunk *const chunk = chunk_mesher_pop(self);
+        chunk_mesher_process(self, chunk, self->scratch);
+        chunk_array_push(&self->meshed_chunks, chunk);
+    }
+#endif
+
+    mutex_lock(&self->mutex);
+    for (size_t i = 0; i < self->meshed_chunks.length; ++i) {
+        Chunk *const chunk = self->meshed_chunks.array[i];
+        atomic_fetch_xor_explicit(&chunk->front_meshes, chunk->meshing_buffers,
+                                  memory_order_release);
+        chunk->built_meshes |= chunk->meshing_kinds;
+        if (chunk->meshing_greedy_mesh_overflows) {
+            chunk->built_meshes &= ~CHUNK_MESH_GREEDY;
+            chunk->greedy_mesh_overflows = true;
+        }
+
+        // The chunk may have been invalidated during its meshing.
+        chunk->stale_meshes = chunk->dirty_meshes;
+        if (chunk->mesh_dirty_sections != 0) {
+            chunk->stale_meshes |= CHUNK_MESH_DETAILED;
+        }
+        const uint8_t requests =
+            atomic_fetch_and(&chunk->mesh_requests, chunk->stale_meshes) &
+            chunk->stale_meshes;
+
+        chunk->mesh_queued = false;
+        if (requests != 0) chunk_mesher_push(self, chunk, 0);
+    }
+    self->meshed_chunks.length = 0;
+    mutex_unlock(&self->mutex);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <assert.h>
+
+#include "chunk_defs.h"
+#include "chunk_mesher_defs.h"
+#include "threads.h"
+
+[[gnu::nonnull]]
+void chunk_mesher_init(ChunkMesher *const restrict self,
+                       const ChunkMap *const restrict chunks);
+
+[[gnu::nonnull]]
+void chunk_mesher_destroy(ChunkMesher *const self);
+
+// Mark the meshes of the sections and the greedy mesh as outdated, they are
+// rebuilt once requested again. Called by the main thread.
+[[gnu::nonnull]]
+void chunk_mesher_invalidate(ChunkMesher *const restrict self,
+                             Chunk *const restrict chunk,
+                             const ChunkSectionMask sections);
+
+// Queue the chunk to rebuild its outdated mesh of the given kind. Can be
+// called by the render threads.
+[[gnu::nonnull]]
+void chunk_mesher_request(ChunkMesher *const restrict self,
+                          Chunk *const restrict chunk,
+                          const ChunkMeshKind kind, const int priority);
+
+// Forget a chunk before it is unloaded, with the chunks locked.
+[[gnu::nonnull]]
+void chunk_mesher_cancel(ChunkMesher *const restrict self,
+                         Chunk *const restrict chunk);
+
+// Swap the buffers of the meshed chunks. Called by the main thread while
+// nothing is rendered.
+[[gnu::nonnull]]
+void chunk_mesher_collect(ChunkMesher *const self);
+
+[[gnu::nonnull]]
+static inline void chunk_mesher_lock_chunks(ChunkMesher *const self) {
+    assert(self != NULL);
+    rwlock_write_lock(&self->chunks_lock);
+}
+
+[[gnu::nonnull]]
+static inline void chunk_mesher_unlock_chunks(ChunkMesher *const self) {
+    assert(self != NULL);
+    rwlock_unlock(&self->chunks_lock);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#ifndef __wasm__
+#include <pthread.h>
+#endif
+
+#include "chunk_array_defs.h"
+#include "chunk_map_defs.h"
+#include "chunk_mesh_defs.h"
+#include "chunk_queue_defs.h"
+#include "config.h"
+
+// Reused by the meshes built by a thread, the meshes are built in it and then
+// copied into the chunk.
+typedef struct {
+    // A vertex index is valid only if its generation is the current one, so
+    // the table never needs to be cleared.
+    uint32_t generation;
+    uint32_t vertex_generations[(CHUNK_SIZE + 1) * (CHUNK_HEIGHT + 1) *
+                                (CHUNK_SIZE + 1)];
+    uint16_t vertex_indices[(CHUNK_SIZE + 1) * (CHUNK_HEIGHT + 1) *
+                            (CHUNK_SIZE + 1)];
+    ChunkMesh mesh;
+    // Used by chunk_mesh_copy() to group the vertices by face.
+    uint32_t vertex_remap[CHUNK_MESH_MAX_VERTICES];
+} ChunkMeshScratch;
+
+typedef struct {
+    // Chunks waiting to be meshed, the ones nearest to a camera first.
+    ChunkQueue queue;
+    // Meshed chunks waiting for their buffers to be swapped.
+    ChunkArray meshed_chunks;
+    const ChunkMap *chunks;
+#ifndef __wasm__
+    pthread_mutex_t mutex;
+    pthread_cond_t queue_condition;
+    // Read locked by the meshing threads while they build a chunk, the blocks
+    // and the chunk map must only be modified with it write locked.
+    pthread_rwlock_t chunks_lock;
+    pthread_t threads[CHUNK_MESHING_THREADS_NUMBER];
+    bool running;
+#else
+    ChunkMeshScratch *scratch;
+#endif
+} ChunkMesher;
@@ -0,0 +1,57 @@
+#include "chunk_pool.h"
+
+#include <assert.h>
+
+#include "array.h"
+#include "chunk.h"
+#include "chunk_array.h"
+#include "log.h"
+
+void chunk_pool_init(ChunkPool *const self, const size_t capacity) {
+    assert(self != NULL);
+    assert(capacity > 0);
+
+    chunk_array_init(&self->chunks, capacity);
+    self->capacity = capacity;
+    self->hits = 0;
+    self->misses = 0;
+}
+
+void chunk_pool_destroy(ChunkPool *const self) {
+    assert(self != NULL);
+
+    log_debugf("chunk pool: %zu hits, %zu misses", self->hits, self->misses);
+
+    for (size_t i = 0; i < self->chunks.length; ++i) {
+        chunk_destroy(self->chunks.array[i]);
+    }
+    array_destroy((const Array *)&self->chunks);
+}
+
+Chunk *chunk_pool_get(ChunkPool *const self, const int x, const int z,
+                      const int8_t player_index) {
+    assert(self != NULL);
+    assert(0 <= player_index && player_index < 4);
+
+    if (self->chunks.length == 0) {
+        ++self->misses;
+        return chunk_create(x, z, player_index);
+    }
+
+    ++self->hits;
+    Chunk *const chunk = self->chunks.array[--self->chunks.length];
+    chunk_reset(chunk, x, z, player_index);
+    return chunk;
+}
+
+void chunk_pool_release(ChunkPool *const restrict self,
+                        Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+    if (self->chunks.length == self->capacity) {
+        chunk_destroy(chunk);
+        return;
+    }
+    chunk_array_push(&self->chunks, chunk);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "chunk_defs.h"
+#include "chunk_pool_defs.h"
+
+[[gnu::nonnull]]
+void chunk_pool_init(ChunkPool *const self, const size_t capacity);
+
+[[gnu::nonnull]]
+void chunk_pool_destroy(ChunkPool *const self);
+
+// Return a chunk reset for the given coordinates, reusing a released chunk if
+// there is one.
+[[gnu::nonnull]] [[gnu::returns_nonnull]]
+Chunk *chunk_pool_get(ChunkPool *const self, const int x, const int z,
+                      const int8_t player_index);
+
+// Give a chunk back to the pool, it is destroyed if the pool is full.
+[[gnu::nonnull]]
+void chunk_pool_release(ChunkPool *const restrict self,
+                        Chunk *const restrict chunk);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "chunk_array_defs.h"
+
+// Unloaded chunks kept with their allocations to be reused by the next loaded
+// chunks.
+typedef struct {
+    ChunkArray chunks;
+    size_t capacity;
+    size_t hits;
+    size_t misses;
+} ChunkPool;
@@ -0,0 +1,114 @@
+#include "chunk_queue.h"
+
+#include <assert.h>
+
+#include "array.h"
+#include "utils.h"
+
+[[gnu::nonnull]]
+static inline void chunk_queue_swap(ChunkQueue *const self, const size_t i,
+                                    const size_t j) {
+    assert(self != NULL);
+    const ChunkQueueEntry tmp = self->array[i];
+    self->array[i] = self->array[j];
+    self->array[j] = tmp;
+}
+
+[[gnu::nonnull]]
+static void chunk_queue_sift_up(ChunkQueue *const self, size_t i) {
+    assert(self != NULL);
+    while (i > 0) {
+        const size_t parent = (i - 1) / 2;
+        if (self->array[parent].priority <= self->array[i].priority) return;
+        chunk_queue_swap(self, i, parent);
+        i = parent;
+    }
+}
+
+[[gnu::nonnull]]
+static void chunk_queue_sift_down(ChunkQueue *const self, size_t i) {
+    assert(self != NULL);
+    while (true) {
+        const size_t left = i * 2 + 1;
+        const size_t right = left + 1;
+        size_t smallest = i;
+        if (left < self->length &&
+            self->array[left].priority < self->array[smallest].priority) {
+            smallest = left;
+        }
+        if (right < self->length &&
+            self->array[right].priority < self->array[smallest].priority) {
+            smallest = right;
+        }
+        if (smallest == i) return;
+        chunk_queue_swap(self, i, smallest);
+        i = smallest;
+    }
+}
+
+void chunk_queue_init(ChunkQueue *const self, const size_t default_capacity) {
+    assert(self != NULL);
+    assert(0 < default_capacity);
+    self->array = malloc_or_exit(sizeof(*self->array) * default_capacity,
+                                 "failed to create chunk queue");
+    self->length = 0;
+    self->capacity = default_capacity;
+}
+
+void chunk_queue_destroy(const ChunkQueue *const self) {
+    assert(self != NULL);
+    array_destroy((const Array *)self);
+}
+
+void chunk_queue_push(ChunkQueue *const self, Chunk *const chunk,
+                      const int priority) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+    if (self->length == self->capacity) {
+        self->capacity *= 2;
+        self->array =
+            realloc_or_exit(self->array, sizeof(*self->array) * self->capacity,
+                            "failed to resize chunk queue");
+    }
+
+    self->array[self->length] = (ChunkQueueEntry){
+        .chunk = chunk,
+        .priority = priority,
+    };
+    chunk_queue_sift_up(self, self->length++);
+}
+
+Chunk *chunk_queue_pop(ChunkQueue *const self) {
+    assert(self != NULL);
+    assert(self->length > 0);
+
+    Chunk *const chunk = self->array[0].chunk;
+    self->array[0] = self->array[--self->length];
+    chunk_queue_sift_down(self, 0);
+    return chunk;
+}
+
+bool chunk_queue_remove(ChunkQueue *const self, const Chunk *const chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+    for (size_t i = 0; i < self->length; ++i) {
+        if (self->array[i].chunk != chunk) continue;
+
+        self->array[i] = self->array[--self->length];
+        if (i < self->length) {
+            chunk_queue_sift_down(self, i);
+            chunk_queue_sift_up(self, i);
+        }
+        return true;
+    }
+    return false;
+}
+
+void chunk_queue_heapify(ChunkQueue *const self) {
+    assert(self != NULL);
+    for (size_t i = self->length / 2; i-- > 0;) {
+        chunk_queue_sift_down(self, i);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "chunk_queue_defs.h"
+
+[[gnu::nonnull]]
+void chunk_queue_init(ChunkQueue *const self, const size_t default_capacity);
+
+[[gnu::nonnull]]
+void chunk_queue_destroy(const ChunkQueue *const self);
+
+[[gnu::nonnull]]
+void chunk_queue_push(ChunkQueue *const self, Chunk *const chunk,
+                      const int priority);
+
+[[gnu::nonnull]] [[gnu::returns_nonnull]]
+Chunk *chunk_queue_pop(ChunkQueue *const self);
+
+[[gnu::nonnull]]
+bool chunk_queue_remove(ChunkQueue *const self, const Chunk *const chunk);
+
+// Restore the heap order after priorities were changed in place.
+[[gnu::nonnull]]
+void chunk_queue_heapify(ChunkQueue *const self);
+
+[[gnu::nonnull]]
+static inline bool chunk_queue_is_empty(const ChunkQueue *const self) {
+    return self->length == 0;
+}
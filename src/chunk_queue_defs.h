@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "chunk_defs.h"
+
+typedef struct {
+    Chunk *chunk;
+    int priority;
+} ChunkQueueEntry;
+
+// Binary min-heap of chunks, the entry with the lowest priority comes first.
+typedef struct {
+    ChunkQueueEntry *array;
+    size_t length;
+    size_t capacity;
+} ChunkQueue;
@@ -0,0 +1,238 @@
+#include "chunk_section.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+static inline uint8_t chunk_section_get_bits_per_block(
+    const uint8_t palette_length) {
+    assert(palette_length > 1);
+    uint8_t bits_per_block = 1;
+    while ((1 << bits_per_block) < palette_length) bits_per_block *= 2;
+    return bits_per_block;
+}
+
+static inline size_t chunk_section_get_data_size(
+    const uint8_t bits_per_block) {
+    return CHUNK_SECTION_VOLUME * bits_per_block / 64 * sizeof(uint64_t);
+}
+
+[[gnu::nonnull]]
+static inline void chunk_section_set_index(ChunkSection *const self,
+                                           const size_t index,
+                                           const uint64_t palette_index) {
+    assert(self != NULL);
+    assert(self->data != NULL);
+    assert(palette_index < self->palette_length);
+
+    const size_t bit = index * self->bits_per_block;
+    const uint64_t mask = (UINT64_C(1) << self->bits_per_block) - 1;
+    self->data[bit / 64] &= ~(mask << (bit % 64));
+    self->data[bit / 64] |= palette_index << (bit % 64);
+}
+
+// Reuse the buffer of a recycled chunk if there is one.
+[[gnu::nonnull]]
+static void chunk_section_allocate_data(ChunkSection *const self) {
+    assert(self != NULL);
+    assert(self->bits_per_block > 0);
+
+    const size_t data_size = chunk_section_get_data_size(self->bits_per_block);
+    if (self->data == NULL) {
+        self->data =
+            malloc_or_exit(data_size, "failed to allocate chunk section");
+    } else {
+        self->data = realloc_or_exit(self->data, data_size,
+                                     "failed to allocate chunk section");
+    }
+}
+
+// Change the number of bits per block, keeping the same blocks.
+[[gnu::nonnull]]
+static void chunk_section_repack(ChunkSection *const self,
+                                 const uint8_t bits_per_block) {
+    assert(self != NULL);
+    assert(bits_per_block > self->bits_per_block);
+
+    const ChunkSection old_section = *self;
+
+    self->bits_per_block = bits_per_block;
+    self->data = malloc_or_exit(chunk_section_get_data_size(bits_per_block),
+                                "failed to allocate chunk section");
+    memset(self->data, 0, chunk_section_get_data_size(bits_per_block));
+
+    if (old_section.bits_per_block == 0) return;
+
+    const uint64_t mask = (UINT64_C(1) << old_section.bits_per_block) - 1;
+    for (size_t i = 0; i < CHUNK_SECTION_VOLUME; ++i) {
+        const size_t bit = i * old_section.bits_per_block;
+        chunk_section_set_index(
+            self, i, (old_section.data[bit / 64] >> (bit % 64)) & mask);
+    }
+    free(old_section.data);
+}
+
+void chunk_section_init(ChunkSection *const self, const BlockType type) {
+    assert(self != NULL);
+    assert(type < BLOCK_TYPE_COUNT);
+
+    self->data = NULL;
+    self->palette[0] = type;
+    self->palette_length = 1;
+    self->bits_per_block = 0;
+    self->block_count = type == BLOCK_TYPE_AIR ? 0 : CHUNK_SECTION_VOLUME;
+}
+
+void chunk_section_clear(ChunkSection *const self, const BlockType type) {
+    assert(self != NULL);
+    chunk_section_destroy(self);
+    chunk_section_init(self, type);
+}
+
+void chunk_section_destroy(const ChunkSection *const self) {
+    assert(self != NULL);
+    free(self->data);
+}
+
+void chunk_section_fill(ChunkSection *const restrict self,
+                        const BlockType *const restrict blocks) {
+    assert(self != NULL);
+    assert(blocks != NULL);
+
+    uint8_t palette_indices[BLOCK_TYPE_COUNT];
+    memset(palette_indices, UINT8_MAX, sizeof(palette_indices));
+
+    self->palette_length = 0;
+    self->block_count = 0;
+    for (size_t i = 0; i < CHUNK_SECTION_VOLUME; ++i) {
+        assert(blocks[i] < BLOCK_TYPE_COUNT);
+        if (blocks[i] != BLOCK_TYPE_AIR) ++self->block_count;
+        if (palette_indices[blocks[i]] != UINT8_MAX) continue;
+        palette_indices[blocks[i]] = self->palette_length;
+        self->palette[self->palette_length++] = blocks[i];
+    }
+
+    if (self->palette_length == 1) {
+        free(self->data);
+        self->data = NULL;
+        self->bits_per_block = 0;
+        return;
+    }
+
+    self->bits_per_block =
+        chunk_section_get_bits_per_block(self->palette_length);
+    chunk_section_allocate_data(self);
+    memset(self->data, 0, chunk_section_get_data_size(self->bits_per_block));
+    for (size_t i = 0; i < CHUNK_SECTION_VOLUME; ++i) {
+        const size_t bit = i * self->bits_per_block;
+        self->data[bit / 64] |= (uint64_t)palette_indices[blocks[i]]
+                                << (bit % 64);
+    }
+}
+
+size_t chunk_section_serialize(const ChunkSection *const restrict self,
+                               uint8_t *const restrict buffer) {
+    assert(self != NULL);
+    assert(buffer != NULL);
+
+    size_t size = 0;
+    buffer[size++] = self->palette_length;
+    for (uint8_t i = 0; i < self->palette_length; ++i) {
+        buffer[size++] = self->palette[i];
+    }
+    if (self->bits_per_block == 0) return size;
+
+    const size_t data_size = chunk_section_get_data_size(self->bits_per_block);
+    memcpy(&buffer[size], self->data, data_size);
+    return size + data_size;
+}
+
+size_t chunk_section_deserialize(ChunkSection *const restrict self,
+                                 const uint8_t *const restrict buffer,
+                                 const size_t size) {
+    assert(self != NULL);
+    assert(buffer != NULL);
+
+    if (size < 1) return 0;
+    const uint8_t palette_length = buffer[0];
+    if (palette_length == 0 || palette_length > BLOCK_TYPE_COUNT ||
+        size < 1 + (size_t)palette_length) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < palette_length; ++i) {
+        if (buffer[1 + i] >= BLOCK_TYPE_COUNT) return 0;
+    }
+
+    if (palette_length == 1) {
+        chunk_section_clear(self, buffer[1]);
+        return 2;
+    }
+
+    const uint8_t bits_per_block =
+        chunk_section_get_bits_per_block(palette_length);
+    const size_t data_size = chunk_section_get_data_size(bits_per_block);
+    const uint8_t *const data = &buffer[1 + palette_length];
+    if (size < 1 + palette_length + data_size) return 0;
+
+    // Indices past the palette would read outside of it.
+    const uint64_t mask = (UINT64_C(1) << bits_per_block) - 1;
+    uint16_t block_count = 0;
+    for (size_t i = 0; i < data_size / sizeof(uint64_t); ++i) {
+        uint64_t word;
+        memcpy(&word, &data[i * sizeof(uint64_t)], sizeof(word));
+        for (uint8_t bit = 0; bit < 64; bit += bits_per_block) {
+            const uint64_t palette_index = (word >> bit) & mask;
+            if (palette_index >= palette_length) return 0;
+            if (buffer[1 + palette_index] != BLOCK_TYPE_AIR) ++block_count;
+        }
+    }
+
+    self->palette_length = palette_length;
+    for (uint8_t i = 0; i < palette_length; ++i) {
+        self->palette[i] = buffer[1 + i];
+    }
+    self->bits_per_block = bits_per_block;
+    self->block_count = block_count;
+    chunk_section_allocate_data(self);
+    memcpy(self->data, data, data_size);
+    return 1 + palette_length + data_size;
+}
+
+void chunk_section_set_block(ChunkSection *const self, const size_t index,
+                             const BlockType type) {
+    assert(self != NULL);
+    assert(index < CHUNK_SECTION_VOLUME);
+    assert(type < BLOCK_TYPE_COUNT);
+
+    const BlockType old_type = chunk_section_get_block(self, index);
+    if (old_type == type) return;
+
+    if (old_type == BLOCK_TYPE_AIR) {
+        ++self->block_count;
+    } else if (type == BLOCK_TYPE_AIR) {
+        --self->block_count;
+        // Free the section once it is emptied.
+        if (self->block_count == 0) {
+            chunk_section_clear(self, BLOCK_TYPE_AIR);
+            return;
+        }
+    }
+
+    uint8_t palette_index = 0;
+    while (palette_index < self->palette_length &&
+           self->palette[palette_index] != type) {
+        ++palette_index;
+    }
+
+    if (palette_index == self->palette_length) {
+        self->palette[self->palette_length++] = type;
+        if (self->bits_per_block == 0 ||
+            self->palette_length > (1 << self->bits_per_block)) {
+            chunk_section_repack(
+                self, chunk_section_get_bits_per_block(self->palette_length));
+        }
+    }
+
+    chunk_section_set_index(self, index, palette_index);
+}
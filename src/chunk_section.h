@@ -0,0 +1,73 @@
+#pragma once
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "chunk_section_defs.h"
+
+// Blocks are stored x first so a row of blocks is contiguous.
+static inline size_t chunk_section_index(const int x, const int y,
+                                         const int z) {
+    assert(0 <= x && x < CHUNK_SIZE);
+    assert(0 <= y && y < CHUNK_SECTION_HEIGHT);
+    assert(0 <= z && z < CHUNK_SIZE);
+    return ((size_t)y * CHUNK_SIZE + z) * CHUNK_SIZE + x;
+}
+
+[[gnu::nonnull]]
+void chunk_section_init(ChunkSection *const self, const BlockType type);
+
+[[gnu::nonnull]]
+void chunk_section_destroy(const ChunkSection *const self);
+
+// Make an initialized section uniform, releasing its data.
+[[gnu::nonnull]]
+void chunk_section_clear(ChunkSection *const self, const BlockType type);
+
+// Replace the content of the section, blocks is indexed with
+// chunk_section_index().
+[[gnu::nonnull]]
+void chunk_section_fill(ChunkSection *const restrict self,
+                        const BlockType *const restrict blocks);
+
+// Write the section in buffer, return the number of bytes written.
+[[gnu::nonnull]]
+size_t chunk_section_serialize(const ChunkSection *const restrict self,
+                               uint8_t *const restrict buffer);
+
+// Read a section written by chunk_section_serialize(), return the number of
+// bytes read or 0 if the data is invalid.
+[[gnu::nonnull]]
+size_t chunk_section_deserialize(ChunkSection *const restrict self,
+                                 const uint8_t *const restrict buffer,
+                                 const size_t size);
+
+[[gnu::nonnull]]
+void chunk_section_set_block(ChunkSection *const self, const size_t index,
+                             const BlockType type);
+
+[[gnu::nonnull]]
+static inline BlockType chunk_section_get_block(
+    const ChunkSection *const self, const size_t index) {
+    assert(self != NULL);
+    assert(index < CHUNK_SECTION_VOLUME);
+
+    if (self->bits_per_block == 0) return self->palette[0];
+
+    const size_t bit = index * self->bits_per_block;
+    const uint64_t mask = (UINT64_C(1) << self->bits_per_block) - 1;
+    return self->palette[(self->data[bit / 64] >> (bit % 64)) & mask];
+}
+
+[[gnu::nonnull]]
+static inline bool chunk_section_is_uniform(const ChunkSection *const self) {
+    assert(self != NULL);
+    return self->bits_per_block == 0;
+}
+
+[[gnu::nonnull]]
+static inline bool chunk_section_is_empty(const ChunkSection *const self) {
+    assert(self != NULL);
+    return self->block_count == 0;
+}
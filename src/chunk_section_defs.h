@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "block.h"
+#include "config.h"
+
+#define CHUNK_SECTION_VOLUME (CHUNK_SIZE * CHUNK_SECTION_HEIGHT * CHUNK_SIZE)
+#define CHUNK_SECTIONS_NUMBER (CHUNK_HEIGHT / CHUNK_SECTION_HEIGHT)
+// Palette length, palette and at most 8 bits per block.
+#define CHUNK_SECTION_MAX_SERIALIZED_SIZE \
+    (1 + BLOCK_TYPE_COUNT + CHUNK_SECTION_VOLUME)
+
+static_assert(BLOCK_TYPE_COUNT <= 256, "palette indices are at most 8 bits");
+
+// A CHUNK_SIZE x CHUNK_SECTION_HEIGHT x CHUNK_SIZE slice of a chunk. A section
+// made of a single block type only stores its type, the others store a
+// palette of the block types and bit-packed indices into it.
+typedef struct {
+    uint64_t *data;  // NULL for a uniform section
+    BlockType palette[BLOCK_TYPE_COUNT];
+    uint8_t palette_length;
+    uint8_t bits_per_block;  // 0 for a uniform section, else 1, 2, 4 or 8
+    uint16_t block_count;    // number of non air blocks
+} ChunkSection;
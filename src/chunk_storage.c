@@ -0,0 +1,534 @@
+#include "chunk_storage.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "array.h"
+#include "chunk.h"
+#include "chunk_section.h"
+#include "chunk_storage_write_array.h"
+#include "log.h"
+#include "threads.h"
+#include "utils.h"
+
+#define CHUNK_STORAGE_VERSION 1
+#define CHUNK_STORAGE_REGION_CHUNKS_NUMBER \
+    (CHUNK_STORAGE_REGION_SIZE * CHUNK_STORAGE_REGION_SIZE)
+#define CHUNK_STORAGE_MAX_SERIALIZED_SIZE \
+    (1 + CHUNK_SECTIONS_NUMBER * CHUNK_SECTION_MAX_SERIALIZED_SIZE)
+// A header byte every 128 literal bytes in the worst case.
+#define CHUNK_STORAGE_MAX_COMPRESSED_SIZE \
+    (CHUNK_STORAGE_MAX_SERIALIZED_SIZE +   \
+     CHUNK_STORAGE_MAX_SERIALIZED_SIZE / 128 + 1)
+#define CHUNK_STORAGE_DIRECTORY_MAX_LENGTH 128
+#define CHUNK_STORAGE_PATH_MAX_LENGTH (CHUNK_STORAGE_DIRECTORY_MAX_LENGTH + 32)
+
+typedef struct {
+    uint32_t offset;
+    uint32_t size;  // 0 if the chunk is not in the region
+} ChunkStorageRegionEntry;
+
+#define CHUNK_STORAGE_REGION_HEADER_SIZE \
+    (sizeof(ChunkStorageRegionEntry) * CHUNK_STORAGE_REGION_CHUNKS_NUMBER)
+
+// PackBits run-length encoding: a header byte n < 128 is followed by n + 1
+// literal bytes, a header byte n > 128 is followed by a byte repeated
+// 257 - n times.
+size_t chunk_storage_compress(const uint8_t *const restrict data,
+                              const size_t size,
+                              uint8_t *const restrict buffer) {
+    assert(data != NULL);
+    assert(buffer != NULL);
+
+    size_t buffer_size = 0;
+    size_t i = 0;
+    while (i < size) {
+        size_t run_length = 1;
+        while (i + run_length < size && run_length < 128 &&
+               data[i + run_length] == data[i]) {
+            ++run_length;
+        }
+
+        if (run_length >= 3) {
+            buffer[buffer_size++] = 257 - run_length;
+            buffer[buffer_size++] = data[i];
+            i += run_length;
+            continue;
+        }
+
+        const size_t start = i;
+        while (i < size && i - start < 128 &&
+               !(i + 2 < size && data[i] == data[i + 1] &&
+                 data[i] == data[i + 2])) {
+            ++i;
+        }
+        buffer[buffer_size++] = i - start - 1;
+        memcpy(&buffer[buffer_size], &data[start], i - start);
+        buffer_size += i - start;
+    }
+
+    assert(buffer_size <= size + size / 128 + 1);
+    return buffer_size;
+}
+
+size_t chunk_storage_decompress(const uint8_t *const restrict data,
+                                const size_t size,
+                                uint8_t *const restrict buffer,
+                                const size_t buffer_capacity) {
+    assert(data != NULL);
+    assert(buffer != NULL);
+
+    size_t buffer_size = 0;
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t header = data[i++];
+        if (header < 128) {
+            const size_t length = header + 1;
+            if (i + length > size || buffer_size + length > buffer_capacity) {
+                return 0;
+            }
+            memcpy(&buffer[buffer_size], &data[i], length);
+            i += length;
+            buffer_size += length;
+        } else if (header > 128) {
+            const size_t length = 257 - header;
+            if (i >= size || buffer_size + length > buffer_capacity) return 0;
+            memset(&buffer[buffer_size], data[i++], length);
+            buffer_size += length;
+        } else {
+            return 0;
+        }
+    }
+    return buffer_size;
+}
+
+[[gnu::nonnull]]
+static size_t chunk_storage_serialize(const Chunk *const restrict chunk,
+                                      uint8_t *const restrict buffer) {
+    assert(chunk != NULL);
+    assert(buffer != NULL);
+
+    size_t size = 0;
+    buffer[size++] = CHUNK_STORAGE_VERSION;
+    for (uint8_t i = 0; i < CHUNK_SECTIONS_NUMBER; ++i) {
+        size += chunk_section_serialize(&chunk->sections[i], &buffer[size]);
+    }
+    assert(size <= CHUNK_STORAGE_MAX_SERIALIZED_SIZE);
+    return size;
+}
+
+[[gnu::nonnull]]
+static bool chunk_storage_deserialize(Chunk *const restrict chunk,
+                                      const uint8_t *const restrict data,
+                                      const size_t size) {
+    assert(chunk != NULL);
+    assert(data != NULL);
+
+    if (size < 1 || data[0] != CHUNK_STORAGE_VERSION) return false;
+
+    size_t offset = 1;
+    for (uint8_t i = 0; i < CHUNK_SECTIONS_NUMBER; ++i) {
+        const size_t section_size = chunk_section_deserialize(
+            &chunk->sections[i], &data[offset], size - offset);
+        if (section_size == 0) return false;
+        offset += section_size;
+    }
+    return offset == size;
+}
+
+[[gnu::nonnull]]
+static void chunk_storage_get_region_path(
+    const ChunkStorage *const restrict self, const int x, const int z,
+    char *const restrict path) {
+    assert(self != NULL);
+    assert(path != NULL);
+
+    [[maybe_unused]] const int written = snprintf(
+        path, CHUNK_STORAGE_PATH_MAX_LENGTH, "%s/r.%d.%d.bin", self->directory,
+        floor_div_int(x, CHUNK_STORAGE_REGION_SIZE),
+        floor_div_int(z, CHUNK_STORAGE_REGION_SIZE));
+    assert(0 < written && written < CHUNK_STORAGE_PATH_MAX_LENGTH);
+}
+
+static inline size_t chunk_storage_get_region_index(const int x, const int z) {
+    return POSITIVE_MOD(z, CHUNK_STORAGE_REGION_SIZE) *
+               CHUNK_STORAGE_REGION_SIZE +
+           POSITIVE_MOD(x, CHUNK_STORAGE_REGION_SIZE);
+}
+
+[[gnu::nonnull]]
+static bool write_all(const int fd, const void *const data, const size_t size,
+                      const off_t offset) {
+    assert(data != NULL);
+
+    size_t written = 0;
+    while (written < size) {
+        const ssize_t return_code =
+            pwrite(fd, (const uint8_t *)data + written, size - written,
+                   offset + written);
+        if (return_code < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        written += return_code;
+    }
+    return true;
+}
+
+// The previous versions of the chunks take at most the size of the current
+// ones, so the offsets always fit.
+static_assert(CHUNK_STORAGE_REGION_HEADER_SIZE +
+                  3 * (uint64_t)CHUNK_STORAGE_REGION_CHUNKS_NUMBER *
+                      CHUNK_STORAGE_MAX_COMPRESSED_SIZE <=
+              UINT32_MAX);
+
+// Rewrite the region without the previous versions of its chunks. The new file
+// replaces the region once it is complete, so that the region is never left
+// partially written.
+[[gnu::nonnull]]
+static void chunk_storage_compact_region(
+    const char *const restrict path, const int fd, const size_t file_size,
+    ChunkStorageRegionEntry *const restrict entries) {
+    assert(path != NULL);
+    assert(entries != NULL);
+
+    uint8_t *const file = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (file == MAP_FAILED) {
+        log_errorf_errno("failed to map '%s'", path);
+        return;
+    }
+
+    char new_path[CHUNK_STORAGE_PATH_MAX_LENGTH + sizeof(".new")];
+    snprintf(new_path, sizeof(new_path), "%s.new", path);
+    const int new_fd =
+        open(new_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (new_fd < 0) {
+        log_errorf_errno("failed to open '%s'", new_path);
+        munmap(file, file_size);
+        return;
+    }
+
+    bool written = true;
+    uint32_t offset = CHUNK_STORAGE_REGION_HEADER_SIZE;
+    for (size_t i = 0; written && i < CHUNK_STORAGE_REGION_CHUNKS_NUMBER; ++i) {
+        if (entries[i].size == 0) continue;
+        written = write_all(new_fd, &file[entries[i].offset], entries[i].size,
+                            offset);
+        entries[i].offset = offset;
+        offset += entries[i].size;
+    }
+    munmap(file, file_size);
+    written = written &&
+              write_all(new_fd, entries, CHUNK_STORAGE_REGION_HEADER_SIZE, 0) &&
+              fsync(new_fd) == 0;
+    if (!written) log_errorf_errno("failed to write '%s'", new_path);
+    close(new_fd);
+
+    if (written && rename(new_path, path) < 0) {
+        log_errorf_errno("failed to replace '%s'", path);
+        written = false;
+    }
+    if (!written) unlink(new_path);
+}
+
+// Called by the storage thread with the files lock locked for writing. The
+// chunk is appended to the region and its entry only updated once it is
+// written, so that an interrupted write keeps the previous version.
+[[gnu::nonnull]]
+static void chunk_storage_write_region(const ChunkStorage *const restrict self,
+                                       const int x, const int z,
+                                       const uint8_t *const restrict data,
+                                       const size_t size) {
+    assert(self != NULL);
+    assert(data != NULL);
+    assert(size > 0);
+
+    char path[CHUNK_STORAGE_PATH_MAX_LENGTH];
+    chunk_storage_get_region_path(self, x, z, path);
+
+    const int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        log_errorf_errno("failed to open '%s'", path);
+        return;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) < 0) {
+        log_errorf_errno("failed to stat '%s'", path);
+        close(fd);
+        return;
+    }
+
+    size_t file_size = file_stat.st_size;
+    if (file_size < CHUNK_STORAGE_REGION_HEADER_SIZE) {
+        // The new table is filled with zeros: the region is empty.
+        if (ftruncate(fd, CHUNK_STORAGE_REGION_HEADER_SIZE) < 0) {
+            log_errorf_errno("failed to create '%s'", path);
+            close(fd);
+            return;
+        }
+        file_size = CHUNK_STORAGE_REGION_HEADER_SIZE;
+    }
+
+    ChunkStorageRegionEntry entries[CHUNK_STORAGE_REGION_CHUNKS_NUMBER];
+    if (pread(fd, entries, sizeof(entries), 0) != (ssize_t)sizeof(entries)) {
+        log_errorf_errno("failed to read '%s'", path);
+        close(fd);
+        return;
+    }
+
+    const size_t index = chunk_storage_get_region_index(x, z);
+    assert(file_size + size <= UINT32_MAX);
+    entries[index] = (ChunkStorageRegionEntry){
+        .offset = file_size,
+        .size = size,
+    };
+    if (!write_all(fd, data, size, file_size) ||
+        !write_all(fd, &entries[index], sizeof(entries[index]),
+                   index * sizeof(entries[index]))) {
+        log_errorf_errno("failed to write '%s'", path);
+        close(fd);
+        return;
+    }
+    file_size += size;
+
+    size_t chunks_size = 0;
+    for (size_t i = 0; i < CHUNK_STORAGE_REGION_CHUNKS_NUMBER; ++i) {
+        chunks_size += entries[i].size;
+    }
+    if (file_size - CHUNK_STORAGE_REGION_HEADER_SIZE > 2 * chunks_size) {
+        chunk_storage_compact_region(path, fd, file_size, entries);
+    }
+    close(fd);
+}
+
+// Called with the files lock locked for reading.
+[[gnu::nonnull]]
+static bool chunk_storage_read_region(const ChunkStorage *const restrict self,
+                                      Chunk *const restrict chunk,
+                                      uint8_t *const restrict buffer) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(buffer != NULL);
+
+    char path[CHUNK_STORAGE_PATH_MAX_LENGTH];
+    chunk_storage_get_region_path(self, chunk->x, chunk->z, path);
+
+    const int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno != ENOENT) log_errorf_errno("failed to open '%s'", path);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) < 0) {
+        log_errorf_errno("failed to stat '%s'", path);
+        close(fd);
+        return false;
+    }
+    const size_t file_size = file_stat.st_size;
+    if (file_size < CHUNK_STORAGE_REGION_HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
+
+    uint8_t *const file = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED) {
+        log_errorf_errno("failed to map '%s'", path);
+        return false;
+    }
+
+    ChunkStorageRegionEntry entry;
+    memcpy(&entry,
+           &file[chunk_storage_get_region_index(chunk->x, chunk->z) *
+                 sizeof(entry)],
+           sizeof(entry));
+
+    bool loaded = false;
+    if (entry.size > 0) {
+        if (entry.offset < CHUNK_STORAGE_REGION_HEADER_SIZE ||
+            (size_t)entry.offset + entry.size > file_size) {
+            log_errorf("invalid chunk (%d, %d) in '%s'", chunk->x, chunk->z,
+                       path);
+        } else {
+            const size_t size =
+                chunk_storage_decompress(&file[entry.offset], entry.size,
+                                         buffer,
+                                         CHUNK_STORAGE_MAX_SERIALIZED_SIZE);
+            loaded = chunk_storage_deserialize(chunk, buffer, size);
+            if (!loaded) {
+                log_errorf("corrupted chunk (%d, %d) in '%s'", chunk->x,
+                           chunk->z, path);
+            }
+        }
+    }
+
+    munmap(file, file_size);
+    return loaded;
+}
+
+[[gnu::nonnull]]
+static void *chunk_storage_thread(void *const data) {
+    assert(data != NULL);
+
+    ChunkStorage *const self = data;
+    uint8_t *const buffer = malloc_or_exit(CHUNK_STORAGE_MAX_COMPRESSED_SIZE,
+                                           "failed to create chunk buffer");
+
+    mutex_lock(&self->mutex);
+    while (true) {
+        while (self->running && self->writes.length == 0) {
+            pthread_cond_wait(&self->condition, &self->mutex);
+        }
+        // Exit only once every chunk is written.
+        if (self->writes.length == 0) break;
+        mutex_unlock(&self->mutex);
+
+        // Readers must not see a write in progress nor miss the chunk between
+        // its removal from the queue and the end of the write.
+        rwlock_write_lock(&self->files_lock);
+        mutex_lock(&self->mutex);
+        const ChunkStorageWrite write = self->writes.array[0];
+        chunk_storage_write_array_remove(&self->writes, 0);
+        mutex_unlock(&self->mutex);
+
+        const size_t size =
+            chunk_storage_compress(write.data, write.size, buffer);
+        chunk_storage_write_region(self, write.x, write.z, buffer, size);
+        rwlock_unlock(&self->files_lock);
+        free(write.data);
+
+        mutex_lock(&self->mutex);
+    }
+    mutex_unlock(&self->mutex);
+
+    free(buffer);
+    return NULL;
+}
+
+[[gnu::nonnull]]
+static void create_directory(const char *const path) {
+    assert(path != NULL);
+    if (mkdir(path, 0755) < 0 && errno != EEXIST) {
+        log_errorf_errno("failed to create directory '%s'", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+void chunk_storage_init(ChunkStorage *const self, const uint32_t seed) {
+    assert(self != NULL);
+
+    self->directory = malloc_or_exit(CHUNK_STORAGE_DIRECTORY_MAX_LENGTH,
+                                     "failed to create chunk storage");
+    [[maybe_unused]] const int written =
+        snprintf(self->directory, CHUNK_STORAGE_DIRECTORY_MAX_LENGTH, "%s/%u",
+                 CHUNK_STORAGE_DIRECTORY, seed);
+    assert(0 < written && written < CHUNK_STORAGE_DIRECTORY_MAX_LENGTH);
+    create_directory(CHUNK_STORAGE_DIRECTORY);
+    create_directory(self->directory);
+
+    chunk_storage_write_array_init(&self->writes, 16);
+    pthread_mutex_init(&self->mutex, NULL);
+    pthread_cond_init(&self->condition, NULL);
+    pthread_rwlock_init(&self->files_lock, NULL);
+    self->running = true;
+
+    const int return_code =
+        pthread_create(&self->thread, NULL, chunk_storage_thread, self);
+    if (return_code != 0) {
+        log_errorf("failed to create chunk storage thread: %s",
+                   strerror(return_code));
+        exit(EXIT_FAILURE);
+    }
+}
+
+void chunk_storage_destroy(ChunkStorage *const self) {
+    assert(self != NULL);
+
+    mutex_lock(&self->mutex);
+    self->running = false;
+    pthread_cond_signal(&self->condition);
+    mutex_unlock(&self->mutex);
+
+    const int return_code = pthread_join(self->thread, NULL);
+    if (return_code != 0) {
+        log_errorf("failed to join chunk storage thread: %s",
+                   strerror(return_code));
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_rwlock_destroy(&self->files_lock);
+    pthread_cond_destroy(&self->condition);
+    mutex_destroy(&self->mutex);
+    array_destroy((const Array *)&self->writes);
+    free(self->directory);
+}
+
+void chunk_storage_save(ChunkStorage *const restrict self,
+                        const Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(!chunk->pending);
+
+    log_debugf("save chunk (%d, %d)", chunk->x, chunk->z);
+
+    uint8_t *data = malloc_or_exit(CHUNK_STORAGE_MAX_SERIALIZED_SIZE,
+                                   "failed to save chunk");
+    const size_t size = chunk_storage_serialize(chunk, data);
+    data = realloc_or_exit(data, size, "failed to save chunk");
+
+    mutex_lock(&self->mutex);
+    chunk_storage_write_array_push(&self->writes, (ChunkStorageWrite){
+                                                      .x = chunk->x,
+                                                      .z = chunk->z,
+                                                      .data = data,
+                                                      .size = size,
+                                                  });
+    pthread_cond_signal(&self->condition);
+    mutex_unlock(&self->mutex);
+}
+
+bool chunk_storage_load(ChunkStorage *const restrict self,
+                        Chunk *const restrict chunk) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+
+    rwlock_read_lock(&self->files_lock);
+
+    // The chunk may not be written yet, the latest save wins.
+    ChunkStorageWrite write = {.data = NULL};
+    mutex_lock(&self->mutex);
+    for (size_t i = self->writes.length; i > 0; --i) {
+        if (self->writes.array[i - 1].x == chunk->x &&
+            self->writes.array[i - 1].z == chunk->z) {
+            write = self->writes.array[i - 1];
+            break;
+        }
+    }
+    mutex_unlock(&self->mutex);
+
+    bool loaded;
+    if (write.data != NULL) {
+        // The storage thread can not free it while the files lock is held.
+        loaded = chunk_storage_deserialize(chunk, write.data, write.size);
+        assert(loaded);
+    } else {
+        uint8_t *const buffer = malloc_or_exit(
+            CHUNK_STORAGE_MAX_SERIALIZED_SIZE, "failed to load chunk");
+        loaded = chunk_storage_read_region(self, chunk, buffer);
+        free(buffer);
+    }
+
+    rwlock_unlock(&self->files_lock);
+
+    if (loaded) log_debugf("loaded chunk (%d, %d)", chunk->x, chunk->z);
+    return loaded;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "chunk_defs.h"
+#include "chunk_storage_defs.h"
+
+[[gnu::nonnull]]
+void chunk_storage_init(ChunkStorage *const self, const uint32_t seed);
+
+// Write the chunks still waiting to be saved before returning.
+[[gnu::nonnull]]
+void chunk_storage_destroy(ChunkStorage *const self);
+
+// Queue the chunk to be written by the storage thread.
+[[gnu::nonnull]]
+void chunk_storage_save(ChunkStorage *const restrict self,
+                        const Chunk *const restrict chunk);
+
+// Read the blocks of the chunk, return false if the chunk was never saved.
+[[gnu::nonnull]]
+bool chunk_storage_load(ChunkStorage *const restrict self,
+                        Chunk *const restrict chunk);
+
+// Compress the data with a run-length encoding, the buffer must hold
+// size + size / 128 + 1 bytes. Return the size of the compressed data.
+[[gnu::nonnull]]
+size_t chunk_storage_compress(const uint8_t *const restrict data,
+                              const size_t size,
+                              uint8_t *const restrict buffer);
+
+// Return the size of the decompressed data or 0 if the data is invalid or
+// doesn't fit in the buffer.
+[[gnu::nonnull]]
+size_t chunk_storage_decompress(const uint8_t *const restrict data,
+                                const size_t size,
+                                uint8_t *const restrict buffer,
+                                const size_t buffer_capacity);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <pthread.h>
+
+#include "chunk_storage_write_array_defs.h"
+
+// Chunks saved on disk, grouped by regions of
+// CHUNK_STORAGE_REGION_SIZE x CHUNK_STORAGE_REGION_SIZE chunks. A region file
+// starts with a table of the offset and size of each chunk in the file,
+// followed by the compressed chunks. The chunks are appended when they are
+// saved, the previous versions are removed once they take more space than the
+// current ones.
+typedef struct ChunkStorage {
+    char *directory;
+    // Chunks waiting to be written, the oldest first.
+    ChunkStorageWriteArray writes;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    // Locked for writing while a region file is modified.
+    pthread_rwlock_t files_lock;
+    pthread_t thread;
+    bool running;
+} ChunkStorage;
@@ -0,0 +1,3 @@
+#include "chunk_storage_write_array.h"
+
+ARRAY_IMPLEMENTATION(chunk_storage_write, ChunkStorageWrite, ChunkStorageWrite)
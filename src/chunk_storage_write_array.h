@@ -0,0 +1,6 @@
+#pragma once
+
+#include "array.h"
+#include "chunk_storage_write_array_defs.h"
+
+DEFINE_ARRAY(chunk_storage_write, ChunkStorageWrite, ChunkStorageWrite)
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "array_defs.h"
+
+// A serialized chunk waiting to be compressed and written to its region.
+typedef struct {
+    int x, z;
+    uint8_t *data;
+    size_t size;
+} ChunkStorageWrite;
+
+DEFINE_ARRAY_TYPE(ChunkStorageWrite, ChunkStorageWrite);
@@ -0,0 +1,3 @@
+#include "chunk_triangle_array.h"
+
+ARRAY_IMPLEMENTATION(chunk_triangle, ChunkTriangle, ChunkTriangle)
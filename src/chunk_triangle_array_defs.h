@@ -0,0 +1,6 @@
+#pragma once
+
+#include "array_defs.h"
+#include "chunk_triangle_defs.h"
+
+DEFINE_ARRAY_TYPE(ChunkTriangle, ChunkTriangle);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "block.h"
+
+typedef enum : uint8_t {
+    CHUNK_FACE_FRONT,   // -z
+    CHUNK_FACE_BACK,    // +z
+    CHUNK_FACE_LEFT,    // -x
+    CHUNK_FACE_RIGHT,   // +x
+    CHUNK_FACE_TOP,     // +y
+    CHUNK_FACE_BOTTOM,  // -y
+    CHUNK_FACE_COUNT,
+} ChunkFace;
+
+// Position of a vertex relative to the chunk.
+typedef struct {
+    uint8_t x;
+    uint8_t z;
+    uint16_t y;
+} ChunkVertex;
+
+// The uv coordinate of a vertex is 0 or the size of the face along the axis,
+// the texture is repeated once per block.
+#define CHUNK_TRIANGLE_UV(vertex, u, v) \
+    ((u) << (2 * (vertex)) | (v) << (2 * (vertex) + 1))
+// (0, 1), (0, 0), (1, 0)
+#define CHUNK_TRIANGLE_UVS_FIRST_HALF \
+    (CHUNK_TRIANGLE_UV(0, 0, 1) | CHUNK_TRIANGLE_UV(2, 1, 0))
+// (1, 0), (1, 1), (0, 1)
+#define CHUNK_TRIANGLE_UVS_SECOND_HALF                        \
+    (CHUNK_TRIANGLE_UV(0, 1, 0) | CHUNK_TRIANGLE_UV(1, 1, 1) | \
+     CHUNK_TRIANGLE_UV(2, 0, 1))
+
+// The texture and the color come from the tables of the block for the face.
+typedef struct {
+    uint16_t v1;
+    uint16_t v2;
+    uint16_t v3;
+    BlockType block;
+    ChunkFace face;
+    uint8_t uvs;  // CHUNK_TRIANGLE_UV()
+    uint8_t edges;
+} ChunkTriangle;
@@ -0,0 +1,3 @@
+#include "chunk_vertex_array.h"
+
+ARRAY_IMPLEMENTATION(chunk_vertex, ChunkVertex, ChunkVertex)
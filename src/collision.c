@@ -72,3 +72,18 @@ bool aabb_collide_ray(const Aabb *const restrict aabb, const v3f ray_start,
 
     return true;
 }
+
+float aabb_get_distance_squared(const Aabb *const aabb, const v3f point) {
+    assert(aabb != NULL);
+
+    const v3f distance = {
+        max3_float(aabb->position.x - point.x, 0.0f,
+                   point.x - (aabb->position.x + aabb->size.x)),
+        max3_float(aabb->position.y - point.y, 0.0f,
+                   point.y - (aabb->position.y + aabb->size.y)),
+        max3_float(aabb->position.z - point.z, 0.0f,
+                   point.z - (aabb->position.z + aabb->size.z)),
+    };
+    return distance.x * distance.x + distance.y * distance.y +
+           distance.z * distance.z;
+}
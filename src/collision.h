@@ -7,3 +7,7 @@ bool aabb_collide_ray(const Aabb *const restrict aabb, const v3f ray_start,
                       const v3f ray_direction,
                       float *const restrict collision_time,
                       CollisionAxis *const restrict collision_axis);
+
+// Squared distance between the AABB and a point, 0 if the point is inside.
+[[gnu::nonnull]]
+float aabb_get_distance_squared(const Aabb *const aabb, const v3f point);
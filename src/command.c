@@ -17,9 +17,8 @@
 static_assert(COMMAND_CAPACITY < ERROR_MESSAGE_CAPACITY,
               "An error message must be able to contain the command");
 
-#define WORLD_ORIGIN (WORLD_SIZE / 2)
-#define WORLD_MIN_X (-WORLD_ORIGIN * CHUNK_SIZE)
-#define WORLD_MAX_X ((WORLD_SIZE - WORLD_ORIGIN) * CHUNK_SIZE - 1)
+#define WORLD_MIN_X (-WORLD_BORDER)
+#define WORLD_MAX_X WORLD_BORDER
 #define WORLD_MIN_Y 0
 #define WORLD_MAX_Y CHUNK_HEIGHT
 #define WORLD_MIN_Z WORLD_MIN_X
@@ -11,31 +11,60 @@
 
 #define CHUNK_SIZE 16                            // m
 #define CHUNK_HEIGHT 256                         // m
+#define CHUNK_SECTION_HEIGHT 16                  // m
 #define CHUNK_GENERATION_MIN_TERRAIN_HEIGHT 60   // m
 #define CHUNK_GENERATION_MAX_TERRAIN_HEIGHT 170  // m
 #define CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_FREQUENCY 0.005f
 #define CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_DEPTH 5
 #define CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_POW 4.0f
+#define CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_RESOLUTION 4  // m
 #define CHUNK_GENERATION_DESERT_NOISE_FREQUENCY 0.0025f
 #define CHUNK_GENERATION_DESERT_NOISE_DEPTH 1
 #define CHUNK_GENERATION_DESERT_NOISE_THRESHOLD 0.55f
+#define CHUNK_GENERATION_DESERT_NOISE_RESOLUTION 16  // m
 #define CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS 1  // m
 #define CHUNK_GENERATION_SURFACE_LAYER_MAX_THICKNESS 5  // m
 #define CHUNK_GENERATION_SURFACE_LAYER_NOISE_FREQUENCY 0.1f
 #define CHUNK_GENERATION_SURFACE_LAYER_NOISE_DEPTH 1
+#define CHUNK_GENERATION_SURFACE_LAYER_NOISE_RESOLUTION 1  // m
 #define CHUNK_GENERATION_MIN_SNOW_HEIGHT 100          // m
 #define CHUNK_GENERATION_MIN_SNOW_HEIGHT_VARIATION 5  // m
 #define CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_FREQUENCY 0.1f
 #define CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_DEPTH 1
+#define CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_RESOLUTION 1  // m
+#ifndef __wasm__
+#define CHUNK_GENERATION_THREADS_NUMBER 4
+#define CHUNK_MESHING_THREADS_NUMBER 2
+#else
+#define CHUNK_GENERATION_CHUNKS_PER_FRAME 2
+#define CHUNK_MESHING_CHUNKS_PER_FRAME 8
+#endif
+#ifndef __wasm__
+#define CHUNK_STORAGE_DIRECTORY "saves"
+#define CHUNK_STORAGE_REGION_SIZE 32  // chunks
+#endif
 
-#define WORLD_SIZE 6250          // chunks
+// Past this distance from the origin, float positions lose too much precision.
+#define WORLD_BORDER 1000000     // m
 #define WORLD_RENDER_DISTANCE 6  // chunks
 #define WORLD_LOAD_DISTANCE (WORLD_RENDER_DISTANCE + 1)
 #define WORLD_RENDER_THREADS_NUMBER 18
+// The world is rendered in a view per player, at the same time.
+#define WORLD_VIEWS_NUMBER 4
+#define WORLD_RENDER_CHUNKS_NUMBER \
+    ((WORLD_RENDER_DISTANCE * 2 + 1) * (WORLD_RENDER_DISTANCE * 2 + 1))
+#define WORLD_CHUNK_MAP_DEFAULT_CAPACITY 1024
+#define WORLD_CHUNK_POOL_CAPACITY ((WORLD_LOAD_DISTANCE * 2 + 1) * 4)
 #ifndef __wasm__
 #define WORLD_RENDER_SCHEDULER_DYNAMIC
 #endif
 
+#ifndef __wasm__
+// The thread joining the jobs runs them too.
+#define JOBS_THREADS_NUMBER (WORLD_RENDER_THREADS_NUMBER - 1)
+#define JOBS_QUEUE_CAPACITY 256
+#endif
+
 #define CAMERA_FOV RAD(60.0f /* deg */)
 #define CAMERA_Z_NEAR 0.01f
 #define CAMERA_Z_FAR 300.0f
@@ -74,9 +103,27 @@
 #define MESH_OUTLINE_Z_CORRECTION 0.075f
 #define MESH_OUTLINE_MAX_DISTANCE PLAYER_RANGE
 #define MESH_FAR_OUTLINE_MAX_DISTANCE 15.0f  // m
+#define MESH_GREEDY_MIN_DISTANCE MESH_FAR_OUTLINE_MAX_DISTANCE  // m
+// The level of detail i has cells of 2^(i + 1) blocks and is used from
+// MESH_LOD_MIN_DISTANCE * 2^i.
+#define MESH_LOD_LEVELS_NUMBER 3
+#define MESH_LOD_MIN_DISTANCE (CHUNK_SIZE * 3.0f)  // m
 #define MESH_SHADOW_DISTANCE (CHUNK_SIZE * WORLD_RENDER_DISTANCE * 0.96f)
 #define MESH_SHADOW_COLOR COLOR_DARK_GREY
 
+// The render threads bin the triangles by tile of the screen, then each tile
+// is rasterized by a single thread.
+#define RENDER_TILE_WIDTH 32   // characters
+#define RENDER_TILE_HEIGHT 16  // characters
+#define RENDER_TILE_BIN_DEFAULT_CAPACITY 64
+#define RENDER_TILE_BIN_GROUPS_DEFAULT_CAPACITY 4
+// Each render thread allocates the memory of a frame in an arena, which grows
+// to the most used in a frame.
+#define RENDER_ARENA_DEFAULT_CAPACITY (256 * 1024)  // bytes
+// While a tile is rasterized, the farthest depth of each block of the tile is
+// kept to skip the chunks and the triangles behind it.
+#define RENDER_HI_Z_BLOCK_SIZE 8  // characters
+
 #define GAMEPAD_ARRAY_DEFAULT_CAPACITY 4
 #define GAMEPAD_AXIS_ROUND 0.01f
 #define GAMEPAD_RUMBLE_EFFECT_LOW_FREQUENCY 0x3333
@@ -134,6 +181,12 @@ static_assert(0 < CHUNK_SIZE && CHUNK_SIZE <= 256,
 STATIC_ASSERT_IS_INTEGER(CHUNK_HEIGHT);
 static_assert(0 < CHUNK_HEIGHT && CHUNK_HEIGHT <= 256,
               "CHUNK_HEIGHT mush be between 0 and 256");
+STATIC_ASSERT_IS_INTEGER(CHUNK_SECTION_HEIGHT);
+static_assert(0 < CHUNK_SECTION_HEIGHT &&
+                  CHUNK_HEIGHT % CHUNK_SECTION_HEIGHT == 0,
+              "CHUNK_SECTION_HEIGHT must divide CHUNK_HEIGHT");
+static_assert(CHUNK_SIZE * CHUNK_SECTION_HEIGHT * CHUNK_SIZE % 64 == 0,
+              "a chunk section must fill whole 64 bits words");
 
 STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_MIN_TERRAIN_HEIGHT);
 static_assert(0 <= CHUNK_GENERATION_MIN_TERRAIN_HEIGHT &&
@@ -148,12 +201,18 @@ static_assert(0.0f < CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_FREQUENCY);
 STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_DEPTH);
 static_assert(0 < CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_DEPTH);
 static_assert(0.0f < CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_POW);
+STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_RESOLUTION);
+static_assert(0 < CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_RESOLUTION &&
+              CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_RESOLUTION <= CHUNK_SIZE);
 
 static_assert(0.0f < CHUNK_GENERATION_DESERT_NOISE_FREQUENCY);
 STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_DESERT_NOISE_DEPTH);
 static_assert(0 < CHUNK_GENERATION_DESERT_NOISE_DEPTH);
 static_assert(0.0f <= CHUNK_GENERATION_DESERT_NOISE_THRESHOLD &&
               CHUNK_GENERATION_DESERT_NOISE_THRESHOLD <= 1.0f);
+STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_DESERT_NOISE_RESOLUTION);
+static_assert(0 < CHUNK_GENERATION_DESERT_NOISE_RESOLUTION &&
+              CHUNK_GENERATION_DESERT_NOISE_RESOLUTION <= CHUNK_SIZE);
 
 STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS);
 static_assert(0 <= CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS &&
@@ -166,6 +225,9 @@ static_assert(CHUNK_GENERATION_SURFACE_LAYER_MAX_THICKNESS < CHUNK_HEIGHT);
 static_assert(0.0f < CHUNK_GENERATION_SURFACE_LAYER_NOISE_FREQUENCY);
 STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_SURFACE_LAYER_NOISE_DEPTH);
 static_assert(0 < CHUNK_GENERATION_SURFACE_LAYER_NOISE_DEPTH);
+STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_SURFACE_LAYER_NOISE_RESOLUTION);
+static_assert(0 < CHUNK_GENERATION_SURFACE_LAYER_NOISE_RESOLUTION &&
+              CHUNK_GENERATION_SURFACE_LAYER_NOISE_RESOLUTION <= CHUNK_SIZE);
 
 STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_MIN_SNOW_HEIGHT);
 static_assert(0 <= CHUNK_GENERATION_MIN_SNOW_HEIGHT &&
@@ -175,20 +237,54 @@ static_assert(0 <= CHUNK_GENERATION_MIN_SNOW_HEIGHT_VARIATION);
 static_assert(0.0f < CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_FREQUENCY);
 STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_DEPTH);
 static_assert(0 < CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_DEPTH);
+STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_RESOLUTION);
+static_assert(0 < CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_RESOLUTION &&
+              CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_RESOLUTION <= CHUNK_SIZE);
+#ifndef __wasm__
+STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_THREADS_NUMBER);
+static_assert(0 < CHUNK_GENERATION_THREADS_NUMBER);
+STATIC_ASSERT_IS_INTEGER(CHUNK_MESHING_THREADS_NUMBER);
+static_assert(0 < CHUNK_MESHING_THREADS_NUMBER);
+#else
+STATIC_ASSERT_IS_INTEGER(CHUNK_GENERATION_CHUNKS_PER_FRAME);
+static_assert(0 < CHUNK_GENERATION_CHUNKS_PER_FRAME);
+STATIC_ASSERT_IS_INTEGER(CHUNK_MESHING_CHUNKS_PER_FRAME);
+static_assert(0 < CHUNK_MESHING_CHUNKS_PER_FRAME);
+#endif
+#ifndef __wasm__
+STATIC_ASSERT_IS_INTEGER(CHUNK_STORAGE_REGION_SIZE);
+static_assert(0 < CHUNK_STORAGE_REGION_SIZE);
+#endif
 
-STATIC_ASSERT_IS_INTEGER(WORLD_SIZE);
-static_assert(0 < WORLD_SIZE);
+STATIC_ASSERT_IS_INTEGER(WORLD_BORDER);
+static_assert(0 < WORLD_BORDER && WORLD_BORDER <= (1 << 24),
+              "WORLD_BORDER must be between 0 and 2^24");
 STATIC_ASSERT_IS_INTEGER(WORLD_LOAD_DISTANCE);
 STATIC_ASSERT_IS_INTEGER(WORLD_RENDER_DISTANCE);
-static_assert(WORLD_LOAD_DISTANCE * 2 + 1 <= WORLD_SIZE);
 static_assert(WORLD_LOAD_DISTANCE >= WORLD_RENDER_DISTANCE + 1);
 static_assert(0 < WORLD_RENDER_DISTANCE);
 STATIC_ASSERT_IS_INTEGER(WORLD_RENDER_THREADS_NUMBER);
 static_assert(0 < WORLD_RENDER_THREADS_NUMBER);
+STATIC_ASSERT_IS_INTEGER(WORLD_VIEWS_NUMBER);
+static_assert(0 < WORLD_VIEWS_NUMBER);
+STATIC_ASSERT_IS_INTEGER(WORLD_CHUNK_MAP_DEFAULT_CAPACITY);
+static_assert(0 < WORLD_CHUNK_MAP_DEFAULT_CAPACITY &&
+                  (WORLD_CHUNK_MAP_DEFAULT_CAPACITY &
+                   (WORLD_CHUNK_MAP_DEFAULT_CAPACITY - 1)) == 0,
+              "WORLD_CHUNK_MAP_DEFAULT_CAPACITY must be a power of 2");
+STATIC_ASSERT_IS_INTEGER(WORLD_CHUNK_POOL_CAPACITY);
+static_assert(0 < WORLD_CHUNK_POOL_CAPACITY);
 #if defined(WORLD_RENDER_SCHEDULER_DYNAMIC) && defined(__wasm__)
 #warm "WORLD_RENDER_SCHEDULER_DYNAMIC has no effect in wasm version"
 #endif
 
+#ifndef __wasm__
+STATIC_ASSERT_IS_INTEGER(JOBS_THREADS_NUMBER);
+static_assert(0 <= JOBS_THREADS_NUMBER);
+STATIC_ASSERT_IS_INTEGER(JOBS_QUEUE_CAPACITY);
+static_assert(0 < JOBS_QUEUE_CAPACITY);
+#endif
+
 static_assert(0 < CAMERA_FOV && CAMERA_FOV < RAD(180.0f /* deg */));
 static_assert(0.0f < CAMERA_Z_NEAR);
 static_assert(CAMERA_Z_NEAR < CAMERA_Z_FAR);
@@ -239,9 +335,34 @@ STATIC_ASSERT_IS_COLOR(MESH_OUTLINE_COLOR);
 static_assert(0.0f <= MESH_OUTLINE_Z_CORRECTION);
 static_assert(0.0f <= MESH_OUTLINE_MAX_DISTANCE);
 static_assert(MESH_OUTLINE_MAX_DISTANCE <= MESH_FAR_OUTLINE_MAX_DISTANCE);
+// The greedy meshes have no outlines inside of the merged faces.
+static_assert(MESH_FAR_OUTLINE_MAX_DISTANCE <= MESH_GREEDY_MIN_DISTANCE);
+STATIC_ASSERT_IS_INTEGER(MESH_LOD_LEVELS_NUMBER);
+static_assert(0 < MESH_LOD_LEVELS_NUMBER && MESH_LOD_LEVELS_NUMBER <= 6);
+static_assert(CHUNK_SIZE % (2 << (MESH_LOD_LEVELS_NUMBER - 1)) == 0,
+              "the cells of the levels of detail must divide the chunks");
+static_assert(MESH_GREEDY_MIN_DISTANCE <= MESH_LOD_MIN_DISTANCE);
 static_assert(0.0f < MESH_SHADOW_DISTANCE);
 STATIC_ASSERT_IS_COLOR(MESH_SHADOW_COLOR);
 
+STATIC_ASSERT_IS_INTEGER(RENDER_TILE_WIDTH);
+static_assert(0 < RENDER_TILE_WIDTH);
+STATIC_ASSERT_IS_INTEGER(RENDER_TILE_HEIGHT);
+static_assert(0 < RENDER_TILE_HEIGHT);
+STATIC_ASSERT_IS_INTEGER(RENDER_TILE_BIN_DEFAULT_CAPACITY);
+static_assert(0 < RENDER_TILE_BIN_DEFAULT_CAPACITY);
+STATIC_ASSERT_IS_INTEGER(RENDER_TILE_BIN_GROUPS_DEFAULT_CAPACITY);
+static_assert(0 < RENDER_TILE_BIN_GROUPS_DEFAULT_CAPACITY);
+STATIC_ASSERT_IS_INTEGER(RENDER_ARENA_DEFAULT_CAPACITY);
+static_assert(0 < RENDER_ARENA_DEFAULT_CAPACITY);
+STATIC_ASSERT_IS_INTEGER(RENDER_HI_Z_BLOCK_SIZE);
+static_assert(0 < RENDER_HI_Z_BLOCK_SIZE);
+static_assert(RENDER_TILE_WIDTH % RENDER_HI_Z_BLOCK_SIZE == 0);
+static_assert(RENDER_TILE_HEIGHT % RENDER_HI_Z_BLOCK_SIZE == 0);
+static_assert((RENDER_TILE_WIDTH / RENDER_HI_Z_BLOCK_SIZE) *
+                  (RENDER_TILE_HEIGHT / RENDER_HI_Z_BLOCK_SIZE) <=
+              64);
+
 STATIC_ASSERT_IS_INTEGER(GAMEPAD_ARRAY_DEFAULT_CAPACITY);
 static_assert(0 < GAMEPAD_ARRAY_DEFAULT_CAPACITY);
 static_assert(0.0f <= GAMEPAD_AXIS_ROUND);
@@ -0,0 +1,100 @@
+#include "frame_arena.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utils.h"
+
+[[gnu::returns_nonnull]]
+static FrameArenaBlock *frame_arena_block_create(
+    FrameArenaBlock *const previous, const size_t capacity) {
+    assert(capacity > 0);
+
+    FrameArenaBlock *const self =
+        malloc_or_exit(sizeof(*self) + capacity,
+                       "failed to create a frame arena block");
+    self->previous = previous;
+    self->capacity = capacity;
+    return self;
+}
+
+static void frame_arena_free_blocks(FrameArena *const self) {
+    assert(self != NULL);
+
+    FrameArenaBlock *block = self->block;
+    while (block != NULL) {
+        FrameArenaBlock *const previous = block->previous;
+        free(block);
+        block = previous;
+    }
+    self->block = NULL;
+}
+
+void frame_arena_init(FrameArena *const self, const size_t default_capacity) {
+    assert(self != NULL);
+    assert(default_capacity > 0);
+
+    self->block = NULL;
+    self->block_length = 0;
+    self->default_capacity = FRAME_ARENA_ALIGN(default_capacity);
+    self->size = 0;
+    self->peak_size = 0;
+}
+
+void frame_arena_destroy(FrameArena *const self) {
+    assert(self != NULL);
+    frame_arena_free_blocks(self);
+}
+
+void frame_arena_reset(FrameArena *const self) {
+    assert(self != NULL);
+
+    if (self->size > self->peak_size) self->peak_size = self->size;
+    if (self->block != NULL && self->block->previous != NULL) {
+        frame_arena_free_blocks(self);
+        self->block = frame_arena_block_create(NULL, self->peak_size);
+    }
+    self->block_length = 0;
+    self->size = 0;
+}
+
+void *frame_arena_alloc_in_new_block(FrameArena *const self,
+                                     const size_t size) {
+    assert(self != NULL);
+    assert(size % FRAME_ARENA_ALIGNMENT == 0);
+
+    // The blocks double, so that a frame needs few of them.
+    size_t capacity = self->default_capacity;
+    if (self->block != NULL && self->block->capacity * 2 > capacity) {
+        capacity = self->block->capacity * 2;
+    }
+    if (size > capacity) capacity = size;
+    self->block = frame_arena_block_create(self->block, capacity);
+    self->block_length = size;
+    self->size += size;
+    return self->block->data;
+}
+
+void *frame_arena_resize(FrameArena *const restrict self,
+                         void *const restrict pointer, const size_t size,
+                         const size_t new_size) {
+    assert(self != NULL);
+    assert(pointer != NULL);
+
+    const size_t aligned_size = FRAME_ARENA_ALIGN(size);
+    const size_t aligned_new_size = FRAME_ARENA_ALIGN(new_size);
+    if (self->block != NULL &&
+        (unsigned char *)pointer + aligned_size ==
+            &self->block->data[self->block_length] &&
+        self->block_length - aligned_size + aligned_new_size <=
+            self->block->capacity) {
+        self->block_length += aligned_new_size - aligned_size;
+        self->size += aligned_new_size - aligned_size;
+        return pointer;
+    }
+
+    void *const new_pointer = frame_arena_alloc(self, new_size);
+    memcpy(new_pointer, pointer, size < new_size ? size : new_size);
+    return new_pointer;
+}
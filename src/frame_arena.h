@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "frame_arena_defs.h"
+
+#define FRAME_ARENA_ALIGNMENT alignof(max_align_t)
+// The size taken in the arena by an allocation.
+#define FRAME_ARENA_ALIGN(size) \
+    (((size) + FRAME_ARENA_ALIGNMENT - 1) & ~(FRAME_ARENA_ALIGNMENT - 1))
+
+// The first block is allocated on the first allocation.
+[[gnu::nonnull]]
+void frame_arena_init(FrameArena *const self, const size_t default_capacity);
+
+[[gnu::nonnull]]
+void frame_arena_destroy(FrameArena *const self);
+
+// Free all the allocations. When they needed several blocks, those are replaced
+// by a single one of the peak size, so that the arena grows to its high-water
+// mark and stops allocating.
+[[gnu::nonnull]]
+void frame_arena_reset(FrameArena *const self);
+
+// Allocate from a new block, when the current one is full.
+[[gnu::nonnull]] [[gnu::returns_nonnull]]
+void *frame_arena_alloc_in_new_block(FrameArena *const self, const size_t size);
+
+[[gnu::nonnull]] [[gnu::returns_nonnull]]
+static inline void *frame_arena_alloc(FrameArena *const self, size_t size) {
+    size = FRAME_ARENA_ALIGN(size);
+    if (self->block == NULL ||
+        self->block->capacity - self->block_length < size) {
+        return frame_arena_alloc_in_new_block(self, size);
+    }
+    void *const pointer = &self->block->data[self->block_length];
+    self->block_length += size;
+    self->size += size;
+    return pointer;
+}
+
+// Resize an allocation, in place when it is the last one of the arena,
+// otherwise its content is moved to a new allocation.
+[[gnu::nonnull]] [[gnu::returns_nonnull]]
+void *frame_arena_resize(FrameArena *const restrict self,
+                         void *const restrict pointer, const size_t size,
+                         const size_t new_size);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stddef.h>
+
+typedef struct FrameArenaBlock {
+    struct FrameArenaBlock *previous;
+    size_t capacity;
+    alignas(max_align_t) unsigned char data[];
+} FrameArenaBlock;
+
+// Bump allocator for the memory of a frame, freed all at once by a reset.
+typedef struct {
+    // The block allocated from, linked to the ones filled before it.
+    FrameArenaBlock *block;
+    size_t block_length;
+    size_t default_capacity;
+    // Bytes allocated since the last reset, and the most allocated between two
+    // resets.
+    size_t size;
+    size_t peak_size;
+} FrameArena;
@@ -6,7 +6,6 @@
 #endif
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 
 #include "camera.h"
 #include "command.h"
@@ -15,6 +14,7 @@
 #include "gamepad_array.h"
 #include "log.h"
 #include "player.h"
+#include "threads.h"
 #include "vec.h"
 #include "wasm/mouse_and_keyboard.h"
 #include "window.h"
@@ -42,6 +42,8 @@ typedef struct {
     bool command_mode;
 } Game;
 
+static_assert(WORLD_VIEWS_NUMBER >= 4, "the world needs a view per player");
+
 static Game game;
 
 void game_init(const uint8_t number_players, const uint32_t world_seed,
@@ -52,6 +54,9 @@ void game_init(const uint8_t number_players, const uint32_t world_seed,
     game.show_debug_info = GAME_DEFAULT_SHOW_DEBUG_INFO;
     game.command_mode = false;
 
+#ifndef __wasm__
+    jobs_init();
+#endif
     game.world = world_create(world_seed);
 
     window_init(force_tty, force_no_tty);
@@ -78,6 +83,9 @@ void game_quit(void) {
     mouse_and_keyboard_quit();
     event_queue_quit();
     world_destroy(game.world);
+#ifndef __wasm__
+    jobs_quit();
+#endif
     window_quit();
     log_debugf("quit");
 }
@@ -554,6 +562,8 @@ static inline void game_update(const float delta_time_seconds) {
     }
 #endif
 
+    world_update(game.world);
+
     for (uint8_t i = 0; i < game.number_players; ++i) {
         player_update(&game.players[i], game.world, delta_time_seconds);
     }
@@ -593,6 +603,69 @@ static inline void game_render_debug_info(const float delta_time_seconds) {
     snprintf(buffer, sizeof(buffer), "| total: %8.2f ms |", game.total_time);
     window_render_string(position, buffer, COLOR_WHITE, WINDOW_Z_BUFFER_FRONT);
     ++position.y;
+    const ChunkPool *const chunk_pool = &game.world->chunk_pool;
+    const size_t chunk_pool_requests = chunk_pool->hits + chunk_pool->misses;
+    snprintf(buffer, sizeof(buffer), "| pool hits: %6.1f%% |",
+             chunk_pool_requests == 0
+                 ? 0.0f
+                 : 100.0f * chunk_pool->hits / chunk_pool_requests);
+    window_render_string(position, buffer, COLOR_WHITE, WINDOW_Z_BUFFER_FRONT);
+    ++position.y;
+    // The statistics of the views of the players are added up.
+    uint32_t occluded_chunks_number = 0;
+    uint32_t occluded_triangles_number = 0;
+    uint32_t render_arenas_peak_size = 0;
+    for (uint8_t i = 0; i < game.number_players; ++i) {
+        const WorldView *const view = &game.world->views[i];
+        occluded_chunks_number += atomic_load_explicit(
+            &view->occluded_chunks_number, memory_order_relaxed);
+        occluded_triangles_number += atomic_load_explicit(
+            &view->occluded_triangles_number, memory_order_relaxed);
+        render_arenas_peak_size += atomic_load_explicit(
+            &view->render_arenas_peak_size, memory_order_relaxed);
+    }
+    snprintf(buffer, sizeof(buffer), "| occl. chunks: %4u |",
+             occluded_chunks_number);
+    window_render_string(position, buffer, COLOR_WHITE, WINDOW_Z_BUFFER_FRONT);
+    ++position.y;
+    snprintf(buffer, sizeof(buffer), "| occl. tris: %6u |",
+             occluded_triangles_number);
+    window_render_string(position, buffer, COLOR_WHITE, WINDOW_Z_BUFFER_FRONT);
+    ++position.y;
+    snprintf(buffer, sizeof(buffer), "| arenas: %6u KiB |",
+             render_arenas_peak_size);
+    window_render_string(position, buffer, COLOR_WHITE, WINDOW_Z_BUFFER_FRONT);
+    ++position.y;
+#ifndef __wasm__
+    // Usage of the render threads averaged over the views, then one digit per
+    // thread from 0 to 9.
+    char usages[WORLD_RENDER_THREADS_NUMBER];
+    uint32_t total_usage = 0;
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        uint32_t usage = 0;
+        for (uint8_t j = 0; j < game.number_players; ++j) {
+            usage += atomic_load_explicit(
+                &game.world->views[j].render_thread_usages[i],
+                memory_order_relaxed);
+        }
+        usage /= game.number_players;
+        total_usage += usage;
+        usages[i] = '0' + min_int(usage / 100, 9);
+    }
+    snprintf(buffer, sizeof(buffer), "| threads: %8.1f%% |",
+             total_usage / (10.0f * WORLD_RENDER_THREADS_NUMBER));
+    window_render_string(position, buffer, COLOR_WHITE, WINDOW_Z_BUFFER_FRONT);
+    ++position.y;
+    const int digits_per_line = sizeof(buffer) - 5;
+    for (int i = 0; i < WORLD_RENDER_THREADS_NUMBER; i += digits_per_line) {
+        snprintf(buffer, sizeof(buffer), "| %-*.*s |", digits_per_line,
+                 min_int(WORLD_RENDER_THREADS_NUMBER - i, digits_per_line),
+                 usages + i);
+        window_render_string(position, buffer, COLOR_WHITE,
+                             WINDOW_Z_BUFFER_FRONT);
+        ++position.y;
+    }
+#endif
     window_render_string(position, "+--------------------+", COLOR_WHITE,
                          WINDOW_Z_BUFFER_FRONT);
 }
@@ -642,7 +715,7 @@ static inline void game_render_player_screens_borders(void) {
             }
         }
 
-        window.pixels[half_height_index + half_width].chr = '+';
+        window.chars[half_height_index + half_width] = '+';
     }
 }
 
@@ -661,7 +734,7 @@ static inline void game_render_ui(const float delta_time_seconds) {
 }
 
 [[gnu::nonnull]]
-static void *game_player_render_thread(void *const data) {
+static void game_render_player(void *const data) {
     assert(data != NULL);
     Player *const player = data;
     Camera *const camera = &player->camera;
@@ -672,39 +745,22 @@ static void *game_player_render_thread(void *const data) {
         if (player->player_index == j) continue;
         player_render(&game.players[j], camera, viewport);
     }
-    world_render(game.world, camera, viewport);
-    return NULL;
+    world_render(game.world, player->player_index, camera, viewport);
 }
 
 #ifndef __wasm__
 static inline void game_render_multiplayer(void) {
-    pthread_t render_threads[game.number_players - 1];
-    for (int8_t i = 1; i < game.number_players; ++i) {
-        const int return_code =
-            pthread_create(&render_threads[i - 1], NULL,
-                           game_player_render_thread, &game.players[i]);
-        if (return_code < 0) {
-            log_errorf("failed to create render thread: %s",
-                       strerror(-return_code));
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    game_player_render_thread(&game.players[0]);
-
-    for (int8_t i = 1; i < game.number_players; ++i) {
-        const int return_code = pthread_join(render_threads[i - 1], NULL);
-        if (return_code < 0) {
-            log_errorf("failed to join render thread: %s",
-                       strerror(-return_code));
-            exit(EXIT_FAILURE);
-        }
+    JobGroup group = {.pending = 0};
+    for (uint8_t i = 1; i < game.number_players; ++i) {
+        jobs_fork(&group, game_render_player, &game.players[i]);
     }
+    game_render_player(&game.players[0]);
+    jobs_join(&group);
 }
 #else
 static inline void game_render_multiplayer(void) {
     for (int8_t i = 0; i < game.number_players; ++i) {
-        game_player_render_thread(&game.players[i]);
+        game_render_player(&game.players[i]);
     }
 }
 #endif
@@ -719,7 +775,7 @@ static inline void game_render(const float delta_time_seconds) {
     if (game.number_players > 1) {
         game_render_multiplayer();
     } else {
-        game_player_render_thread(&game.players[0]);
+        game_render_player(&game.players[0]);
     }
 
     window_flush();
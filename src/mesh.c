@@ -7,10 +7,13 @@
 #include "array.h"
 #include "camera.h"
 #include "config.h"
+#include "frame_arena.h"
+#include "render_tiles.h"
 #include "triangle3D_array.h"
 #include "triangle_index_array.h"
 #include "v3f_array.h"
 #include "vec.h"
+#include "vertex_transform.h"
 #include "window.h"
 
 void mesh_init(Mesh *const self, const size_t preallocate_vertices_size,
@@ -33,19 +36,31 @@ void mesh_clear(Mesh *const self) {
 }
 
 [[gnu::nonnull]]
-static inline void mesh_get_viewed_vertices(const Mesh *const restrict self,
-                                            const Camera *const restrict camera,
-                                            v4f *const restrict view_vertices) {
+static inline void mesh_get_viewed_vertices(
+    const Mesh *const restrict self, const Camera *const restrict camera,
+    const Viewport *const restrict viewport, v4f *const restrict view_vertices,
+    v4f *const restrict screen_vertices, FrameArena *const restrict arena) {
     assert(self != NULL);
     assert(camera != NULL);
+    assert(viewport != NULL);
     assert(view_vertices != NULL);
+    assert(screen_vertices != NULL);
+    assert(arena != NULL);
 
     m4f view_matrix;
     camera_get_view_matrix(camera, view_matrix);
 
-    for (size_t i = 0; i < self->vertices.length; ++i) {
-        view_vertices[i] = mul_m4f_v3f(view_matrix, self->vertices.array[i]);
+    const size_t length = self->vertices.length;
+    float *const xs = frame_arena_alloc(arena, sizeof(*xs) * length);
+    float *const ys = frame_arena_alloc(arena, sizeof(*ys) * length);
+    float *const zs = frame_arena_alloc(arena, sizeof(*zs) * length);
+    for (size_t i = 0; i < length; ++i) {
+        xs[i] = self->vertices.array[i].x;
+        ys[i] = self->vertices.array[i].y;
+        zs[i] = self->vertices.array[i].z;
     }
+    vertex_transform_soa(xs, ys, zs, length, view_matrix, camera, viewport,
+                         view_vertices, screen_vertices);
 }
 
 [[gnu::nonnull(1)]]
@@ -68,20 +83,22 @@ static float get_interpolation(const v3f v1, const v3f v2, const v3f v3) {
     return v3f_dot(v3f_sub(v2, v1), v3_sub_v1) / v3f_norm_squared(v3_sub_v1);
 }
 
-[[gnu::nonnull(1, 3, 4, 5)]]
+// Only the planes in plane_mask are clipped against.
+[[gnu::nonnull(1, 4, 5, 6)]]
 static void planes_clip_triangle(const Plane planes[6],
-                                 const uint8_t plane_index,
+                                 const uint8_t plane_mask, uint8_t plane_index,
                                  Triangle3D *const restrict triangle,
                                  Triangle3DArray *const restrict array,
-                                 Triangle3DArena *const restrict arena) {
+                                 FrameArena *const restrict arena) {
     assert(planes != NULL);
     assert(plane_index <= 6);
     assert(triangle != NULL);
     assert(array != NULL);
     assert(arena != NULL);
 
+    while (plane_index < 6 && !(plane_mask >> plane_index & 1)) ++plane_index;
     if (plane_index == 6) {
-        triangle3D_array_push(array, triangle);
+        triangle3D_array_push_in_arena(array, triangle, arena);
         return;
     }
 
@@ -94,14 +111,19 @@ static void planes_clip_triangle(const Plane planes[6],
     const bool v3_in =
         v3f_dot(plane->normal, triangle->v3.xyz) >= plane->distance;
 
+    if (v1_in && v2_in && v3_in) {
+        planes_clip_triangle(planes, plane_mask, plane_index + 1, triangle,
+                             array, arena);
+        return;
+    }
+
+    // The vertices of the clipped triangles are projected when they are drawn.
+    triangle->screen_v1 = NULL;
+    triangle->screen_v2 = NULL;
+    triangle->screen_v3 = NULL;
+
     if (v1_in) {
         if (v2_in) {
-            if (v3_in) {
-                planes_clip_triangle(planes, plane_index + 1, triangle, array,
-                                     arena);
-                return;
-            }
-
             const v4f intersect_v2_v3 =
                 plane_intersect(plane, triangle->v2, triangle->v3);
             const v4f intersect_v1_v3 =
@@ -117,7 +139,7 @@ static void planes_clip_triangle(const Plane planes[6],
                                   triangle->v3.xyz));
 
             planes_clip_triangle(
-                planes, plane_index + 1,
+                planes, plane_mask, plane_index + 1,
                 triangle3D_init_v4f(
                     &triangle->v1, &triangle->v2, &intersect_v2_v3,
                     triangle->uv1, triangle->uv2, uv_v2_v3,
@@ -132,8 +154,8 @@ static void planes_clip_triangle(const Plane planes[6],
             triangle->uv2 = uv_v2_v3;
             triangle->uv3 = uv_v1_v3;
             triangle->edges &= TRIANGLE_EDGE_V3_V1 | TRIANGLE_EDGE_V3_V1_FAR;
-            planes_clip_triangle(planes, plane_index + 1, triangle, array,
-                                 arena);
+            planes_clip_triangle(planes, plane_mask, plane_index + 1,
+                                 triangle, array, arena);
             return;
         }
 
@@ -153,7 +175,7 @@ static void planes_clip_triangle(const Plane planes[6],
                                   triangle->v3.xyz));
 
             planes_clip_triangle(
-                planes, plane_index + 1,
+                planes, plane_mask, plane_index + 1,
                 triangle3D_init_v4f(
                     &triangle->v1, &intersect_v1_v2, &triangle->v3,
                     triangle->uv1, uv_v1_v2, triangle->uv3,
@@ -168,8 +190,8 @@ static void planes_clip_triangle(const Plane planes[6],
             triangle->uv1 = uv_v1_v2;
             triangle->uv2 = uv_v2_v3;
             triangle->edges &= TRIANGLE_EDGE_V2_V3 | TRIANGLE_EDGE_V2_V3_FAR;
-            planes_clip_triangle(planes, plane_index + 1, triangle, array,
-                                 arena);
+            planes_clip_triangle(planes, plane_mask, plane_index + 1,
+                                 triangle, array, arena);
             return;
         }
 
@@ -193,7 +215,8 @@ static void planes_clip_triangle(const Plane planes[6],
         triangle->uv3 = uv_v1_v3;
         triangle->edges &= (TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V3_V1 |
                             TRIANGLE_EDGE_V1_V2_FAR | TRIANGLE_EDGE_V3_V1_FAR);
-        planes_clip_triangle(planes, plane_index + 1, triangle, array, arena);
+        planes_clip_triangle(planes, plane_mask, plane_index + 1, triangle,
+                             array, arena);
         return;
     }
 
@@ -214,7 +237,7 @@ static void planes_clip_triangle(const Plane planes[6],
                                   triangle->v3.xyz));
 
             planes_clip_triangle(
-                planes, plane_index + 1,
+                planes, plane_mask, plane_index + 1,
                 triangle3D_init_v4f(
                     &intersect_v1_v2, &triangle->v2, &triangle->v3, uv_v1_v2,
                     triangle->uv2, triangle->uv3,
@@ -229,8 +252,8 @@ static void planes_clip_triangle(const Plane planes[6],
             triangle->uv1 = uv_v1_v3;
             triangle->uv2 = uv_v1_v2;
             triangle->edges &= TRIANGLE_EDGE_V3_V1 | TRIANGLE_EDGE_V3_V1_FAR;
-            planes_clip_triangle(planes, plane_index + 1, triangle, array,
-                                 arena);
+            planes_clip_triangle(planes, plane_mask, plane_index + 1,
+                                 triangle, array, arena);
             return;
         }
         const v4f intersect_v1_v2 =
@@ -253,7 +276,8 @@ static void planes_clip_triangle(const Plane planes[6],
         triangle->uv3 = uv_v2_v3;
         triangle->edges &= (TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3 |
                             TRIANGLE_EDGE_V1_V2_FAR | TRIANGLE_EDGE_V2_V3_FAR);
-        planes_clip_triangle(planes, plane_index + 1, triangle, array, arena);
+        planes_clip_triangle(planes, plane_mask, plane_index + 1, triangle,
+                             array, arena);
         return;
     }
 
@@ -278,38 +302,66 @@ static void planes_clip_triangle(const Plane planes[6],
         triangle->uv2 = uv_v2_v3;
         triangle->edges &= (TRIANGLE_EDGE_V2_V3 | TRIANGLE_EDGE_V3_V1 |
                             TRIANGLE_EDGE_V2_V3_FAR | TRIANGLE_EDGE_V3_V1_FAR);
-        planes_clip_triangle(planes, plane_index + 1, triangle, array, arena);
+        planes_clip_triangle(planes, plane_mask, plane_index + 1, triangle,
+                             array, arena);
         return;
     }
 }
 
 [[gnu::nonnull]]
 static inline void clip_triangle(const Camera *const restrict camera,
+                                 const uint8_t plane_mask,
                                  Triangle3D *const restrict triangle,
                                  Triangle3DArray *const restrict array,
-                                 Triangle3DArena *const restrict arena) {
+                                 FrameArena *const restrict arena) {
     assert(camera != NULL);
     assert(triangle != NULL);
     assert(array != NULL);
     assert(arena != NULL);
-    planes_clip_triangle(camera->frustum_planes_in_camera_space.planes, 0,
-                         triangle, array, arena);
+    if (plane_mask == 0) {
+        triangle3D_array_push_in_arena(array, triangle, arena);
+        return;
+    }
+    planes_clip_triangle(camera->frustum_planes_in_camera_space.planes,
+                         plane_mask, 0, triangle, array, arena);
+}
+
+void mesh_view_triangle(Triangle3D *const restrict triangle,
+                        const Camera *const restrict camera,
+                        const uint8_t plane_mask,
+                        Triangle3DArray *const restrict viewed_triangles,
+                        FrameArena *const restrict arena) {
+    assert(triangle != NULL);
+    assert(camera != NULL);
+    assert(viewed_triangles != NULL);
+    assert(arena != NULL);
+
+    const v3f triangle_normal = triangle3D_get_normal(triangle);
+    if (v3f_dot(triangle->v1.xyz, triangle_normal) < 0.0f) {
+        clip_triangle(camera, plane_mask, triangle, viewed_triangles, arena);
+    }
 }
 
+// The triangles keep pointers to screen_vertices until they are drawn.
 [[gnu::nonnull]]
 static inline void mesh_get_viewed_triangles(
     const Mesh *const restrict self, const Camera *const restrict camera,
-    Triangle3DArena *const restrict arena,
+    const Viewport *const restrict viewport, v4f *const restrict view_vertices,
+    v4f *const restrict screen_vertices, FrameArena *const restrict arena,
     Triangle3DArray *const restrict viewed_triangles) {
     assert(self != NULL);
     assert(camera != NULL);
+    assert(viewport != NULL);
+    assert(view_vertices != NULL);
+    assert(screen_vertices != NULL);
     assert(arena != NULL);
     assert(viewed_triangles != NULL);
 
-    triangle3D_array_init(viewed_triangles, self->triangles.length);
+    triangle3D_array_init_in_arena(viewed_triangles, self->triangles.length,
+                                   arena);
 
-    v4f view_vertices[self->vertices.length];
-    mesh_get_viewed_vertices(self, camera, view_vertices);
+    mesh_get_viewed_vertices(self, camera, viewport, view_vertices,
+                             screen_vertices, arena);
 
     for (size_t i = 0; i < self->triangles.length; ++i) {
         const TriangleIndex *const triangle_index = &self->triangles.array[i];
@@ -319,88 +371,153 @@ static inline void mesh_get_viewed_triangles(
             &view_vertices[triangle_index->v3], triangle_index->uv1,
             triangle_index->uv2, triangle_index->uv3, triangle_index->edges,
             triangle_index->texture, triangle_index->color, arena);
-        const v3f triangle_normal = triangle3D_get_normal(triangle);
-        if (v3f_dot(triangle->v1.xyz, triangle_normal) < 0.0f) {
-            clip_triangle(camera, triangle, viewed_triangles, arena);
-        }
+        triangle->screen_v1 = &screen_vertices[triangle_index->v1];
+        triangle->screen_v2 = &screen_vertices[triangle_index->v2];
+        triangle->screen_v3 = &screen_vertices[triangle_index->v3];
+        mesh_view_triangle(triangle, camera, CAMERA_FRUSTUM_PLANE_MASK_ALL,
+                           viewed_triangles, arena);
     }
 }
 
-void mesh_render(const Mesh *const restrict self,
-                 const Camera *const restrict camera,
-                 const Viewport *const restrict viewport) {
-    assert(self != NULL);
+[[gnu::nonnull]]
+static inline v3f mesh_get_light(const Camera *const camera) {
+    assert(camera != NULL);
+
+    m4f camera_rotation_matrix;
+    camera_get_rotation_matrix(camera, camera_rotation_matrix);
+    return mul_m4f_v3f(camera_rotation_matrix,
+                       v3f_normalize((v3f){3.0f, 2.0f, -1.0f}))
+        .xyz;
+}
+
+// The projection of the vertex, cached in screen_vertex unless it is NULL.
+[[gnu::nonnull(3, 4)]]
+static inline v4f mesh_project_vertex(const v4f *const restrict screen_vertex,
+                                      const v4f vertex,
+                                      const Camera *const restrict camera,
+                                      const Viewport *const restrict viewport) {
     assert(camera != NULL);
     assert(viewport != NULL);
 
-    static const char shade_char[] = {'.', ';', '!'};
+    if (screen_vertex != NULL) return *screen_vertex;
+    return vertex_transform_project(vertex.xyz, camera, viewport);
+}
 
-    Triangle3DArena *const arena =
-        triangle3D_arena_create(2 * self->triangles.length);
+// Shade the triangle and project it into the viewport.
+[[gnu::nonnull]]
+static inline void
+mesh_project_triangle(Triangle3D *const restrict triangle,
+                      const Camera *const restrict camera,
+                      const Viewport *const restrict viewport,
+                      const v3f light) {
+    assert(triangle != NULL);
+    assert(camera != NULL);
+    assert(viewport != NULL);
 
-    Triangle3DArray viewed_triangles;
-    mesh_get_viewed_triangles(self, camera, arena, &viewed_triangles);
+    static const char shade_char[] = {'.', ';', '!'};
 
-    m4f camera_rotation_matrix;
-    camera_get_rotation_matrix(camera, camera_rotation_matrix);
-    const v4f light = mul_m4f_v3f(camera_rotation_matrix,
-                                  v3f_normalize((v3f){3.0f, 2.0f, -1.0f}));
-
-    for (size_t j = 0; j < viewed_triangles.length; ++j) {
-        Triangle3D *triangle = viewed_triangles.array[j];
-        const float triangle_distance_squared =
-            min3_float(v3f_norm_squared(triangle->v1.xyz),
-                       v3f_norm_squared(triangle->v2.xyz),
-                       v3f_norm_squared(triangle->v3.xyz));
-
-        if (triangle_distance_squared >
-            MESH_SHADOW_DISTANCE * MESH_SHADOW_DISTANCE) {
-            triangle->texture = NULL;
-            triangle->color = MESH_SHADOW_COLOR;
-            triangle->shade = shade_char[0];
-        } else {
-            // lighting
-            const uint8_t shade_index =
-                sizeof(shade_char) *
-                clamp_float(
-                    v3f_dot(light.xyz,
-                            v3f_normalize(triangle3D_get_normal(triangle))),
-                    0.0f, 0.999f);
-            triangle->shade = shade_char[shade_index];
-        }
+    const float triangle_distance_squared =
+        min3_float(v3f_norm_squared(triangle->v1.xyz),
+                   v3f_norm_squared(triangle->v2.xyz),
+                   v3f_norm_squared(triangle->v3.xyz));
+
+    if (triangle_distance_squared >
+        MESH_SHADOW_DISTANCE * MESH_SHADOW_DISTANCE) {
+        triangle->texture = NULL;
+        triangle->color = MESH_SHADOW_COLOR;
+        triangle->shade = shade_char[0];
+    } else {
+        // lighting
+        const uint8_t shade_index =
+            sizeof(shade_char) *
+            clamp_float(
+                v3f_dot(light, v3f_normalize(triangle3D_get_normal(triangle))),
+                0.0f, 0.999f);
+        triangle->shade = shade_char[shade_index];
+    }
 
+    if (triangle_distance_squared >=
+        MESH_OUTLINE_MAX_DISTANCE * MESH_OUTLINE_MAX_DISTANCE) {
         if (triangle_distance_squared >=
-            MESH_OUTLINE_MAX_DISTANCE * MESH_OUTLINE_MAX_DISTANCE) {
-            if (triangle_distance_squared >=
-                MESH_FAR_OUTLINE_MAX_DISTANCE * MESH_FAR_OUTLINE_MAX_DISTANCE) {
-                triangle->edges = 0;
-            } else {
-                triangle->edges &= TRIANGLE_EDGE_V1_V2_FAR |
-                                   TRIANGLE_EDGE_V2_V3_FAR |
-                                   TRIANGLE_EDGE_V3_V1_FAR;
-            }
+            MESH_FAR_OUTLINE_MAX_DISTANCE * MESH_FAR_OUTLINE_MAX_DISTANCE) {
+            triangle->edges = 0;
+        } else {
+            triangle->edges &= TRIANGLE_EDGE_V1_V2_FAR |
+                               TRIANGLE_EDGE_V2_V3_FAR |
+                               TRIANGLE_EDGE_V3_V1_FAR;
         }
+    }
+
+    triangle->v1 = mesh_project_vertex(triangle->screen_v1, triangle->v1,
+                                       camera, viewport);
+    triangle->v2 = mesh_project_vertex(triangle->screen_v2, triangle->v2,
+                                       camera, viewport);
+    triangle->v3 = mesh_project_vertex(triangle->screen_v3, triangle->v3,
+                                       camera, viewport);
+}
+
+void mesh_draw_viewed_triangles(
+    const Triangle3DArray *const restrict viewed_triangles,
+    const Camera *const restrict camera,
+    const Viewport *const restrict viewport) {
+    assert(viewed_triangles != NULL);
+    assert(camera != NULL);
+    assert(viewport != NULL);
 
-        triangle->v1 = mul_m4f_v3f(camera->projection_matrix, triangle->v1.xyz);
-        triangle->v2 = mul_m4f_v3f(camera->projection_matrix, triangle->v2.xyz);
-        triangle->v3 = mul_m4f_v3f(camera->projection_matrix, triangle->v3.xyz);
-
-        triangle->v1.x = viewport->x_offset +
-                         viewport->width * (triangle->v1.x + 1.0f) / 2.0f;
-        triangle->v2.x = viewport->x_offset +
-                         viewport->width * (triangle->v2.x + 1.0f) / 2.0f;
-        triangle->v3.x = viewport->x_offset +
-                         viewport->width * (triangle->v3.x + 1.0f) / 2.0f;
-        triangle->v1.y = viewport->y_offset +
-                         viewport->height * (-triangle->v1.y + 1.0f) / 2.0f;
-        triangle->v2.y = viewport->y_offset +
-                         viewport->height * (-triangle->v2.y + 1.0f) / 2.0f;
-        triangle->v3.y = viewport->y_offset +
-                         viewport->height * (-triangle->v3.y + 1.0f) / 2.0f;
-
-        window_render_triangle(triangle);
+    const v3f light = mesh_get_light(camera);
+    const v2i min = {max_int(viewport->x_offset, 0),
+                     max_int(viewport->y_offset, 0)};
+    const v2i max = {
+        min_int(viewport->x_offset + viewport->width, window.width),
+        min_int(viewport->y_offset + viewport->height, window.height),
+    };
+    if (max.x <= min.x || max.y <= min.y) return;
+
+    for (size_t i = 0; i < viewed_triangles->length; ++i) {
+        Triangle3D *const triangle = viewed_triangles->array[i];
+        mesh_project_triangle(triangle, camera, viewport, light);
+        window_render_triangle(triangle, min, max);
     }
+}
+
+void mesh_bin_viewed_triangles(
+    const Triangle3DArray *const restrict viewed_triangles,
+    const Camera *const restrict camera, RenderTiles *const restrict tiles,
+    const size_t thread_index) {
+    assert(viewed_triangles != NULL);
+    assert(camera != NULL);
+    assert(tiles != NULL);
+
+    const v3f light = mesh_get_light(camera);
+    for (size_t i = 0; i < viewed_triangles->length; ++i) {
+        Triangle3D *const triangle = viewed_triangles->array[i];
+        mesh_project_triangle(triangle, camera, &tiles->viewport, light);
+        render_tiles_bin(tiles, thread_index, triangle);
+    }
+}
+
+void mesh_render(const Mesh *const restrict self,
+                 const Camera *const restrict camera,
+                 const Viewport *const restrict viewport) {
+    assert(self != NULL);
+    assert(camera != NULL);
+    assert(viewport != NULL);
+
+    // Enough for the triangles to be clipped in two.
+    FrameArena arena;
+    frame_arena_init(
+        &arena, self->vertices.length * (2 * sizeof(v4f) + 3 * sizeof(float)) +
+                    3 * self->triangles.length *
+                        (sizeof(Triangle3D) + sizeof(Triangle3D *)));
+
+    v4f *const view_vertices =
+        frame_arena_alloc(&arena, self->vertices.length * sizeof(v4f));
+    v4f *const screen_vertices =
+        frame_arena_alloc(&arena, self->vertices.length * sizeof(v4f));
+    Triangle3DArray viewed_triangles;
+    mesh_get_viewed_triangles(self, camera, viewport, view_vertices,
+                              screen_vertices, &arena, &viewed_triangles);
+    mesh_draw_viewed_triangles(&viewed_triangles, camera, viewport);
 
-    array_destroy((Array *)&viewed_triangles);
-    triangle3D_arena_destroy(arena);
+    frame_arena_destroy(&arena);
 }
@@ -2,6 +2,8 @@
 
 #include "camera_defs.h"
 #include "mesh_defs.h"
+#include "render_tiles_defs.h"
+#include "triangle3D_array_defs.h"
 #include "viewport.h"
 
 [[gnu::nonnull(1)]]
@@ -18,3 +20,28 @@ void mesh_clear(Mesh *const self);
 void mesh_render(const Mesh *const restrict self,
                  const Camera *const restrict camera,
                  const Viewport *const restrict viewport);
+
+// Add the parts of the triangle, in camera space, inside the view frustum if it
+// faces the camera. Only the planes of the frustum in plane_mask are clipped
+// against, see camera_aabb_in_frustum().
+[[gnu::nonnull]]
+void mesh_view_triangle(Triangle3D *const restrict triangle,
+                        const Camera *const restrict camera,
+                        const uint8_t plane_mask,
+                        Triangle3DArray *const restrict viewed_triangles,
+                        FrameArena *const restrict arena);
+
+// Shade, project and draw the triangles added by mesh_view_triangle().
+[[gnu::nonnull]]
+void mesh_draw_viewed_triangles(
+    const Triangle3DArray *const restrict viewed_triangles,
+    const Camera *const restrict camera,
+    const Viewport *const restrict viewport);
+
+// Shade and project the triangles added by mesh_view_triangle(), then bin them
+// in the tiles to be rasterized later.
+[[gnu::nonnull]]
+void mesh_bin_viewed_triangles(
+    const Triangle3DArray *const restrict viewed_triangles,
+    const Camera *const restrict camera, RenderTiles *const restrict tiles,
+    const size_t thread_index);
@@ -1,8 +1,18 @@
 #include "perlin_noise.h"
 
+#include <assert.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 #include "utils.h"
 #include "vec.h"
 
+// Above this number of lattice points in a grid, the gradients are computed for
+// each sample instead.
+#define PERLIN_NOISE_GRID_MAX_GRADIENTS 1024
+#define PERLIN_NOISE_GRID_COARSE_MAX_SAMPLES 4096
+
 static inline float fade(const float t) {
     return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
 }
@@ -49,3 +59,298 @@ float perlin_noise(const v2i position, const uint32_t seed, float frequency,
 
     return (result + 1.0f) / 2.0f;
 }
+
+// A row of a grid, with the gradients of the lattice points it covers.
+typedef struct {
+    float *row;
+    int origin_x;
+    int width;
+    float frequency;
+    float amplitude;
+    const float *gradients_x;
+    const float *gradients_y;
+    int gradients_width;
+    // Index in the gradients of the lattice point at x = 0 above the row.
+    int gradients_index;
+    float d0_y;
+    float d1_y;
+    float fade_y;
+} NoiseGridRow;
+
+// Add the noise to the values of the row from x.
+[[gnu::nonnull]]
+static void noise_grid_row_scalar(const NoiseGridRow *const restrict self,
+                                  int x) {
+    assert(self != NULL);
+
+    for (; x < self->width; ++x) {
+        const float p_x = (self->origin_x + x) * self->frequency;
+        const int p0_x = floorf(p_x);
+        const float d0_x = p_x - p0_x;
+        const float d1_x = p_x - (p0_x + 1);
+        const float fade_x = fade(d0_x);
+        const int i0 = self->gradients_index + p0_x;
+        const int i2 = i0 + self->gradients_width;
+        const float *const gradients_x = self->gradients_x;
+        const float *const gradients_y = self->gradients_y;
+
+        const float value =
+            lerp(lerp(d0_x * gradients_x[i0] + self->d0_y * gradients_y[i0],
+                      d1_x * gradients_x[i0 + 1] +
+                          self->d0_y * gradients_y[i0 + 1],
+                      fade_x),
+                 lerp(d0_x * gradients_x[i2] + self->d1_y * gradients_y[i2],
+                      d1_x * gradients_x[i2 + 1] +
+                          self->d1_y * gradients_y[i2 + 1],
+                      fade_x),
+                 self->fade_y);
+        self->row[x] += value * self->amplitude;
+    }
+}
+
+// The AVX2 variant is picked at runtime, even without AVX2 in the build target.
+#if defined(__x86_64__) || defined(__i386__)
+// Add the noise to the values of the row 8 at a time, the values left are
+// added by noise_grid_row_scalar().
+[[gnu::nonnull]] [[gnu::target("avx2")]]
+static void noise_grid_row_avx2(const NoiseGridRow *const restrict self) {
+    assert(self != NULL);
+
+    float *const row = self->row;
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 d0_y = _mm256_set1_ps(self->d0_y);
+    const __m256 d1_y = _mm256_set1_ps(self->d1_y);
+    const __m256 fade_y = _mm256_set1_ps(self->fade_y);
+    int x = 0;
+    for (; x + 8 <= self->width; x += 8) {
+        const __m256 p_x = _mm256_mul_ps(
+            _mm256_cvtepi32_ps(
+                _mm256_add_epi32(_mm256_set1_epi32(self->origin_x + x), lanes)),
+            _mm256_set1_ps(self->frequency));
+        const __m256 p0_x = _mm256_floor_ps(p_x);
+        const __m256 d0_x = _mm256_sub_ps(p_x, p0_x);
+        const __m256 d1_x = _mm256_sub_ps(p_x, _mm256_add_ps(p0_x, one));
+
+        // t * t * t * (t * (t * 6 - 15) + 10)
+        const __m256 fade_x = _mm256_mul_ps(
+            _mm256_mul_ps(_mm256_mul_ps(d0_x, d0_x), d0_x),
+            _mm256_add_ps(
+                _mm256_mul_ps(
+                    d0_x,
+                    _mm256_sub_ps(_mm256_mul_ps(d0_x, _mm256_set1_ps(6.0f)),
+                                  _mm256_set1_ps(15.0f))),
+                _mm256_set1_ps(10.0f)));
+
+        const __m256i i0 =
+            _mm256_add_epi32(_mm256_cvttps_epi32(p0_x),
+                             _mm256_set1_epi32(self->gradients_index));
+        const __m256i i1 = _mm256_add_epi32(i0, _mm256_set1_epi32(1));
+        const __m256i i2 =
+            _mm256_add_epi32(i0, _mm256_set1_epi32(self->gradients_width));
+        const __m256i i3 = _mm256_add_epi32(i2, _mm256_set1_epi32(1));
+
+        const float *const gradients_x = self->gradients_x;
+        const float *const gradients_y = self->gradients_y;
+        const __m256 dot0 = _mm256_add_ps(
+            _mm256_mul_ps(d0_x, _mm256_i32gather_ps(gradients_x, i0, 4)),
+            _mm256_mul_ps(d0_y, _mm256_i32gather_ps(gradients_y, i0, 4)));
+        const __m256 dot1 = _mm256_add_ps(
+            _mm256_mul_ps(d1_x, _mm256_i32gather_ps(gradients_x, i1, 4)),
+            _mm256_mul_ps(d0_y, _mm256_i32gather_ps(gradients_y, i1, 4)));
+        const __m256 dot2 = _mm256_add_ps(
+            _mm256_mul_ps(d0_x, _mm256_i32gather_ps(gradients_x, i2, 4)),
+            _mm256_mul_ps(d1_y, _mm256_i32gather_ps(gradients_y, i2, 4)));
+        const __m256 dot3 = _mm256_add_ps(
+            _mm256_mul_ps(d1_x, _mm256_i32gather_ps(gradients_x, i3, 4)),
+            _mm256_mul_ps(d1_y, _mm256_i32gather_ps(gradients_y, i3, 4)));
+
+        // (1 - t) * a + t * b
+        const __m256 one_minus_fade_x = _mm256_sub_ps(one, fade_x);
+        const __m256 top = _mm256_add_ps(_mm256_mul_ps(one_minus_fade_x, dot0),
+                                         _mm256_mul_ps(fade_x, dot1));
+        const __m256 bottom =
+            _mm256_add_ps(_mm256_mul_ps(one_minus_fade_x, dot2),
+                          _mm256_mul_ps(fade_x, dot3));
+        const __m256 value =
+            _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, fade_y), top),
+                          _mm256_mul_ps(fade_y, bottom));
+
+        _mm256_storeu_ps(
+            &row[x],
+            _mm256_add_ps(_mm256_loadu_ps(&row[x]),
+                          _mm256_mul_ps(value,
+                                        _mm256_set1_ps(self->amplitude))));
+    }
+    noise_grid_row_scalar(self, x);
+}
+#endif
+
+// Add one octave of noise to values, the gradients of the lattice points
+// covered by the grid are computed once.
+[[gnu::nonnull]]
+static void noise_grid(const PerlinNoiseVariant variant,
+                       float *const restrict values, const v2i origin,
+                       const int width, const int height, const uint32_t seed,
+                       const float frequency, const float amplitude) {
+    assert(values != NULL);
+    assert(width > 0 && height > 0);
+
+    const v2i min = v2f_floor(v2i_mul_f(origin, frequency));
+    const v2i max = v2f_floor(v2i_mul_f(
+        (v2i){origin.x + width - 1, origin.y + height - 1}, frequency));
+    const int gradients_width = max.x - min.x + 2;
+    const int gradients_height = max.y - min.y + 2;
+
+    if (gradients_width * gradients_height > PERLIN_NOISE_GRID_MAX_GRADIENTS) {
+        for (int z = 0; z < height; ++z) {
+            for (int x = 0; x < width; ++x) {
+                const v2i position = {origin.x + x, origin.y + z};
+                values[z * width + x] +=
+                    noise(v2i_mul_f(position, frequency), seed) * amplitude;
+            }
+        }
+        return;
+    }
+
+    float gradients_x[PERLIN_NOISE_GRID_MAX_GRADIENTS];
+    float gradients_y[PERLIN_NOISE_GRID_MAX_GRADIENTS];
+    for (int y = 0; y < gradients_height; ++y) {
+        for (int x = 0; x < gradients_width; ++x) {
+            const v2f gradient = grad((v2i){min.x + x, min.y + y}, seed);
+            gradients_x[y * gradients_width + x] = gradient.x;
+            gradients_y[y * gradients_width + x] = gradient.y;
+        }
+    }
+
+    for (int z = 0; z < height; ++z) {
+        const float p_y = (origin.y + z) * frequency;
+        const int p0_y = floorf(p_y);
+        const NoiseGridRow row = {
+            .row = &values[z * width],
+            .origin_x = origin.x,
+            .width = width,
+            .frequency = frequency,
+            .amplitude = amplitude,
+            .gradients_x = gradients_x,
+            .gradients_y = gradients_y,
+            .gradients_width = gradients_width,
+            .gradients_index = (p0_y - min.y) * gradients_width - min.x,
+            .d0_y = p_y - p0_y,
+            .d1_y = p_y - (p0_y + 1),
+            .fade_y = fade(p_y - p0_y),
+        };
+
+        switch (variant) {
+#if defined(__x86_64__) || defined(__i386__)
+            case PERLIN_NOISE_AVX2:
+                noise_grid_row_avx2(&row);
+                break;
+#endif
+            default:
+                noise_grid_row_scalar(&row, 0);
+                break;
+        }
+    }
+}
+
+bool perlin_noise_is_supported(const PerlinNoiseVariant variant) {
+    switch (variant) {
+        case PERLIN_NOISE_SCALAR:
+            return true;
+        case PERLIN_NOISE_AVX2:
+#if defined(__AVX2__)
+            return true;
+#elif defined(__x86_64__) || defined(__i386__)
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case PERLIN_NOISE_VARIANT_COUNT:
+            break;
+    }
+    assert(false && "invalid perlin noise variant");
+    return false;
+}
+
+void perlin_noise_grid_with(const PerlinNoiseVariant variant,
+                            float *const restrict values, const v2i origin,
+                            const int width, const int height,
+                            const uint32_t seed, float frequency,
+                            const uint8_t depth) {
+    assert(perlin_noise_is_supported(variant));
+    assert(values != NULL);
+    assert(width > 0 && height > 0);
+
+    for (int i = 0; i < width * height; ++i) {
+        values[i] = 0.0f;
+    }
+
+    float amplitude = 1.0f;
+    for (uint8_t i = 0; i < depth; ++i) {
+        noise_grid(variant, values, origin, width, height, seed, frequency,
+                   amplitude);
+        frequency *= 2.0f;
+        amplitude *= 0.5f;
+    }
+
+    for (int i = 0; i < width * height; ++i) {
+        values[i] = (values[i] + 1.0f) / 2.0f;
+    }
+}
+
+void perlin_noise_grid(float *const restrict values, const v2i origin,
+                       const int width, const int height, const uint32_t seed,
+                       const float frequency, const uint8_t depth) {
+    PerlinNoiseVariant variant = PERLIN_NOISE_VARIANT_COUNT - 1;
+    while (!perlin_noise_is_supported(variant)) --variant;
+    perlin_noise_grid_with(variant, values, origin, width, height, seed,
+                           frequency, depth);
+}
+
+void perlin_noise_grid_coarse(float *const restrict values, const v2i origin,
+                              const int width, const int height,
+                              const uint32_t seed, const float frequency,
+                              const uint8_t depth, const int resolution) {
+    assert(values != NULL);
+    assert(width > 0 && height > 0);
+    assert(resolution > 0);
+
+    if (resolution == 1) {
+        perlin_noise_grid(values, origin, width, height, seed, frequency,
+                          depth);
+        return;
+    }
+
+    const v2i min = {
+        floor_div_int(origin.x, resolution),
+        floor_div_int(origin.y, resolution),
+    };
+    const int samples_width =
+        floor_div_int(origin.x + width - 1, resolution) - min.x + 2;
+    const int samples_height =
+        floor_div_int(origin.y + height - 1, resolution) - min.y + 2;
+    assert(samples_width * samples_height <=
+           PERLIN_NOISE_GRID_COARSE_MAX_SAMPLES);
+
+    float samples[PERLIN_NOISE_GRID_COARSE_MAX_SAMPLES];
+    perlin_noise_grid(samples, min, samples_width, samples_height, seed,
+                      frequency * resolution, depth);
+
+    for (int z = 0; z < height; ++z) {
+        const int sample_z = floor_div_int(origin.y + z, resolution) - min.y;
+        const float t_z =
+            (float)POSITIVE_MOD(origin.y + z, resolution) / resolution;
+        const float *const row0 = &samples[sample_z * samples_width];
+        const float *const row1 = &row0[samples_width];
+        for (int x = 0; x < width; ++x) {
+            const int sample_x =
+                floor_div_int(origin.x + x, resolution) - min.x;
+            const float t_x =
+                (float)POSITIVE_MOD(origin.x + x, resolution) / resolution;
+            values[z * width + x] =
+                lerp(lerp(row0[sample_x], row0[sample_x + 1], t_x),
+                     lerp(row1[sample_x], row1[sample_x + 1], t_x), t_z);
+        }
+    }
+}
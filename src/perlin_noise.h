@@ -1,8 +1,44 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "vec_defs.h"
 
 float perlin_noise(const v2i position, const uint32_t seed, float frequency,
                    const uint8_t depth);
+
+// The implementations of perlin_noise_grid(), from the narrowest vectors to
+// the widest.
+typedef enum : uint8_t {
+    PERLIN_NOISE_SCALAR,
+    PERLIN_NOISE_AVX2,
+    PERLIN_NOISE_VARIANT_COUNT,
+} PerlinNoiseVariant;
+
+// Whether the variant is built and the CPU can run it.
+bool perlin_noise_is_supported(const PerlinNoiseVariant variant);
+
+// Fill values[z * width + x] with the noise at origin + (x, z), as
+// perlin_noise() would. The widest supported variant is used.
+[[gnu::nonnull]]
+void perlin_noise_grid(float *const restrict values, const v2i origin,
+                       const int width, const int height, const uint32_t seed,
+                       const float frequency, const uint8_t depth);
+
+// perlin_noise_grid() with the given variant, which must be supported.
+[[gnu::nonnull]]
+void perlin_noise_grid_with(const PerlinNoiseVariant variant,
+                            float *const restrict values, const v2i origin,
+                            const int width, const int height,
+                            const uint32_t seed, float frequency,
+                            const uint8_t depth);
+
+// Like perlin_noise_grid(), but the noise is only evaluated every resolution
+// blocks, on a lattice aligned on the world origin, and bilinearly
+// interpolated in between. Meant for the low frequency layers.
+[[gnu::nonnull]]
+void perlin_noise_grid_coarse(float *const restrict values, const v2i origin,
+                              const int width, const int height,
+                              const uint32_t seed, const float frequency,
+                              const uint8_t depth, const int resolution);
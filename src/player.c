@@ -19,8 +19,6 @@
 #include "vec.h"
 #include "window.h"
 
-#define WORLD_ORIGIN (WORLD_SIZE / 2)
-
 [[gnu::nonnull]]
 static inline void player_generate_mesh(Player *const self) {
     assert(self != NULL);
@@ -253,14 +251,7 @@ void player_init(Player *const restrict self, const int8_t player_index,
         world, world_position_to_chunk_coordinate(self->position),
         player_index);
 
-    for (int y = CHUNK_HEIGHT - 1; y >= 0; --y) {
-        if (world_block_is_solid(world,
-                                 (v3i){PLAYER_START_X, y, PLAYER_START_Z})) {
-            self->position.y = y + 1.0f;
-            return;
-        }
-    }
-    self->position.y = 0.0f;
+    self->position.y = world_get_height(world, PLAYER_START_X, PLAYER_START_Z);
 }
 
 void player_destroy(Player *const self) {
@@ -629,7 +620,7 @@ static inline void player_render_targeted_block(
     if (!self->is_targeting_a_block) return;
 
     const char *block_name =
-        block_get_name(world_get_block(world, self->targeted_block)->type);
+        block_get_name(world_get_block(world, self->targeted_block).type);
     const size_t block_name_length = strlen(block_name);
 
     char horizontal_border[block_name_length + 5];
@@ -769,7 +760,10 @@ bool player_get_targeted_block(const Player *const restrict self,
     for (position.x = min_x; position.x <= max_x; ++position.x) {
         for (position.y = min_y; position.y <= max_y; ++position.y) {
             for (position.z = min_z; position.z <= max_z; ++position.z) {
-                if (!world_block_is_solid(world, position)) continue;
+                if (!world_block_is_generated(world, position) ||
+                    !world_block_is_solid(world, position)) {
+                    continue;
+                }
 
                 aabb.position.x = position.x;
                 aabb.position.y = position.y;
@@ -899,14 +893,7 @@ void player_teleport(Player *const restrict self, v3i position,
     }
 
     if (position.y == -1) {
-        for (int y = CHUNK_HEIGHT - 1; y >= 0; --y) {
-            if (world_block_is_solid(world, (v3i){position.x, y, position.z})) {
-                self->position.y = y + 1.0f;
-                goto exit_loop;
-            }
-        }
-        self->position.y = 0.0f;
-    exit_loop:
+        self->position.y = world_get_height(world, position.x, position.z);
     } else if (self->game_mode != PLAYER_GAME_MODE_SPECTATOR) {
         while (true) {
             if (world_block_is_solid(world, position)) {
@@ -0,0 +1,441 @@
+#include "render_tiles.h"
+
+#include <assert.h>
+#include <float.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "camera.h"
+#include "frame_arena.h"
+#include "render_tiles_group_array.h"
+#include "triangle3D_array.h"
+#include "utils.h"
+#include "vec.h"
+#include "window.h"
+
+#define RENDER_TILES_BLOCK_COLUMNS (RENDER_TILE_WIDTH / RENDER_HI_Z_BLOCK_SIZE)
+#define RENDER_TILES_BLOCK_ROWS (RENDER_TILE_HEIGHT / RENDER_HI_Z_BLOCK_SIZE)
+#define RENDER_TILES_BLOCKS_NUMBER \
+    (RENDER_TILES_BLOCK_COLUMNS * RENDER_TILES_BLOCK_ROWS)
+
+// The outlines are drawn in front of their triangle.
+#define RENDER_TILES_OUTLINE_Z(z) \
+    ((z) - MESH_OUTLINE_Z_CORRECTION * (1.0f - (z)))
+
+// The farthest depth of each block of a tile while it is rasterized.
+typedef struct {
+    v2i min, max;
+    float depths[RENDER_TILES_BLOCKS_NUMBER];
+    // The blocks drawn since their depth was computed.
+    uint64_t dirty_blocks;
+} RenderTilesHiZ;
+
+void render_tiles_init(RenderTiles *const restrict self,
+                       const Viewport *const restrict viewport,
+                       FrameArena arenas[WORLD_RENDER_THREADS_NUMBER]) {
+    assert(self != NULL);
+    assert(viewport != NULL);
+    assert(arenas != NULL);
+
+    self->viewport = *viewport;
+    self->columns = (viewport->width + RENDER_TILE_WIDTH - 1) /
+                    RENDER_TILE_WIDTH;
+    self->rows = (viewport->height + RENDER_TILE_HEIGHT - 1) /
+                 RENDER_TILE_HEIGHT;
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        self->threads[i].arena = &arenas[i];
+        self->threads[i].bins = NULL;
+        self->threads[i].chunk_index = UINT32_MAX;
+    }
+    atomic_init(&self->chunks_length, 0);
+    atomic_init(&self->occluded_triangles_number, 0);
+}
+
+void render_tiles_destroy(RenderTiles *const self) {
+    assert(self != NULL);
+
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        frame_arena_reset(self->threads[i].arena);
+    }
+}
+
+FrameArena *render_tiles_get_arena(RenderTiles *const self,
+                                   const size_t thread_index) {
+    assert(self != NULL);
+    assert(thread_index < WORLD_RENDER_THREADS_NUMBER);
+    return self->threads[thread_index].arena;
+}
+
+void render_tiles_begin_chunk(RenderTiles *const restrict self,
+                              const size_t thread_index,
+                              const Camera *const restrict camera,
+                              const Aabb *const restrict aabb,
+                              const float distance_squared) {
+    assert(self != NULL);
+    assert(thread_index < WORLD_RENDER_THREADS_NUMBER);
+    assert(camera != NULL);
+    assert(aabb != NULL);
+
+    const uint32_t chunk_index = atomic_fetch_add_explicit(
+        &self->chunks_length, 1, memory_order_relaxed);
+    assert(chunk_index < WORLD_RENDER_CHUNKS_NUMBER);
+    self->threads[thread_index].chunk_index = chunk_index;
+
+    RenderTilesChunk *const chunk = &self->chunks[chunk_index];
+    chunk->is_near = false;
+    chunk->distance_squared = distance_squared;
+    chunk->tiles_number = 0;
+    atomic_init(&chunk->occluded_tiles_number, 0);
+
+    m4f view_matrix;
+    camera_get_view_matrix(camera, view_matrix);
+    v2f min = {FLT_MAX, FLT_MAX};
+    v2f max = {-FLT_MAX, -FLT_MAX};
+    float min_z = FLT_MAX;
+    for (uint8_t i = 0; i < 8; ++i) {
+        const v3f corner = {
+            aabb->position.x + (i & 1 ? aabb->size.x : 0.0f),
+            aabb->position.y + (i & 2 ? aabb->size.y : 0.0f),
+            aabb->position.z + (i & 4 ? aabb->size.z : 0.0f),
+        };
+        const v3f viewed_corner = mul_m4f_v3f(view_matrix, corner).xyz;
+        // The projection of the corners behind the camera is meaningless.
+        if (viewed_corner.z < CAMERA_Z_NEAR) {
+            chunk->is_near = true;
+            return;
+        }
+        const v3f projected_corner =
+            mul_m4f_v3f(camera->projection_matrix, viewed_corner).xyz;
+        const float x = self->viewport.x_offset +
+                        self->viewport.width * (projected_corner.x + 1.0f) /
+                            2.0f;
+        const float y = self->viewport.y_offset +
+                        self->viewport.height * (-projected_corner.y + 1.0f) /
+                            2.0f;
+        min.x = fminf(min.x, x);
+        min.y = fminf(min.y, y);
+        max.x = fmaxf(max.x, x);
+        max.y = fmaxf(max.y, y);
+        min_z = fminf(min_z, projected_corner.z);
+    }
+
+    chunk->min = (v2i){floorf(min.x), floorf(min.y)};
+    chunk->max = (v2i){(int)(max.x + 0.5f) + 1, (int)(max.y + 0.5f) + 1};
+    chunk->z = RENDER_TILES_OUTLINE_Z(min_z);
+}
+
+void render_tiles_bin(RenderTiles *const restrict self,
+                      const size_t thread_index,
+                      Triangle3D *const restrict triangle) {
+    assert(self != NULL);
+    assert(thread_index < WORLD_RENDER_THREADS_NUMBER);
+    assert(triangle != NULL);
+
+    RenderTilesThread *const thread = &self->threads[thread_index];
+    assert(thread->chunk_index < WORLD_RENDER_CHUNKS_NUMBER);
+    const int tiles_number = self->columns * self->rows;
+    if (thread->bins == NULL) {
+        thread->bins = frame_arena_alloc(
+            thread->arena, sizeof(*thread->bins) * tiles_number);
+        for (int i = 0; i < tiles_number; ++i) {
+            thread->bins[i].triangles.array = NULL;
+        }
+    }
+
+    // The outlines are rounded to the nearest character, they can go half a
+    // character past the bounding box of the triangle.
+    const float min_x = min3_float(triangle->v1.x, triangle->v2.x,
+                                   triangle->v3.x);
+    const float min_y = min3_float(triangle->v1.y, triangle->v2.y,
+                                   triangle->v3.y);
+    const float max_x = max3_float(triangle->v1.x, triangle->v2.x,
+                                   triangle->v3.x) + 0.5f;
+    const float max_y = max3_float(triangle->v1.y, triangle->v2.y,
+                                   triangle->v3.y) + 0.5f;
+
+    const int first_column = clamp_int(
+        ((int)min_x - self->viewport.x_offset) / RENDER_TILE_WIDTH, 0,
+        self->columns - 1);
+    const int last_column = clamp_int(
+        ((int)max_x - self->viewport.x_offset) / RENDER_TILE_WIDTH, 0,
+        self->columns - 1);
+    const int first_row = clamp_int(
+        ((int)min_y - self->viewport.y_offset) / RENDER_TILE_HEIGHT, 0,
+        self->rows - 1);
+    const int last_row = clamp_int(
+        ((int)max_y - self->viewport.y_offset) / RENDER_TILE_HEIGHT, 0,
+        self->rows - 1);
+
+    for (int row = first_row; row <= last_row; ++row) {
+        for (int column = first_column; column <= last_column; ++column) {
+            RenderTilesBin *const bin =
+                &thread->bins[row * self->columns + column];
+            if (bin->triangles.array == NULL) {
+                triangle3D_array_init_in_arena(
+                    &bin->triangles, RENDER_TILE_BIN_DEFAULT_CAPACITY,
+                    thread->arena);
+                render_tiles_group_array_init_in_arena(
+                    &bin->groups, RENDER_TILE_BIN_GROUPS_DEFAULT_CAPACITY,
+                    thread->arena);
+            }
+            if (bin->groups.length == 0 ||
+                bin->groups.array[bin->groups.length - 1].chunk_index !=
+                    thread->chunk_index) {
+                render_tiles_group_array_push_in_arena(
+                    &bin->groups,
+                    (RenderTilesGroup){
+                        .chunk_index = thread->chunk_index,
+                        .first_triangle = bin->triangles.length,
+                    },
+                    thread->arena);
+                ++self->chunks[thread->chunk_index].tiles_number;
+            }
+            triangle3D_array_push_in_arena(&bin->triangles, triangle,
+                                           thread->arena);
+        }
+    }
+}
+
+// Get the blocks overlapping the rectangle from min included to max excluded,
+// return false when there are none.
+[[gnu::nonnull]]
+static bool
+render_tiles_hi_z_get_blocks(const RenderTilesHiZ *const restrict self,
+                             const v2i min, const v2i max,
+                             v2i *const restrict first_block,
+                             v2i *const restrict last_block) {
+    assert(self != NULL);
+    assert(first_block != NULL);
+    assert(last_block != NULL);
+
+    const int min_x = max_int(min.x, self->min.x) - self->min.x;
+    const int min_y = max_int(min.y, self->min.y) - self->min.y;
+    const int max_x = min_int(max.x, self->max.x) - self->min.x;
+    const int max_y = min_int(max.y, self->max.y) - self->min.y;
+    if (max_x <= min_x || max_y <= min_y) return false;
+
+    *first_block = (v2i){min_x / RENDER_HI_Z_BLOCK_SIZE,
+                         min_y / RENDER_HI_Z_BLOCK_SIZE};
+    *last_block = (v2i){(max_x - 1) / RENDER_HI_Z_BLOCK_SIZE,
+                        (max_y - 1) / RENDER_HI_Z_BLOCK_SIZE};
+    return true;
+}
+
+[[gnu::nonnull]]
+static float render_tiles_hi_z_compute_depth(const RenderTilesHiZ *const self,
+                                             const int block_x,
+                                             const int block_y) {
+    assert(self != NULL);
+
+    const int min_x = self->min.x + block_x * RENDER_HI_Z_BLOCK_SIZE;
+    const int min_y = self->min.y + block_y * RENDER_HI_Z_BLOCK_SIZE;
+    const int max_x = min_int(min_x + RENDER_HI_Z_BLOCK_SIZE, self->max.x);
+    const int max_y = min_int(min_y + RENDER_HI_Z_BLOCK_SIZE, self->max.y);
+    float depth = -FLT_MAX;
+    for (int y = min_y; y < max_y; ++y) {
+        const float *const depths = &window.depths[y * window.width];
+        for (int x = min_x; x < max_x; ++x) {
+            // Nothing can be behind a character which was not drawn.
+            if (depths[x] == FLT_MAX) return FLT_MAX;
+            depth = fmaxf(depth, depths[x]);
+        }
+    }
+    return depth;
+}
+
+// Compute again the depths of the blocks drawn in the rectangle. Until then,
+// their depths are farther than the real ones, which is still conservative.
+[[gnu::nonnull]]
+static void render_tiles_hi_z_update(RenderTilesHiZ *const self, const v2i min,
+                                     const v2i max) {
+    assert(self != NULL);
+
+    v2i first_block, last_block;
+    if (!render_tiles_hi_z_get_blocks(self, min, max, &first_block,
+                                      &last_block)) {
+        return;
+    }
+    for (int block_y = first_block.y; block_y <= last_block.y; ++block_y) {
+        for (int block_x = first_block.x; block_x <= last_block.x; ++block_x) {
+            const int block_index =
+                block_y * RENDER_TILES_BLOCK_COLUMNS + block_x;
+            const uint64_t block_bit = (uint64_t)1 << block_index;
+            if (!(self->dirty_blocks & block_bit)) continue;
+            self->depths[block_index] =
+                render_tiles_hi_z_compute_depth(self, block_x, block_y);
+            self->dirty_blocks &= ~block_bit;
+        }
+    }
+}
+
+// Return true when every block overlapping the rectangle is nearer than z.
+[[gnu::nonnull]]
+static bool render_tiles_hi_z_is_occluded(const RenderTilesHiZ *const self,
+                                          const v2i min, const v2i max,
+                                          const float z) {
+    assert(self != NULL);
+
+    v2i first_block, last_block;
+    if (!render_tiles_hi_z_get_blocks(self, min, max, &first_block,
+                                      &last_block)) {
+        return false;
+    }
+    for (int block_y = first_block.y; block_y <= last_block.y; ++block_y) {
+        for (int block_x = first_block.x; block_x <= last_block.x; ++block_x) {
+            if (z < self->depths[block_y * RENDER_TILES_BLOCK_COLUMNS +
+                                 block_x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+[[gnu::nonnull]]
+static void render_tiles_hi_z_invalidate(RenderTilesHiZ *const self,
+                                         const v2i min, const v2i max) {
+    assert(self != NULL);
+
+    v2i first_block, last_block;
+    if (!render_tiles_hi_z_get_blocks(self, min, max, &first_block,
+                                      &last_block)) {
+        return;
+    }
+    for (int block_y = first_block.y; block_y <= last_block.y; ++block_y) {
+        for (int block_x = first_block.x; block_x <= last_block.x; ++block_x) {
+            self->dirty_blocks |=
+                (uint64_t)1 << (block_y * RENDER_TILES_BLOCK_COLUMNS + block_x);
+        }
+    }
+}
+
+// Draw the triangle unless it is behind the depths of the tile, return true
+// when it was drawn.
+[[gnu::nonnull]]
+static bool
+render_tiles_draw_triangle(RenderTilesHiZ *const restrict hi_z,
+                           const Triangle3D *const restrict triangle) {
+    assert(hi_z != NULL);
+    assert(triangle != NULL);
+
+    // The outlines are rounded to the nearest character.
+    const v2i min = {
+        min3_float(triangle->v1.x, triangle->v2.x, triangle->v3.x),
+        min3_float(triangle->v1.y, triangle->v2.y, triangle->v3.y),
+    };
+    const v2i max = {
+        (int)(max3_float(triangle->v1.x, triangle->v2.x, triangle->v3.x) +
+              0.5f) + 1,
+        (int)(max3_float(triangle->v1.y, triangle->v2.y, triangle->v3.y) +
+              0.5f) + 1,
+    };
+    const float z = RENDER_TILES_OUTLINE_Z(
+        min3_float(triangle->v1.z, triangle->v2.z, triangle->v3.z));
+    if (render_tiles_hi_z_is_occluded(hi_z, min, max, z)) return false;
+
+    window_render_triangle(triangle, hi_z->min, hi_z->max);
+    render_tiles_hi_z_invalidate(hi_z, min, max);
+    return true;
+}
+
+void render_tiles_rasterize(RenderTiles *const self, const int tile_index) {
+    assert(self != NULL);
+    assert(0 <= tile_index && tile_index < self->columns * self->rows);
+
+    const int column = tile_index % self->columns;
+    const int row = tile_index / self->columns;
+    RenderTilesHiZ hi_z;
+    hi_z.min = (v2i){
+        .x = self->viewport.x_offset + column * RENDER_TILE_WIDTH,
+        .y = self->viewport.y_offset + row * RENDER_TILE_HEIGHT,
+    };
+    hi_z.max = (v2i){
+        .x = min_int(min_int(hi_z.min.x + RENDER_TILE_WIDTH,
+                             self->viewport.x_offset + self->viewport.width),
+                     window.width),
+        .y = min_int(min_int(hi_z.min.y + RENDER_TILE_HEIGHT,
+                             self->viewport.y_offset + self->viewport.height),
+                     window.height),
+    };
+    if (hi_z.max.x <= hi_z.min.x || hi_z.max.y <= hi_z.min.y) return;
+    for (int i = 0; i < RENDER_TILES_BLOCKS_NUMBER; ++i) {
+        hi_z.depths[i] = FLT_MAX;
+    }
+    hi_z.dirty_blocks = UINT64_MAX;
+
+    // The groups of the threads are merged by distance so the tile is drawn
+    // front to back.
+    size_t next_groups[WORLD_RENDER_THREADS_NUMBER] = {0};
+    uint32_t occluded_triangles_number = 0;
+    while (true) {
+        const RenderTilesBin *bin = NULL;
+        size_t thread_index = 0;
+        float distance_squared = FLT_MAX;
+        for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+            const RenderTilesBin *const bins = self->threads[i].bins;
+            if (bins == NULL || bins[tile_index].triangles.array == NULL ||
+                next_groups[i] == bins[tile_index].groups.length) {
+                continue;
+            }
+            const uint32_t chunk_index =
+                bins[tile_index].groups.array[next_groups[i]].chunk_index;
+            if (bin == NULL ||
+                self->chunks[chunk_index].distance_squared < distance_squared) {
+                bin = &bins[tile_index];
+                thread_index = i;
+                distance_squared = self->chunks[chunk_index].distance_squared;
+            }
+        }
+        if (bin == NULL) break;
+
+        const size_t group_index = next_groups[thread_index]++;
+        const RenderTilesGroup *const group = &bin->groups.array[group_index];
+        const size_t end = group_index + 1 < bin->groups.length
+                               ? group[1].first_triangle
+                               : bin->triangles.length;
+
+        // The blocks are only updated between the chunks, the triangles of a
+        // chunk are tested against the chunks drawn before it.
+        RenderTilesChunk *const chunk = &self->chunks[group->chunk_index];
+        if (chunk->is_near) {
+            render_tiles_hi_z_update(&hi_z, hi_z.min, hi_z.max);
+        } else {
+            render_tiles_hi_z_update(&hi_z, chunk->min, chunk->max);
+        }
+        if (!chunk->is_near && render_tiles_hi_z_is_occluded(
+                                   &hi_z, chunk->min, chunk->max, chunk->z)) {
+            atomic_fetch_add_explicit(&chunk->occluded_tiles_number, 1,
+                                      memory_order_relaxed);
+            occluded_triangles_number += end - group->first_triangle;
+            continue;
+        }
+
+        for (size_t i = group->first_triangle; i < end; ++i) {
+            if (!render_tiles_draw_triangle(&hi_z, bin->triangles.array[i])) {
+                ++occluded_triangles_number;
+            }
+        }
+    }
+
+    atomic_fetch_add_explicit(&self->occluded_triangles_number,
+                              occluded_triangles_number, memory_order_relaxed);
+}
+
+uint32_t render_tiles_get_occluded_chunks_number(
+    const RenderTiles *const self) {
+    assert(self != NULL);
+
+    uint32_t occluded_chunks_number = 0;
+    const uint32_t chunks_length =
+        atomic_load_explicit(&self->chunks_length, memory_order_relaxed);
+    for (uint32_t i = 0; i < chunks_length; ++i) {
+        const RenderTilesChunk *const chunk = &self->chunks[i];
+        if (chunk->tiles_number != 0 &&
+            atomic_load_explicit(&chunk->occluded_tiles_number,
+                                 memory_order_relaxed) == chunk->tiles_number) {
+            ++occluded_chunks_number;
+        }
+    }
+    return occluded_chunks_number;
+}
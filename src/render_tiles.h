@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "camera_defs.h"
+#include "collision_defs.h"
+#include "render_tiles_defs.h"
+
+// The render thread i allocates the memory of the frame in arenas[i].
+[[gnu::nonnull]]
+void render_tiles_init(RenderTiles *const restrict self,
+                       const Viewport *const restrict viewport,
+                       FrameArena arenas[WORLD_RENDER_THREADS_NUMBER]);
+
+// Reset the arenas of the threads.
+[[gnu::nonnull]]
+void render_tiles_destroy(RenderTiles *const self);
+
+// Arena of the frame for the thread, the triangles must live there until the
+// tiles are rasterized.
+[[gnu::nonnull]] [[gnu::returns_nonnull]]
+FrameArena *render_tiles_get_arena(RenderTiles *const self,
+                                   const size_t thread_index);
+
+// The next triangles binned by the thread belong to the chunk with this
+// bounding box.
+[[gnu::nonnull]]
+void render_tiles_begin_chunk(RenderTiles *const restrict self,
+                              const size_t thread_index,
+                              const Camera *const restrict camera,
+                              const Aabb *const restrict aabb,
+                              const float distance_squared);
+
+// Add the triangle, in screen space, to the bins of the thread of the tiles it
+// overlaps.
+[[gnu::nonnull]]
+void render_tiles_bin(RenderTiles *const restrict self,
+                      const size_t thread_index,
+                      Triangle3D *const restrict triangle);
+
+// Draw the triangles binned in the tile, chunk by chunk from front to back,
+// skipping the chunks and the triangles behind the depths already drawn. A tile
+// must only be rasterized by one thread at a time.
+[[gnu::nonnull]]
+void render_tiles_rasterize(RenderTiles *const self, const int tile_index);
+
+// Number of chunks occluded in all the tiles they were binned in.
+[[gnu::nonnull]]
+uint32_t render_tiles_get_occluded_chunks_number(
+    const RenderTiles *const self);
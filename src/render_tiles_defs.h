@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "frame_arena_defs.h"
+#include "render_tiles_group_array_defs.h"
+#include "triangle.h"
+#include "triangle3D_array_defs.h"
+#include "viewport_defs.h"
+
+// A chunk binned in the tiles.
+typedef struct {
+    // The screen rectangle of the chunk, from min included to max excluded,
+    // and its nearest depth. Chunks crossing the near plane are never occluded.
+    v2i min, max;
+    float z;
+    bool is_near;
+    float distance_squared;
+    // Number of tiles the chunk has triangles in, and of those where it was
+    // occluded.
+    int tiles_number;
+    _Atomic int occluded_tiles_number;
+} RenderTilesChunk;
+
+typedef struct {
+    Triangle3DArray triangles;
+    // The triangles split by chunk, in the order they were binned.
+    RenderTilesGroupArray groups;
+} RenderTilesBin;
+
+// Triangles projected by a render thread, kept until the tiles are rasterized.
+typedef struct {
+    // Arena of the thread, reset once the tiles are rasterized.
+    FrameArena *arena;
+    // One per tile, each bin is initialized on its first triangle.
+    RenderTilesBin *bins;
+    // Index of the chunk being binned.
+    uint32_t chunk_index;
+} RenderTilesThread;
+
+// The viewport split in tiles of RENDER_TILE_WIDTH by RENDER_TILE_HEIGHT
+// characters, in rows.
+typedef struct {
+    Viewport viewport;
+    int columns, rows;
+    RenderTilesThread threads[WORLD_RENDER_THREADS_NUMBER];
+    RenderTilesChunk chunks[WORLD_RENDER_CHUNKS_NUMBER];
+    _Atomic uint32_t chunks_length;
+    // Triangles skipped in a tile because of the depths already drawn there,
+    // a triangle is counted once per tile.
+    _Atomic uint32_t occluded_triangles_number;
+} RenderTiles;
@@ -0,0 +1,4 @@
+#include "render_tiles_group_array.h"
+
+ARENA_ARRAY_IMPLEMENTATION(render_tiles_group, RenderTilesGroup,
+                           RenderTilesGroup)
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "array.h"
+#include "render_tiles_group_array_defs.h"
+
+DEFINE_ARENA_ARRAY(render_tiles_group, RenderTilesGroup, RenderTilesGroup)
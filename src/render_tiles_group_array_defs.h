@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "array_defs.h"
+
+// The triangles of a bin from first_triangle to the first triangle of the next
+// group belong to the chunk at chunk_index in the render tiles.
+typedef struct {
+    uint32_t chunk_index;
+    uint32_t first_triangle;
+} RenderTilesGroup;
+
+DEFINE_ARRAY_TYPE(RenderTilesGroup, RenderTilesGroup);
@@ -1,15 +1,25 @@
 #include "texture.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stddef.h>
 
 #include "utils.h"
 
+// Repeat the texture past 1, so a face can span several blocks. The values in
+// [0, 1] are left as is for the faces of a single block.
+static inline float texture_wrap(const float value) {
+    if (value <= 1.0f) return value;
+    return value - (ceilf(value) - 1.0f);
+}
+
 Color texture_get(const Texture *const texture, const float u, const float v) {
     assert(texture != NULL);
 
-    const int texture_x = clamp_int(u * TEXTURE_SIZE, 0, TEXTURE_SIZE - 1);
-    const int texture_y = clamp_int(v * TEXTURE_SIZE, 0, TEXTURE_SIZE - 1);
+    const int texture_x =
+        clamp_int(texture_wrap(u) * TEXTURE_SIZE, 0, TEXTURE_SIZE - 1);
+    const int texture_y =
+        clamp_int(texture_wrap(v) * TEXTURE_SIZE, 0, TEXTURE_SIZE - 1);
 
     const Color color = texture[texture_y * TEXTURE_SIZE + texture_x];
     assert(color < COLOR_COUNT);
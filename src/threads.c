@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "config.h"
 #include "log.h"
 
 void mutex_destroy(pthread_mutex_t *const mutex) {
@@ -14,3 +15,152 @@ void mutex_destroy(pthread_mutex_t *const mutex) {
         exit(EXIT_FAILURE);
     }
 }
+
+typedef struct {
+    JobFunction function;
+    void *data;
+    JobGroup *group;
+} Job;
+
+typedef struct {
+    // Ring buffer of the jobs waiting for a thread.
+    Job queue[JOBS_QUEUE_CAPACITY];
+    size_t queue_start;
+    size_t queue_length;
+    pthread_mutex_t mutex;
+    // The threads are parked on it while the queue is empty.
+    pthread_cond_t job_condition;
+    // Broadcasted when the last job of a group is done.
+    pthread_cond_t done_condition;
+    pthread_t threads[JOBS_THREADS_NUMBER];
+    bool running;
+} Jobs;
+
+static Jobs jobs = {
+    .queue_start = 0,
+    .queue_length = 0,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .job_condition = PTHREAD_COND_INITIALIZER,
+    .done_condition = PTHREAD_COND_INITIALIZER,
+    .running = false,
+};
+
+// Must be called with the mutex locked.
+[[gnu::nonnull]]
+static inline bool jobs_pop(Job *const job) {
+    assert(job != NULL);
+
+    if (jobs.queue_length == 0) return false;
+    *job = jobs.queue[jobs.queue_start];
+    jobs.queue_start = (jobs.queue_start + 1) % JOBS_QUEUE_CAPACITY;
+    --jobs.queue_length;
+    return true;
+}
+
+[[gnu::nonnull]]
+static void jobs_run(const Job *const job) {
+    assert(job != NULL);
+
+    job->function(job->data);
+
+    // The group may be freed by its joining thread as soon as it is done.
+    if (atomic_fetch_sub_explicit(&job->group->pending, 1,
+                                  memory_order_acq_rel) == 1) {
+        mutex_lock(&jobs.mutex);
+        pthread_cond_broadcast(&jobs.done_condition);
+        mutex_unlock(&jobs.mutex);
+    }
+}
+
+static void *jobs_thread([[maybe_unused]] void *const data) {
+    mutex_lock(&jobs.mutex);
+    while (true) {
+        Job job;
+        if (jobs_pop(&job)) {
+            mutex_unlock(&jobs.mutex);
+            jobs_run(&job);
+            mutex_lock(&jobs.mutex);
+        } else if (jobs.running) {
+            pthread_cond_wait(&jobs.job_condition, &jobs.mutex);
+        } else {
+            break;
+        }
+    }
+    mutex_unlock(&jobs.mutex);
+
+    return NULL;
+}
+
+void jobs_init(void) {
+    assert(!jobs.running);
+
+    jobs.running = true;
+    for (size_t i = 0; i < JOBS_THREADS_NUMBER; ++i) {
+        const int return_code =
+            pthread_create(&jobs.threads[i], NULL, jobs_thread, NULL);
+        if (return_code != 0) {
+            log_errorf("failed to create job thread: %s",
+                       strerror(return_code));
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+void jobs_quit(void) {
+    assert(jobs.running);
+
+    mutex_lock(&jobs.mutex);
+    jobs.running = false;
+    pthread_cond_broadcast(&jobs.job_condition);
+    mutex_unlock(&jobs.mutex);
+
+    for (size_t i = 0; i < JOBS_THREADS_NUMBER; ++i) {
+        const int return_code = pthread_join(jobs.threads[i], NULL);
+        if (return_code != 0) {
+            log_errorf("failed to join job thread: %s", strerror(return_code));
+            exit(EXIT_FAILURE);
+        }
+    }
+    assert(jobs.queue_length == 0);
+}
+
+void jobs_fork(JobGroup *const group, const JobFunction function,
+               void *const data) {
+    assert(group != NULL);
+    assert(function != NULL);
+
+    const Job job = {.function = function, .data = data, .group = group};
+    atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+
+    mutex_lock(&jobs.mutex);
+    if (jobs.queue_length == JOBS_QUEUE_CAPACITY) {
+        mutex_unlock(&jobs.mutex);
+        jobs_run(&job);
+        return;
+    }
+    jobs.queue[(jobs.queue_start + jobs.queue_length) % JOBS_QUEUE_CAPACITY] =
+        job;
+    ++jobs.queue_length;
+    mutex_unlock(&jobs.mutex);
+
+    pthread_cond_signal(&jobs.job_condition);
+}
+
+void jobs_join(JobGroup *const group) {
+    assert(group != NULL);
+
+    // The jobs of a nested group are run here, so the pool cannot be starved
+    // by the threads waiting for them.
+    mutex_lock(&jobs.mutex);
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) != 0) {
+        Job job;
+        if (jobs_pop(&job)) {
+            mutex_unlock(&jobs.mutex);
+            jobs_run(&job);
+            mutex_lock(&jobs.mutex);
+        } else {
+            pthread_cond_wait(&jobs.done_condition, &jobs.mutex);
+        }
+    }
+    mutex_unlock(&jobs.mutex);
+}
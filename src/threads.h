@@ -5,6 +5,22 @@
 #include <assert.h>
 #include <pthread.h>
 
+#include "threads_defs.h"
+
+void jobs_init(void);
+
+void jobs_quit(void);
+
+// Queue the job to be run by a thread of the pool. When the queue is full, it
+// is run immediately by the calling thread.
+[[gnu::nonnull(1, 2)]]
+void jobs_fork(JobGroup *const group, const JobFunction function,
+               void *const data);
+
+// Wait for the jobs of the group, running the queued jobs in the meantime.
+[[gnu::nonnull]]
+void jobs_join(JobGroup *const group);
+
 [[gnu::nonnull]]
 void mutex_destroy(pthread_mutex_t *const mutex);
 
@@ -22,9 +38,33 @@ static inline void mutex_unlock(pthread_mutex_t *const mutex) {
     assert(return_code == 0 && "mutex unlock failed");
 }
 
+[[gnu::nonnull]]
+static inline void rwlock_read_lock(pthread_rwlock_t *const rwlock) {
+    assert(rwlock != NULL);
+    [[maybe_unused]] const int return_code = pthread_rwlock_rdlock(rwlock);
+    assert(return_code == 0 && "rwlock read lock failed");
+}
+
+[[gnu::nonnull]]
+static inline void rwlock_write_lock(pthread_rwlock_t *const rwlock) {
+    assert(rwlock != NULL);
+    [[maybe_unused]] const int return_code = pthread_rwlock_wrlock(rwlock);
+    assert(return_code == 0 && "rwlock write lock failed");
+}
+
+[[gnu::nonnull]]
+static inline void rwlock_unlock(pthread_rwlock_t *const rwlock) {
+    assert(rwlock != NULL);
+    [[maybe_unused]] const int return_code = pthread_rwlock_unlock(rwlock);
+    assert(return_code == 0 && "rwlock unlock failed");
+}
+
 #else
 
 #define mutex_lock(mutex)
 #define mutex_unlock(mutex)
+#define rwlock_read_lock(rwlock)
+#define rwlock_write_lock(rwlock)
+#define rwlock_unlock(rwlock)
 
 #endif
@@ -0,0 +1,15 @@
+#pragma once
+
+#ifndef __wasm__
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+typedef void (*JobFunction)(void *data);
+
+// The jobs forked in a group, jobs_join() returns once all of them are done.
+typedef struct {
+    _Atomic uint32_t pending;
+} JobGroup;
+
+#endif
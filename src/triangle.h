@@ -3,6 +3,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "frame_arena_defs.h"
 #include "texture.h"
 #include "vec_defs.h"
 
@@ -20,19 +21,17 @@ typedef struct {
     v2f uv1;
     v2f uv2;
     v2f uv3;
+    // Projections of the vertices cached by vertex_transform_soa(), NULL when
+    // the vertex must be projected.
+    const v4f *screen_v1;
+    const v4f *screen_v2;
+    const v4f *screen_v3;
     const Texture *texture;
     uint8_t edges;
     char shade;
     Color color;
 } Triangle3D;
 
-typedef struct Triangle3DArena {
-    Triangle3D *start;
-    Triangle3D *end;
-    Triangle3D *next;
-    struct Triangle3DArena *next_arena;
-} Triangle3DArena;
-
 typedef struct {
     size_t v1;
     size_t v2;
@@ -50,13 +49,7 @@ Triangle3D *triangle3D_init_v4f(
     const v4f *const restrict v1, const v4f *const restrict v2,
     const v4f *const restrict v3, const v2f uv1, const v2f uv2, const v2f uv3,
     const uint8_t edges, const Texture *const restrict texture,
-    const Color color, Triangle3DArena *const restrict arena);
+    const Color color, FrameArena *const restrict arena);
 
 [[gnu::nonnull]]
 v3f triangle3D_get_normal(const Triangle3D *const triangle);
-
-[[gnu::returns_nonnull]]
-Triangle3DArena *triangle3D_arena_create(const size_t capacity);
-
-[[gnu::nonnull]]
-void triangle3D_arena_destroy(Triangle3DArena *const self);
@@ -1,3 +1,3 @@
 #include "triangle3D_array.h"
 
-ARRAY_IMPLEMENTATION(triangle3D, Triangle3D, Triangle3D*);
+ARENA_ARRAY_IMPLEMENTATION(triangle3D, Triangle3D, Triangle3D*);
@@ -3,4 +3,4 @@
 #include "array.h"
 #include "triangle3D_array_defs.h"
 
-DEFINE_ARRAY(triangle3D, Triangle3D, Triangle3D*)
+DEFINE_ARENA_ARRAY(triangle3D, Triangle3D, Triangle3D*)
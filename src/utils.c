@@ -64,6 +64,15 @@ uint64_t get_time_microseconds(void) {
     return now.tv_sec * 1000000 + now.tv_nsec / 1000;
 }
 
+uint64_t get_time_nanoseconds(void) {
+    struct timespec now;
+    if (clock_gettime(CLOCK_MONOTONIC_RAW, &now) < 0) {
+        log_errorf_errno("failed to get clock time");
+        exit(EXIT_FAILURE);
+    }
+    return now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
 void copy_string(char *const restrict string_destination,
                  const char *const restrict string_source,
                  const size_t max_size) {
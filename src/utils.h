@@ -49,6 +49,7 @@ void *_realloc_or_exit(void *pointer, const size_t size,
 
 uint64_t get_time_miliseconds(void);
 uint64_t get_time_microseconds(void);
+uint64_t get_time_nanoseconds(void);
 
 [[gnu::nonnull(1, 2)]]
 void copy_string(char *const restrict string_destination,
@@ -78,6 +79,11 @@ static inline int max3_int(const int a, const int b, const int c) {
     return max_int(a, max_int(b, c));
 }
 
+// Division rounding toward negative infinity, b must be positive.
+static inline int floor_div_int(const int a, const int b) {
+    return (a < 0 ? a - b + 1 : a) / b;
+}
+
 static inline float clamp_int(const int value, const int minimum,
                               const int maximum) {
     return min_int(maximum, max_int(minimum, value));
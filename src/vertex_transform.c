@@ -0,0 +1,394 @@
+#include "vertex_transform.h"
+
+#include <assert.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+#include "vec.h"
+
+// The vertices are transformed several at a time, one per lane of a vector of
+// floats. LanesN is a vector of N floats with the lanesN_ operations, and
+// LANESN_TARGET the target of the functions using it.
+
+// The AVX2 lanes are picked at runtime, even without AVX2 in the build target.
+#if defined(__x86_64__) || defined(__i386__)
+#define LANES8_TARGET [[gnu::target("avx2")]]
+typedef __m256 Lanes8;
+
+LANES8_TARGET static inline Lanes8 lanes8_load(const float *const values) {
+    return _mm256_loadu_ps(values);
+}
+
+LANES8_TARGET static inline Lanes8 lanes8_set(const float value) {
+    return _mm256_set1_ps(value);
+}
+
+LANES8_TARGET static inline Lanes8 lanes8_add(const Lanes8 a, const Lanes8 b) {
+    return _mm256_add_ps(a, b);
+}
+
+LANES8_TARGET static inline Lanes8 lanes8_sub(const Lanes8 a, const Lanes8 b) {
+    return _mm256_sub_ps(a, b);
+}
+
+LANES8_TARGET static inline Lanes8 lanes8_mul(const Lanes8 a, const Lanes8 b) {
+    return _mm256_mul_ps(a, b);
+}
+
+LANES8_TARGET static inline Lanes8 lanes8_div(const Lanes8 a, const Lanes8 b) {
+    return _mm256_div_ps(a, b);
+}
+
+// Store the vectors of the lanes, v4f *output[8].
+LANES8_TARGET static inline void lanes8_store_v4f(const Lanes8 x,
+                                                  const Lanes8 y,
+                                                  const Lanes8 z,
+                                                  const Lanes8 w,
+                                                  v4f *const output) {
+    const __m256 xy_low = _mm256_unpacklo_ps(x, y);
+    const __m256 xy_high = _mm256_unpackhi_ps(x, y);
+    const __m256 zw_low = _mm256_unpacklo_ps(z, w);
+    const __m256 zw_high = _mm256_unpackhi_ps(z, w);
+    // Vertices 0 and 4, 1 and 5, 2 and 6, 3 and 7.
+    const __m256 v0 =
+        _mm256_shuffle_ps(xy_low, zw_low, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 v1 =
+        _mm256_shuffle_ps(xy_low, zw_low, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 v2 =
+        _mm256_shuffle_ps(xy_high, zw_high, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 v3 =
+        _mm256_shuffle_ps(xy_high, zw_high, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm256_storeu_ps(&output[0].x, _mm256_permute2f128_ps(v0, v1, 0x20));
+    _mm256_storeu_ps(&output[2].x, _mm256_permute2f128_ps(v2, v3, 0x20));
+    _mm256_storeu_ps(&output[4].x, _mm256_permute2f128_ps(v0, v1, 0x31));
+    _mm256_storeu_ps(&output[6].x, _mm256_permute2f128_ps(v2, v3, 0x31));
+}
+#endif
+
+#if defined(__SSE2__)
+#define LANES4_TARGET
+typedef __m128 Lanes4;
+
+static inline Lanes4 lanes4_load(const float *const values) {
+    return _mm_loadu_ps(values);
+}
+
+static inline Lanes4 lanes4_set(const float value) {
+    return _mm_set1_ps(value);
+}
+
+static inline Lanes4 lanes4_add(const Lanes4 a, const Lanes4 b) {
+    return _mm_add_ps(a, b);
+}
+
+static inline Lanes4 lanes4_sub(const Lanes4 a, const Lanes4 b) {
+    return _mm_sub_ps(a, b);
+}
+
+static inline Lanes4 lanes4_mul(const Lanes4 a, const Lanes4 b) {
+    return _mm_mul_ps(a, b);
+}
+
+static inline Lanes4 lanes4_div(const Lanes4 a, const Lanes4 b) {
+    return _mm_div_ps(a, b);
+}
+
+static inline void lanes4_store_v4f(Lanes4 x, Lanes4 y, Lanes4 z, Lanes4 w,
+                                    v4f *const output) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(&output[0].x, x);
+    _mm_storeu_ps(&output[1].x, y);
+    _mm_storeu_ps(&output[2].x, z);
+    _mm_storeu_ps(&output[3].x, w);
+}
+#elif defined(__wasm_simd128__)
+#define LANES4_TARGET
+typedef v128_t Lanes4;
+
+static inline Lanes4 lanes4_load(const float *const values) {
+    return wasm_v128_load(values);
+}
+
+static inline Lanes4 lanes4_set(const float value) {
+    return wasm_f32x4_splat(value);
+}
+
+static inline Lanes4 lanes4_add(const Lanes4 a, const Lanes4 b) {
+    return wasm_f32x4_add(a, b);
+}
+
+static inline Lanes4 lanes4_sub(const Lanes4 a, const Lanes4 b) {
+    return wasm_f32x4_sub(a, b);
+}
+
+static inline Lanes4 lanes4_mul(const Lanes4 a, const Lanes4 b) {
+    return wasm_f32x4_mul(a, b);
+}
+
+static inline Lanes4 lanes4_div(const Lanes4 a, const Lanes4 b) {
+    return wasm_f32x4_div(a, b);
+}
+
+static inline void lanes4_store_v4f(const Lanes4 x, const Lanes4 y,
+                                    const Lanes4 z, const Lanes4 w,
+                                    v4f *const output) {
+    const v128_t xy_low = wasm_i32x4_shuffle(x, y, 0, 4, 1, 5);
+    const v128_t xy_high = wasm_i32x4_shuffle(x, y, 2, 6, 3, 7);
+    const v128_t zw_low = wasm_i32x4_shuffle(z, w, 0, 4, 1, 5);
+    const v128_t zw_high = wasm_i32x4_shuffle(z, w, 2, 6, 3, 7);
+    wasm_v128_store(&output[0],
+                    wasm_i32x4_shuffle(xy_low, zw_low, 0, 1, 4, 5));
+    wasm_v128_store(&output[1],
+                    wasm_i32x4_shuffle(xy_low, zw_low, 2, 3, 6, 7));
+    wasm_v128_store(&output[2],
+                    wasm_i32x4_shuffle(xy_high, zw_high, 0, 1, 4, 5));
+    wasm_v128_store(&output[3],
+                    wasm_i32x4_shuffle(xy_high, zw_high, 2, 3, 6, 7));
+}
+#endif
+
+#define LANES1_TARGET
+typedef float Lanes1;
+
+static inline Lanes1 lanes1_load(const float *const values) {
+    return *values;
+}
+
+static inline Lanes1 lanes1_set(const float value) {
+    return value;
+}
+
+static inline Lanes1 lanes1_add(const Lanes1 a, const Lanes1 b) {
+    return a + b;
+}
+
+static inline Lanes1 lanes1_sub(const Lanes1 a, const Lanes1 b) {
+    return a - b;
+}
+
+static inline Lanes1 lanes1_mul(const Lanes1 a, const Lanes1 b) {
+    return a * b;
+}
+
+static inline Lanes1 lanes1_div(const Lanes1 a, const Lanes1 b) {
+    return a / b;
+}
+
+static inline void lanes1_store_v4f(const Lanes1 x, const Lanes1 y,
+                                    const Lanes1 z, const Lanes1 w,
+                                    v4f *const output) {
+    *output = (v4f){.x = x, .y = y, .z = z, .w = w};
+}
+
+v4f vertex_transform_project(const v3f vertex,
+                             const Camera *const restrict camera,
+                             const Viewport *const restrict viewport) {
+    assert(camera != NULL);
+    assert(viewport != NULL);
+
+    v4f output = mul_m4f_v3f(camera->projection_matrix, vertex);
+    output.x = viewport->x_offset + viewport->width * (output.x + 1.0f) / 2.0f;
+    output.y =
+        viewport->y_offset + viewport->height * (-output.y + 1.0f) / 2.0f;
+    return output;
+}
+
+// Define vertex_transform_soa##N(), which transforms the vertices with
+// Lanes##N vectors.
+#define DEFINE_VERTEX_TRANSFORM_SOA(N)                                         \
+    /* row[0] * x + row[1] * y + row[2] * z + row[3], like mul_m4f_v3f(). */   \
+    LANES##N##_TARGET static inline Lanes##N lanes##N##_dot_row(               \
+        const float row[4], const Lanes##N x, const Lanes##N y,                \
+        const Lanes##N z) {                                                    \
+        return lanes##N##_add(                                                 \
+            lanes##N##_add(                                                    \
+                lanes##N##_add(                                                \
+                    lanes##N##_mul(lanes##N##_set(row[0]), x),                 \
+                    lanes##N##_mul(lanes##N##_set(row[1]), y)),                \
+                lanes##N##_mul(lanes##N##_set(row[2]), z)),                    \
+            lanes##N##_set(row[3]));                                           \
+    }                                                                          \
+                                                                               \
+    [[gnu::nonnull]]                                                           \
+    LANES##N##_TARGET static inline void vertex_transform_lanes##N(            \
+        const float *const restrict xs, const float *const restrict ys,        \
+        const float *const restrict zs, const m4f view_matrix,                 \
+        const Camera *const restrict camera,                                   \
+        const Viewport *const restrict viewport,                               \
+        v4f *const restrict view_vertices,                                     \
+        v4f *const restrict screen_vertices) {                                 \
+        const Lanes##N x = lanes##N##_load(xs);                                \
+        const Lanes##N y = lanes##N##_load(ys);                                \
+        const Lanes##N z = lanes##N##_load(zs);                                \
+                                                                               \
+        const Lanes##N view_x =                                                \
+            lanes##N##_dot_row(&view_matrix[0], x, y, z);                      \
+        const Lanes##N view_y =                                                \
+            lanes##N##_dot_row(&view_matrix[4], x, y, z);                      \
+        const Lanes##N view_z =                                                \
+            lanes##N##_dot_row(&view_matrix[8], x, y, z);                      \
+        lanes##N##_store_v4f(view_x, view_y, view_z,                           \
+                                 lanes##N##_set(view_matrix[15]),              \
+                                 view_vertices);                               \
+                                                                               \
+        const float *const projection_matrix = camera->projection_matrix;      \
+        const Lanes##N w = lanes##N##_dot_row(                                 \
+            &projection_matrix[12], view_x, view_y, view_z);                   \
+        const Lanes##N projected_x = lanes##N##_div(                           \
+            lanes##N##_dot_row(&projection_matrix[0], view_x, view_y,          \
+                                   view_z),                                    \
+            w);                                                                \
+        const Lanes##N projected_y = lanes##N##_div(                           \
+            lanes##N##_dot_row(&projection_matrix[4], view_x, view_y,          \
+                                   view_z),                                    \
+            w);                                                                \
+        const Lanes##N projected_z = lanes##N##_div(                           \
+            lanes##N##_dot_row(&projection_matrix[8], view_x, view_y,          \
+                                   view_z),                                    \
+            w);                                                                \
+                                                                               \
+        const Lanes##N one = lanes##N##_set(1.0f);                             \
+        const Lanes##N half = lanes##N##_set(0.5f);                            \
+        const Lanes##N screen_x = lanes##N##_add(                              \
+            lanes##N##_set(viewport->x_offset),                                \
+            lanes##N##_mul(                                                    \
+                lanes##N##_mul(lanes##N##_set(viewport->width),                \
+                                   lanes##N##_add(projected_x, one)),          \
+                half));                                                        \
+        const Lanes##N screen_y = lanes##N##_add(                              \
+            lanes##N##_set(viewport->y_offset),                                \
+            lanes##N##_mul(                                                    \
+                lanes##N##_mul(lanes##N##_set(viewport->height),               \
+                                   lanes##N##_sub(one, projected_y)),          \
+                half));                                                        \
+        lanes##N##_store_v4f(screen_x, screen_y, projected_z, w,               \
+                                 screen_vertices);                             \
+    }                                                                          \
+                                                                               \
+    [[gnu::nonnull]]                                                           \
+    LANES##N##_TARGET static void vertex_transform_soa##N(                     \
+        const float *const restrict xs, const float *const restrict ys,        \
+        const float *const restrict zs, const size_t length,                   \
+        const m4f view_matrix, const Camera *const restrict camera,            \
+        const Viewport *const restrict viewport,                               \
+        v4f *const restrict view_vertices,                                     \
+        v4f *const restrict screen_vertices) {                                 \
+        size_t i = 0;                                                          \
+        for (; i + N <= length; i += N) {                                      \
+            vertex_transform_lanes##N(                                         \
+                &xs[i], &ys[i], &zs[i], view_matrix, camera, viewport,         \
+                &view_vertices[i], &screen_vertices[i]);                       \
+        }                                                                      \
+        if (i == length) return;                                               \
+                                                                               \
+        /* The last vertices are transformed in padded lanes. */               \
+        const size_t rest = length - i;                                        \
+        float rest_xs[N] = {};                                                 \
+        float rest_ys[N] = {};                                                 \
+        float rest_zs[N] = {};                                                 \
+        memcpy(rest_xs, &xs[i], rest * sizeof(*xs));                           \
+        memcpy(rest_ys, &ys[i], rest * sizeof(*ys));                           \
+        memcpy(rest_zs, &zs[i], rest * sizeof(*zs));                           \
+        v4f rest_view_vertices[N];                                             \
+        v4f rest_screen_vertices[N];                                           \
+        vertex_transform_lanes##N(rest_xs, rest_ys, rest_zs, view_matrix,      \
+                                      camera, viewport, rest_view_vertices,    \
+                                      rest_screen_vertices);                   \
+        memcpy(&view_vertices[i], rest_view_vertices,                          \
+               rest * sizeof(*view_vertices));                                 \
+        memcpy(&screen_vertices[i], rest_screen_vertices,                      \
+               rest * sizeof(*screen_vertices));                               \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+DEFINE_VERTEX_TRANSFORM_SOA(8)
+#endif
+#if defined(__SSE2__) || defined(__wasm_simd128__)
+DEFINE_VERTEX_TRANSFORM_SOA(4)
+#endif
+DEFINE_VERTEX_TRANSFORM_SOA(1)
+
+bool vertex_transform_is_supported(const VertexTransformVariant variant) {
+    switch (variant) {
+        case VERTEX_TRANSFORM_SCALAR:
+            return true;
+        case VERTEX_TRANSFORM_SIMD128:
+#if defined(__SSE2__) || defined(__wasm_simd128__)
+            return true;
+#else
+            return false;
+#endif
+        case VERTEX_TRANSFORM_AVX2:
+#if defined(__AVX2__)
+            return true;
+#elif defined(__x86_64__) || defined(__i386__)
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case VERTEX_TRANSFORM_VARIANT_COUNT:
+            break;
+    }
+    assert(false && "invalid vertex transform variant");
+    return false;
+}
+
+void vertex_transform_soa_with(
+    const VertexTransformVariant variant, const float *const restrict xs,
+    const float *const restrict ys, const float *const restrict zs,
+    const size_t length, const m4f view_matrix,
+    const Camera *const restrict camera,
+    const Viewport *const restrict viewport, v4f *const restrict view_vertices,
+    v4f *const restrict screen_vertices) {
+    assert(vertex_transform_is_supported(variant));
+    assert(xs != NULL);
+    assert(ys != NULL);
+    assert(zs != NULL);
+    assert(view_matrix != NULL);
+    // Without projection, the w coordinate is the same for all the vertices
+    // and mul_m4f_v3f() doesn't divide by it.
+    assert(view_matrix[12] == 0.0f && view_matrix[13] == 0.0f &&
+           view_matrix[14] == 0.0f);
+    assert(view_matrix[15] == 0.0f || view_matrix[15] == 1.0f);
+    assert(camera != NULL);
+    assert(viewport != NULL);
+    assert(view_vertices != NULL);
+    assert(screen_vertices != NULL);
+
+    switch (variant) {
+#if defined(__x86_64__) || defined(__i386__)
+        case VERTEX_TRANSFORM_AVX2:
+            vertex_transform_soa8(xs, ys, zs, length, view_matrix, camera,
+                                  viewport, view_vertices, screen_vertices);
+            return;
+#endif
+#if defined(__SSE2__) || defined(__wasm_simd128__)
+        case VERTEX_TRANSFORM_SIMD128:
+            vertex_transform_soa4(xs, ys, zs, length, view_matrix, camera,
+                                  viewport, view_vertices, screen_vertices);
+            return;
+#endif
+        default:
+            vertex_transform_soa1(xs, ys, zs, length, view_matrix, camera,
+                                  viewport, view_vertices, screen_vertices);
+            return;
+    }
+}
+
+void vertex_transform_soa(const float *const restrict xs,
+                          const float *const restrict ys,
+                          const float *const restrict zs, const size_t length,
+                          const m4f view_matrix,
+                          const Camera *const restrict camera,
+                          const Viewport *const restrict viewport,
+                          v4f *const restrict view_vertices,
+                          v4f *const restrict screen_vertices) {
+    VertexTransformVariant variant = VERTEX_TRANSFORM_VARIANT_COUNT - 1;
+    while (!vertex_transform_is_supported(variant)) --variant;
+    vertex_transform_soa_with(variant, xs, ys, zs, length, view_matrix, camera,
+                              viewport, view_vertices, screen_vertices);
+}
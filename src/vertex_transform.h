@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "camera_defs.h"
+#include "vec_defs.h"
+#include "viewport_defs.h"
+
+// Project a vertex in camera space into the viewport, the z coordinate is the
+// normalized depth and the w coordinate the depth in camera space.
+[[gnu::nonnull]]
+v4f vertex_transform_project(const v3f vertex,
+                             const Camera *const restrict camera,
+                             const Viewport *const restrict viewport);
+
+// The implementations of vertex_transform_soa(), from the narrowest vectors to
+// the widest.
+typedef enum : uint8_t {
+    VERTEX_TRANSFORM_SCALAR,
+    VERTEX_TRANSFORM_SIMD128,  // SSE2 or WebAssembly SIMD
+    VERTEX_TRANSFORM_AVX2,
+    VERTEX_TRANSFORM_VARIANT_COUNT,
+} VertexTransformVariant;
+
+// Whether the variant is built and the CPU can run it.
+bool vertex_transform_is_supported(const VertexTransformVariant variant);
+
+// Transform the vertices given as structure of arrays in world space, with
+// several vertices at a time when SIMD is available. view_vertices receives
+// them in camera space and screen_vertices their projection like
+// vertex_transform_project(). The view matrix must not project, like the one of
+// camera_get_view_matrix(). The projection of the vertices behind the camera is
+// meaningless, they must be clipped. The widest supported variant is used.
+[[gnu::nonnull]]
+void vertex_transform_soa(const float *const restrict xs,
+                          const float *const restrict ys,
+                          const float *const restrict zs, const size_t length,
+                          const m4f view_matrix,
+                          const Camera *const restrict camera,
+                          const Viewport *const restrict viewport,
+                          v4f *const restrict view_vertices,
+                          v4f *const restrict screen_vertices);
+
+// vertex_transform_soa() with the given variant, which must be supported.
+[[gnu::nonnull]]
+void vertex_transform_soa_with(
+    const VertexTransformVariant variant, const float *const restrict xs,
+    const float *const restrict ys, const float *const restrict zs,
+    const size_t length, const m4f view_matrix,
+    const Camera *const restrict camera,
+    const Viewport *const restrict viewport, v4f *const restrict view_vertices,
+    v4f *const restrict screen_vertices);
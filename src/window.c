@@ -17,7 +17,6 @@
 #include "log.h"
 #include "text.h"
 #include "texture.h"
-#include "threads.h"
 #include "utils.h"
 #include "vec.h"
 
@@ -40,6 +39,11 @@
      sizeof(SHOW_CURSOR) - 1 + sizeof(TEXT_BOLD) - 1 +                   \
      CURSOR_POSITION_BUFFER_CAPACITY)
 
+#define WINDOW_PIXELS_SIZE(window_size)                \
+    ((sizeof(*window.depths) + sizeof(*window.chars) + \
+      sizeof(*window.colors)) *                        \
+     (window_size))
+
 #define WINDOW_FD STDOUT_FILENO
 
 #define WRITE(string_literal) \
@@ -48,7 +52,9 @@
 Window window = {
     .width = 0,
     .height = 0,
-    .pixels = NULL,
+    .depths = NULL,
+    .chars = NULL,
+    .colors = NULL,
     .display_buffer = NULL,
     .cursor_position = {0, 0},
     .show_cursor = false,
@@ -57,6 +63,14 @@ Window window = {
 #endif
 };
 
+// The depths plane comes first to keep it aligned, the chars and colors planes
+// follow it in the same allocation.
+static inline void window_set_pixel_planes(const size_t window_size) {
+    assert(window.depths != NULL);
+    window.chars = (char *)(window.depths + window_size);
+    window.colors = (Color *)(window.chars + window_size);
+}
+
 #ifndef __wasm__
 static void window_restore_terminal_attr(void) {
     assert(window.is_init);
@@ -157,13 +171,9 @@ void window_init(const bool force_tty, const bool force_no_tty) {
     log_debugf("window character ratio: %.2f", window.character_ratio);
 
     const size_t window_size = window.width * window.height;
-    window.pixels = malloc_or_exit(sizeof(*window.pixels) * window_size,
+    window.depths = malloc_or_exit(WINDOW_PIXELS_SIZE(window_size),
                                    "failed to create window pixels buffer");
-#ifndef __wasm__
-    for (size_t i = 0; i < window_size; ++i) {
-        pthread_mutex_init(&window.pixels[i].mutex, NULL);
-    }
-#endif
+    window_set_pixel_planes(window_size);
     window.display_buffer = malloc_or_exit(
         DISPLAY_BUFFER_SIZE(
             window.display_buffer, window_size,
@@ -225,13 +235,7 @@ void window_quit(void) {
         exit(EXIT_FAILURE);
     }
 
-#ifndef __wasm__
-    const size_t window_size = window.width * window.height;
-    for (size_t i = 0; i < window_size; ++i) {
-        mutex_destroy(&window.pixels[i].mutex);
-    }
-#endif
-    free(window.pixels);
+    free(window.depths);
     free(window.display_buffer);
 #ifndef NDEBUG
     window.is_init = false;
@@ -249,21 +253,11 @@ static inline void window_detect_resize(void) {
         log_debugf("update window character ratio from %.2f to %.2f",
                    window.character_ratio, character_ratio);
         window.character_ratio = character_ratio;
-#ifndef __wasm__
-        const size_t old_window_size = window.width * window.height;
-        for (size_t i = 0; i < old_window_size; ++i) {
-            mutex_destroy(&window.pixels[i].mutex);
-        }
-#endif
         const size_t new_window_size = width * height;
-        window.pixels = realloc_or_exit(
-            window.pixels, sizeof(*window.pixels) * new_window_size,
+        window.depths = realloc_or_exit(
+            window.depths, WINDOW_PIXELS_SIZE(new_window_size),
             "failed to resize window pixels buffer");
-#ifndef __wasm__
-        for (size_t i = 0; i < new_window_size; ++i) {
-            pthread_mutex_init(&window.pixels[i].mutex, NULL);
-        }
-#endif
+        window_set_pixel_planes(new_window_size);
         window.display_buffer = realloc_or_exit(
             window.display_buffer,
             DISPLAY_BUFFER_SIZE(
@@ -305,22 +299,14 @@ void window_update(void) {
 
 void window_clear(void) {
     assert(window.is_init);
-#ifdef __wasm__
-    const Pixel pixel = {
-        .z = FLT_MAX,
-        .chr = WINDOW_CLEAR_CHAR,
-        .color = WINDOW_CLEAR_COLOR,
-    };
-    Pixel *const pixels = window.pixels;
-#endif
     const size_t window_size = window.width * window.height;
+    float *const restrict depths = window.depths;
+    Color *const restrict colors = window.colors;
     for (size_t i = 0; i < window_size; ++i) {
-#ifndef __wasm__
-        window_set_pixel(i, WINDOW_CLEAR_CHAR, WINDOW_CLEAR_COLOR, FLT_MAX);
-#else
-        pixels[i] = pixel;
-#endif
+        depths[i] = FLT_MAX;
+        colors[i] = WINDOW_CLEAR_COLOR;
     }
+    memset(window.chars, WINDOW_CLEAR_CHAR, window_size);
 }
 
 #define ANSI_ESCAPE(color) "\033[" #color "m"
@@ -355,18 +341,17 @@ void window_flush(void) {
     }
     DISPLAY_BUFFER_APPEND(HIDE_CURSOR);
     DISPLAY_BUFFER_APPEND(MOVE_CURSOR_TOP_LEFT);
-    DISPLAY_BUFFER_APPEND(colors[window.pixels[0].color]);
-    Color last_color = window.pixels[0].color;
+    DISPLAY_BUFFER_APPEND(colors[window.colors[0]]);
+    Color last_color = window.colors[0];
     const size_t window_size = window.width * window.height;
     for (size_t i = 0; i < window_size; ++i) {
-        const Pixel *const pixel = &window.pixels[i];
-        const Color color = pixel->color;
+        const Color color = window.colors[i];
         assert(color < COLOR_COUNT);
         if (color != last_color) {
             DISPLAY_BUFFER_APPEND(colors[color]);
             last_color = color;
         }
-        window.display_buffer[display_buffer_size++] = pixel->chr;
+        window.display_buffer[display_buffer_size++] = window.chars[i];
     }
     if (window.show_cursor) {
         char cursor_position_buffer[CURSOR_POSITION_BUFFER_CAPACITY];
@@ -418,14 +403,15 @@ static inline void window_set_pixel_with_z_check(const int pixel_index,
                                                  const float z) {
     assert(window.is_init);
     assert(0 <= pixel_index && pixel_index < window.width * window.height);
-    mutex_lock(&window.pixels[pixel_index].mutex);
-    if (z < window.pixels[pixel_index].z)
+    if (z < window.depths[pixel_index])
         window_set_pixel(pixel_index, chr, color, z);
-    mutex_unlock(&window.pixels[pixel_index].mutex);
 }
 
-static void window_render_line(v3f v1, v3f v2, const Color color) {
+static void window_render_line(v3f v1, v3f v2, const Color color,
+                               const v2i min, const v2i max) {
     assert(window.is_init);
+    assert(0 <= min.x && max.x <= window.width);
+    assert(0 <= min.y && max.y <= window.height);
 
     const float dxf = v2.x - v1.x;
     const float dyf = v2.y - v1.y;
@@ -433,7 +419,7 @@ static void window_render_line(v3f v1, v3f v2, const Color color) {
     if (dxf == 0.0f && dyf == 0.0f) {
         const int x = (int)v1.x;
         const int y = (int)v1.y;
-        if (0 <= x && x < window.width && 0 <= y && y < window.height) {
+        if (min.x <= x && x < max.x && min.y <= y && y < max.y) {
             const float z = fminf(v1.z, v2.z);
             window_set_pixel_with_z_check(
                 y * window.width + x, '-', color,
@@ -461,9 +447,9 @@ static void window_render_line(v3f v1, v3f v2, const Color color) {
         const float y_step = dyf / dxf;
 
         float yf = v1.y;
-        for (int x = x_start; x <= x_end; ++x) {
+        for (int x = x_start; x <= x_end && x < max.x; ++x) {
             const int y = (int)roundf(yf);
-            if (0 <= x && x < window.width && 0 <= y && y < window.height) {
+            if (min.x <= x && min.y <= y && y < max.y) {
                 const float t = (x - x_start) * inv_dx;
                 const float z = lerp(z1, z2, t);
                 window_set_pixel_with_z_check(
@@ -489,9 +475,9 @@ static void window_render_line(v3f v1, v3f v2, const Color color) {
         const float x_step = dxf / dyf;
 
         float xf = v1.x;
-        for (int y = y_start; y <= y_end; ++y) {
+        for (int y = y_start; y <= y_end && y < max.y; ++y) {
             const int x = (int)roundf(xf);
-            if (0 <= x && x < window.width && 0 <= y && y < window.height) {
+            if (min.y <= y && min.x <= x && x < max.x) {
                 const float t = (y - y_start) * inv_dy;
                 const float z = lerp(z1, z2, t);
                 window_set_pixel_with_z_check(
@@ -510,7 +496,8 @@ static bool edge_is_top_left(const v2f v1, const v2f v2) {
 }
 
 [[gnu::nonnull]]
-static void window_render_triangle_fill(const Triangle3D *const triangle) {
+static void window_render_triangle_fill(const Triangle3D *const triangle,
+                                        const v2i min, const v2i max) {
     assert(window.is_init);
     assert(triangle != NULL);
 
@@ -529,10 +516,10 @@ static void window_render_triangle_fill(const Triangle3D *const triangle) {
     if (area == 0.0f) return;
     const float inv_area = 1.0f / area;
 
-    const int xmin = min3_float(x1, x2, x3);
-    const int ymin = min3_float(y1, y2, y3);
-    const int xmax = min_int(window.width - 1, (int)max3_float(x1, x2, x3));
-    const int ymax = min_int(window.height - 1, (int)max3_float(y1, y2, y3));
+    const int xmin = max_int(min.x, min3_float(x1, x2, x3));
+    const int ymin = max_int(min.y, min3_float(y1, y2, y3));
+    const int xmax = min_int(max.x - 1, (int)max3_float(x1, x2, x3));
+    const int ymax = min_int(max.y - 1, (int)max3_float(y1, y2, y3));
 
     assert(xmin >= 0);
     assert(ymin >= 0);
@@ -579,7 +566,7 @@ static void window_render_triangle_fill(const Triangle3D *const triangle) {
                                 (alpha + beta + gamma);
                 const int pixel_index = row_offset + x;
 
-                if (z < window.pixels[pixel_index].z) {
+                if (z < window.depths[pixel_index]) {
                     Color pixel_color;
                     if (texture != NULL) {
                         const float u =
@@ -612,38 +599,44 @@ static void window_render_triangle_fill(const Triangle3D *const triangle) {
 
     if (triangle->edges & (TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V1_V2_FAR))
         window_render_line(triangle->v1.xyz, triangle->v2.xyz,
-                           MESH_OUTLINE_COLOR);
+                           MESH_OUTLINE_COLOR, min, max);
 
     if (triangle->edges & (TRIANGLE_EDGE_V2_V3 | TRIANGLE_EDGE_V2_V3_FAR))
         window_render_line(triangle->v2.xyz, triangle->v3.xyz,
-                           MESH_OUTLINE_COLOR);
+                           MESH_OUTLINE_COLOR, min, max);
 
     if (triangle->edges & (TRIANGLE_EDGE_V3_V1 | TRIANGLE_EDGE_V3_V1_FAR))
         window_render_line(triangle->v3.xyz, triangle->v1.xyz,
-                           MESH_OUTLINE_COLOR);
+                           MESH_OUTLINE_COLOR, min, max);
 }
 #endif
 
 #ifdef RENDER_WIREFRAME
 [[gnu::nonnull]]
 static inline void window_render_triangle_wireframe(
-    const Triangle3D *const triangle) {
+    const Triangle3D *const triangle, const v2i min, const v2i max) {
     assert(window.is_init);
     assert(triangle != NULL);
-    window_render_line(triangle->v1.xyz, triangle->v2.xyz, triangle->color);
-    window_render_line(triangle->v2.xyz, triangle->v3.xyz, triangle->color);
-    window_render_line(triangle->v3.xyz, triangle->v1.xyz, triangle->color);
+    window_render_line(triangle->v1.xyz, triangle->v2.xyz, triangle->color,
+                       min, max);
+    window_render_line(triangle->v2.xyz, triangle->v3.xyz, triangle->color,
+                       min, max);
+    window_render_line(triangle->v3.xyz, triangle->v1.xyz, triangle->color,
+                       min, max);
 }
 #endif
 
-void window_render_triangle(const Triangle3D *const triangle) {
+void window_render_triangle(const Triangle3D *const triangle, const v2i min,
+                            const v2i max) {
     assert(window.is_init);
     assert(triangle != NULL);
+    assert(0 <= min.x && min.x <= max.x && max.x <= window.width);
+    assert(0 <= min.y && min.y <= max.y && max.y <= window.height);
 
 #ifndef RENDER_WIREFRAME
-    window_render_triangle_fill(triangle);
+    window_render_triangle_fill(triangle, min, max);
 #else
-    window_render_triangle_wireframe(triangle);
+    window_render_triangle_wireframe(triangle, min, max);
 #endif
 }
 
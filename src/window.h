@@ -3,7 +3,6 @@
 #include <assert.h>
 #include <stdbool.h>
 #ifndef __wasm__
-#include <pthread.h>
 #include <termios.h>
 #endif
 
@@ -12,18 +11,13 @@
 
 #define WINDOW_Z_BUFFER_FRONT -1.0f
 
-typedef struct {
-#ifndef __wasm__
-    pthread_mutex_t mutex;
-#endif
-    float z;
-    char chr;
-    Color color;
-} Pixel;
-
 typedef struct {
     int width, height;
-    Pixel *pixels;
+    // The pixels are stored as planes sharing one allocation, so the depth test
+    // only touches the depths and the clear is a plain fill of each plane.
+    float *depths;
+    char *chars;
+    Color *colors;
     char *display_buffer;
     v2i cursor_position;
     float character_ratio;
@@ -48,8 +42,11 @@ void window_flush(void);
 void window_render_rectangle(const v2i position, const v2i size, const char chr,
                              const Color color, const float z);
 
+// Draw the part of the triangle, in screen space, inside the rectangle from min
+// included to max excluded.
 [[gnu::nonnull]]
-void window_render_triangle(const Triangle3D *const triangle);
+void window_render_triangle(const Triangle3D *const triangle, const v2i min,
+                            const v2i max);
 
 [[gnu::nonnull(2)]]
 void window_render_string(const v2i position, const char *const string,
@@ -59,7 +56,7 @@ static inline void window_set_pixel(const int pixel_index, const char chr,
                                     const Color color, const float z) {
     assert(window.is_init);
     assert(0 <= pixel_index && pixel_index < window.width * window.height);
-    window.pixels[pixel_index].chr = chr;
-    window.pixels[pixel_index].color = color;
-    window.pixels[pixel_index].z = z;
+    window.depths[pixel_index] = z;
+    window.chars[pixel_index] = chr;
+    window.colors[pixel_index] = color;
 }
@@ -3,732 +3,174 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdlib.h>
-#include <string.h>
 
 // #define LOG_LEVEL_ERROR
 #include "camera.h"
+#include "chunk.h"
+#include "chunk_array.h"
+#include "chunk_generator.h"
+#include "chunk_map.h"
+#include "chunk_mesh.h"
+#include "chunk_mesher.h"
+#include "chunk_pool.h"
+#ifndef __wasm__
+#include "chunk_storage.h"
+#endif
+#include "collision.h"
+#include "frame_arena.h"
 #include "log.h"
-#include "mesh.h"
-#include "perlin_noise.h"
-#include "textures.h"
+#include "render_tiles.h"
 #include "threads.h"
-#include "triangle_index_array.h"
 #include "utils.h"
-#include "v3f_array.h"
 #include "vec.h"
 
-#define WORLD_ORIGIN (WORLD_SIZE / 2)
+static inline ChunkMeshKind world_get_chunk_mesh_kind(
+    const float distance_squared) {
+    if (distance_squared <
+        MESH_GREEDY_MIN_DISTANCE * MESH_GREEDY_MIN_DISTANCE) {
+        return CHUNK_MESH_DETAILED;
+    }
+    if (distance_squared < MESH_LOD_MIN_DISTANCE * MESH_LOD_MIN_DISTANCE) {
+        return CHUNK_MESH_GREEDY;
+    }
 
-#define vertex_indices_index(x, y, z)                                         \
-    ((x) * ((CHUNK_HEIGHT + 1) * (CHUNK_SIZE + 1)) + (y) * (CHUNK_SIZE + 1) + \
-     (z))
+    uint8_t level = 0;
+    float next_level_distance = MESH_LOD_MIN_DISTANCE * 2.0f;
+    while (level < MESH_LOD_LEVELS_NUMBER - 1 &&
+           distance_squared >= next_level_distance * next_level_distance) {
+        ++level;
+        next_level_distance *= 2.0f;
+    }
+    return CHUNK_MESH_LOD(level);
+}
 
-[[gnu::nonnull(1, 2, 3)]]
-static int chunk_get_vertex_index(const Chunk *const restrict self,
-                                  Mesh *const restrict mesh,
-                                  int *vertex_indices, const uint8_t x,
-                                  const uint8_t y, const uint8_t z) {
-    assert(self != NULL);
-    assert(mesh != NULL);
-    assert(vertex_indices != NULL);
-
-    if (vertex_indices[vertex_indices_index(x, y, z)] != -1)
-        return vertex_indices[vertex_indices_index(x, y, z)];
-
-    const size_t i = v3f_array_grow(&mesh->vertices);
-    mesh->vertices.array[i].x = self->x * CHUNK_SIZE + x;
-    mesh->vertices.array[i].y = y;
-    mesh->vertices.array[i].z = self->z * CHUNK_SIZE + z;
-    vertex_indices[vertex_indices_index(x, y, z)] = i;
-    return i;
+// Until the wanted kind of mesh is built, the built kind nearest in level of
+// detail is drawn, the more detailed one first.
+static inline ChunkMeshKind world_get_drawn_chunk_mesh_kind(
+    const ChunkMeshKind built_meshes, const ChunkMeshKind kind) {
+    for (uint8_t shift = 0; shift < MESH_LOD_LEVELS_NUMBER + 2; ++shift) {
+        const ChunkMeshKind finer = kind >> shift;
+        if (built_meshes & finer) return finer;
+        const ChunkMeshKind coarser = (kind << shift) & CHUNK_MESH_ALL;
+        if (built_meshes & coarser) return coarser;
+    }
+    return 0;
 }
 
 [[gnu::nonnull]]
-static inline void chunk_generate_mesh(Chunk *const restrict self,
-                                       const World *const restrict world) {
+static void chunk_render(Chunk *const restrict self,
+                         const Camera *const restrict camera,
+                         ChunkMesher *const restrict mesher,
+                         RenderTiles *const restrict tiles,
+                         const size_t thread_index) {
     assert(self != NULL);
-    assert(world != NULL);
-
-    static const Color block_top_colors[] = {
-#define BLOCK(name, name_string, top_color, ...) top_color,
-        BLOCKS
-#undef BLOCK
-    };
-
-    static const Color block_side_colors[] = {
-#define BLOCK(name, name_string, top_color, side_color, ...) side_color,
-        BLOCKS
-#undef BLOCK
-    };
-
-    static const Color block_bottom_colors[] = {
-#define BLOCK(name, name_string, top_color, side_color, bottom_color, ...) \
-    bottom_color,
-        BLOCKS
-#undef BLOCK
-    };
-
-    static const Texture *const block_top_textures[] = {
-#define BLOCK(name, name_string, top_color, _side_color, _bottom_color, \
-              top_texture, ...)                                         \
-    top_texture,
-        BLOCKS
-#undef BLOCK
-    };
-
-    static const Texture *const block_side_textures[] = {
-#define BLOCK(name, name_string, top_color, _side_color, _bottom_color, \
-              top_texture, side_texture, ...)                           \
-    side_texture,
-        BLOCKS
-#undef BLOCK
-    };
-
-    static const Texture *const block_bottom_textures[] = {
-#define BLOCK(name, name_string, top_color, _side_color, _bottom_color, \
-              top_texture, side_texture, bottom_texture)                \
-    bottom_texture,
-        BLOCKS
-#undef BLOCK
-    };
-
-#if !defined(PROD) && !defined(LOG_LEVEL_ERROR)
-    const uint64_t start = get_time_microseconds();
-#endif
+    assert(camera != NULL);
+    assert(mesher != NULL);
+    assert(tiles != NULL);
 
-    mesh_clear(&self->mesh);
+    if (self->pending) return;
 
-    int vertex_indices[(CHUNK_SIZE + 1) * (CHUNK_HEIGHT + 1) *
-                       (CHUNK_SIZE + 1)];
+    if (!camera_aabb_in_frustum(camera, &self->aabb, NULL)) return;
 
-    for (int x = 0; x <= CHUNK_SIZE; ++x) {
-        for (int y = 0; y <= CHUNK_HEIGHT; ++y) {
-            for (int z = 0; z <= CHUNK_SIZE; ++z) {
-                vertex_indices[vertex_indices_index(x, y, z)] = -1;
-            }
-        }
+    const float distance_squared =
+        aabb_get_distance_squared(&self->aabb, camera->position);
+    ChunkMeshKind kind = world_get_chunk_mesh_kind(distance_squared);
+    if (kind == CHUNK_MESH_GREEDY && self->greedy_mesh_overflows) {
+        kind = CHUNK_MESH_DETAILED;
+    }
+    if (self->stale_meshes & kind) {
+        chunk_mesher_request(mesher, self, kind, distance_squared);
     }
 
-    const Chunk *const front_chunk =
-        world_get_chunk(world, self->x, self->z - 1);
-    const Chunk *const back_chunk =
-        world_get_chunk(world, self->x, self->z + 1);
-    const Chunk *const left_chunk =
-        world_get_chunk(world, self->x - 1, self->z);
-    const Chunk *const right_chunk =
-        world_get_chunk(world, self->x + 1, self->z);
-
-    const Chunk *const front_left_chunk =
-        world_get_chunk(world, self->x - 1, self->z - 1);
-    const Chunk *const front_right_chunk =
-        world_get_chunk(world, self->x + 1, self->z - 1);
-    const Chunk *const back_left_chunk =
-        world_get_chunk(world, self->x - 1, self->z + 1);
-    const Chunk *const back_right_chunk =
-        world_get_chunk(world, self->x + 1, self->z + 1);
-
-    for (int x = 0; x < CHUNK_SIZE; ++x) {
-        for (int y = 0; y < CHUNK_HEIGHT; ++y) {
-            for (int z = 0; z < CHUNK_SIZE; ++z) {
-                if (self->blocks[x][y][z].type == BLOCK_TYPE_AIR) continue;
-
-                const Color side_color =
-                    block_side_colors[self->blocks[x][y][z].type];
-                const Texture *const side_texture =
-                    block_side_textures[self->blocks[x][y][z].type];
-
-                const bool is_front_face_visible =
-                    (z == 0 && front_chunk != NULL &&
-                     !front_chunk->blocks[x][y][CHUNK_SIZE - 1].type) ||
-                    (z != 0 && !self->blocks[x][y][z - 1].type);
-
-                const bool is_back_face_visible =
-                    (z == CHUNK_SIZE - 1 && back_chunk != NULL &&
-                     !back_chunk->blocks[x][y][0].type) ||
-                    (z != CHUNK_SIZE - 1 && !self->blocks[x][y][z + 1].type);
-
-                const bool is_left_face_visible =
-                    (x == 0 && left_chunk != NULL &&
-                     !left_chunk->blocks[CHUNK_SIZE - 1][y][z].type) ||
-                    (x != 0 && !self->blocks[x - 1][y][z].type);
-
-                const bool is_right_face_visible =
-                    (x == CHUNK_SIZE - 1 && right_chunk != NULL &&
-                     !right_chunk->blocks[0][y][z].type) ||
-                    (x != CHUNK_SIZE - 1 && !self->blocks[x + 1][y][z].type);
-
-                const bool block_front_left =
-                    (z == 0 && x == 0 && front_left_chunk != NULL &&
-                     front_left_chunk->blocks[CHUNK_SIZE - 1][y][CHUNK_SIZE - 1]
-                         .type) ||
-                    (z == 0 && x != 0 && front_chunk != NULL &&
-                     front_chunk->blocks[x - 1][y][CHUNK_SIZE - 1].type) ||
-                    (z != 0 && x == 0 && left_chunk != NULL &&
-                     left_chunk->blocks[CHUNK_SIZE - 1][y][z - 1].type) ||
-                    (z != 0 && x != 0 && self->blocks[x - 1][y][z - 1].type);
-
-                const bool block_front_right =
-                    (z == 0 && x == CHUNK_SIZE - 1 &&
-                     front_right_chunk != NULL &&
-                     front_right_chunk->blocks[0][y][CHUNK_SIZE - 1].type) ||
-                    (z == 0 && x != CHUNK_SIZE - 1 && front_chunk != NULL &&
-                     front_chunk->blocks[x + 1][y][CHUNK_SIZE - 1].type) ||
-                    (z != 0 && x == CHUNK_SIZE - 1 && right_chunk != NULL &&
-                     right_chunk->blocks[0][y][z - 1].type) ||
-                    (z != 0 && x != CHUNK_SIZE - 1 &&
-                     self->blocks[x + 1][y][z - 1].type);
-
-                const bool block_back_left =
-                    (z == CHUNK_SIZE - 1 && x == 0 && back_left_chunk != NULL &&
-                     back_left_chunk->blocks[CHUNK_SIZE - 1][y][0].type) ||
-                    (z == CHUNK_SIZE - 1 && x != 0 && back_chunk != NULL &&
-                     back_chunk->blocks[x - 1][y][0].type) ||
-                    (z != CHUNK_SIZE - 1 && x == 0 && left_chunk != NULL &&
-                     left_chunk->blocks[CHUNK_SIZE - 1][y][z + 1].type) ||
-                    (z != CHUNK_SIZE - 1 && x != 0 &&
-                     self->blocks[x - 1][y][z + 1].type);
-
-                const bool block_back_right =
-                    (z == CHUNK_SIZE - 1 && x == CHUNK_SIZE - 1 &&
-                     back_right_chunk != NULL &&
-                     back_right_chunk->blocks[0][y][0].type) ||
-                    (z == CHUNK_SIZE - 1 && x != CHUNK_SIZE - 1 &&
-                     back_chunk != NULL &&
-                     back_chunk->blocks[x + 1][y][0].type) ||
-                    (z != CHUNK_SIZE - 1 && x == CHUNK_SIZE - 1 &&
-                     right_chunk != NULL &&
-                     right_chunk->blocks[0][y][z + 1].type) ||
-                    (z != CHUNK_SIZE - 1 && x != CHUNK_SIZE - 1 &&
-                     self->blocks[x + 1][y][z + 1].type);
-
-                const bool block_top_front =
-                    y != CHUNK_HEIGHT - 1 &&
-                    ((z == 0 && front_chunk != NULL &&
-                      front_chunk->blocks[x][y + 1][CHUNK_SIZE - 1].type) ||
-                     (z != 0 && self->blocks[x][y + 1][z - 1].type));
-
-                const bool block_top_back =
-                    y != CHUNK_HEIGHT - 1 &&
-                    ((z == CHUNK_SIZE - 1 && back_chunk != NULL &&
-                      back_chunk->blocks[x][y + 1][0].type) ||
-                     (z != CHUNK_SIZE - 1 &&
-                      self->blocks[x][y + 1][z + 1].type));
-
-                const bool block_top_left =
-                    y != CHUNK_HEIGHT - 1 &&
-                    ((x == 0 && left_chunk != NULL &&
-                      left_chunk->blocks[CHUNK_SIZE - 1][y + 1][z].type) ||
-                     (x != 0 && self->blocks[x - 1][y + 1][z].type));
-
-                const bool block_top_right =
-                    y != CHUNK_HEIGHT - 1 &&
-                    ((x == CHUNK_SIZE - 1 && right_chunk != NULL &&
-                      right_chunk->blocks[0][y + 1][z].type) ||
-                     (x != CHUNK_SIZE - 1 &&
-                      self->blocks[x + 1][y + 1][z].type));
-
-                const bool block_bottom_front =
-                    y != 0 &&
-                    ((z == 0 && front_chunk != NULL &&
-                      front_chunk->blocks[x][y - 1][CHUNK_SIZE - 1].type) ||
-                     (z != 0 && self->blocks[x][y - 1][z - 1].type));
-
-                const bool block_bottom_back =
-                    y != 0 && ((z == CHUNK_SIZE - 1 && back_chunk != NULL &&
-                                back_chunk->blocks[x][y - 1][0].type) ||
-                               (z != CHUNK_SIZE - 1 &&
-                                self->blocks[x][y - 1][z + 1].type));
-
-                const bool block_bottom_left =
-                    y != 0 &&
-                    ((x == 0 && left_chunk != NULL &&
-                      left_chunk->blocks[CHUNK_SIZE - 1][y - 1][z].type) ||
-                     (x != 0 && self->blocks[x - 1][y - 1][z].type));
-
-                const bool block_bottom_right =
-                    y != 0 && ((x == CHUNK_SIZE - 1 && right_chunk != NULL &&
-                                right_chunk->blocks[0][y - 1][z].type) ||
-                               (x != CHUNK_SIZE - 1 &&
-                                self->blocks[x + 1][y - 1][z].type));
-
-                size_t i;
-                TriangleIndex *triangle;
-                if (is_front_face_visible) {
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z);
-                    triangle->uv1 = (v2f){0.0f, 1.0f};
-                    triangle->uv2 = (v2f){0.0f, 0.0f};
-                    triangle->uv3 = (v2f){1.0f, 0.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = side_texture;
-                    triangle->color = side_color;
-
-                    if (is_left_face_visible || block_front_left) {
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-                    }
-
-                    if ((y == CHUNK_HEIGHT - 1 ||
-                         !self->blocks[x][y + 1][z].type) ||
-                        block_top_front)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z);
-                    triangle->uv1 = (v2f){1.0f, 0.0f};
-                    triangle->uv2 = (v2f){1.0f, 1.0f};
-                    triangle->uv3 = (v2f){0.0f, 1.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = side_texture;
-                    triangle->color = side_color;
-
-                    if (is_right_face_visible || block_front_right)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if ((y == 0 || !self->blocks[x][y - 1][z].type) ||
-                        block_bottom_front)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-                }
-
-                if (is_right_face_visible) {
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z + 1);
-                    triangle->uv1 = (v2f){0.0f, 1.0f};
-                    triangle->uv2 = (v2f){0.0f, 0.0f};
-                    triangle->uv3 = (v2f){1.0f, 0.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = side_texture;
-                    triangle->color = side_color;
-
-                    if (is_front_face_visible || block_front_right)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if ((y == CHUNK_HEIGHT - 1 ||
-                         !self->blocks[x][y + 1][z].type) ||
-                        block_top_right)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z + 1);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z + 1);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z);
-                    triangle->uv1 = (v2f){1.0f, 0.0f};
-                    triangle->uv2 = (v2f){1.0f, 1.0f};
-                    triangle->uv3 = (v2f){0.0f, 1.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = side_texture;
-                    triangle->color = side_color;
-
-                    if (is_back_face_visible || block_back_right)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if ((y == 0 || !self->blocks[x][y - 1][z].type) ||
-                        block_bottom_right)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-                }
-
-                if (is_back_face_visible) {
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z + 1);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z + 1);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z + 1);
-                    triangle->uv1 = (v2f){0.0f, 1.0f};
-                    triangle->uv2 = (v2f){0.0f, 0.0f};
-                    triangle->uv3 = (v2f){1.0f, 0.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = side_texture;
-                    triangle->color = side_color;
-
-                    if (is_right_face_visible || block_back_right)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if ((y == CHUNK_HEIGHT - 1 ||
-                         !self->blocks[x][y + 1][z].type) ||
-                        block_top_back)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z + 1);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z + 1);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z + 1);
-                    triangle->uv1 = (v2f){1.0f, 0.0f};
-                    triangle->uv2 = (v2f){1.0f, 1.0f};
-                    triangle->uv3 = (v2f){0.0f, 1.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = side_texture;
-                    triangle->color = side_color;
-
-                    if (is_left_face_visible || block_back_left)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if ((y == 0 || !self->blocks[x][y - 1][z].type) ||
-                        block_bottom_back)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-                }
-
-                if (is_left_face_visible) {
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z + 1);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z + 1);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z);
-                    triangle->uv1 = (v2f){0.0f, 1.0f};
-                    triangle->uv2 = (v2f){0.0f, 0.0f};
-                    triangle->uv3 = (v2f){1.0f, 0.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = side_texture;
-                    triangle->color = side_color;
-
-                    if (is_back_face_visible || block_back_left)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if ((y == CHUNK_HEIGHT - 1 ||
-                         !self->blocks[x][y + 1][z].type) ||
-                        block_top_left)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z + 1);
-                    triangle->uv1 = (v2f){1.0f, 0.0f};
-                    triangle->uv2 = (v2f){1.0f, 1.0f};
-                    triangle->uv3 = (v2f){0.0f, 1.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = side_texture;
-                    triangle->color = side_color;
-
-                    if (is_front_face_visible || block_front_left)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if ((y == 0 || !self->blocks[x][y - 1][z].type) ||
-                        block_bottom_left)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-                }
+    const ChunkMeshKind drawn_kind =
+        world_get_drawn_chunk_mesh_kind(self->built_meshes, kind);
+    if (drawn_kind == 0) return;
 
-                // top face
-                if (y == CHUNK_HEIGHT - 1 || !self->blocks[x][y + 1][z].type) {
-                    const Texture *const top_texture =
-                        block_top_textures[self->blocks[x][y][z].type];
-                    const Color top_color =
-                        block_top_colors[self->blocks[x][y][z].type];
-
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z + 1);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z + 1);
-                    triangle->uv1 = (v2f){0.0f, 1.0f};
-                    triangle->uv2 = (v2f){0.0f, 0.0f};
-                    triangle->uv3 = (v2f){1.0f, 0.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = top_texture;
-                    triangle->color = top_color;
-
-                    if (is_left_face_visible || block_top_left)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if (is_back_face_visible || block_top_back)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z + 1);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y + 1, z);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y + 1, z);
-                    triangle->uv1 = (v2f){1.0f, 0.0f};
-                    triangle->uv2 = (v2f){1.0f, 1.0f};
-                    triangle->uv3 = (v2f){0.0f, 1.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = top_texture;
-                    triangle->color = top_color;
-
-                    if (is_right_face_visible || block_top_right)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if (is_front_face_visible || block_top_front)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-                }
+    render_tiles_begin_chunk(tiles, thread_index, camera, &self->aabb,
+                             distance_squared);
 
-                // bottom face
-                if (y > 0 && !self->blocks[x][y - 1][z].type) {
-                    const Texture *const bottom_texture =
-                        block_bottom_textures[self->blocks[x][y][z].type];
-                    const Color bottom_color =
-                        block_bottom_colors[self->blocks[x][y][z].type];
-
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z + 1);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z);
-                    triangle->uv1 = (v2f){0.0f, 1.0f};
-                    triangle->uv2 = (v2f){0.0f, 0.0f};
-                    triangle->uv3 = (v2f){1.0f, 0.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = bottom_texture;
-                    triangle->color = bottom_color;
-
-                    if (is_left_face_visible || block_bottom_left)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if (is_front_face_visible || block_bottom_front)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-
-                    i = triangle_index_array_grow(&self->mesh.triangles);
-                    triangle = &self->mesh.triangles.array[i];
-                    triangle->v1 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z);
-                    triangle->v2 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x + 1, y, z + 1);
-                    triangle->v3 = chunk_get_vertex_index(
-                        self, &self->mesh, vertex_indices, x, y, z + 1);
-                    triangle->uv1 = (v2f){1.0f, 0.0f};
-                    triangle->uv2 = (v2f){1.0f, 1.0f};
-                    triangle->uv3 = (v2f){0.0f, 1.0f};
-                    triangle->edges = TRIANGLE_EDGE_V1_V2 | TRIANGLE_EDGE_V2_V3;
-                    triangle->texture = bottom_texture;
-                    triangle->color = bottom_color;
-
-                    if (is_right_face_visible || block_bottom_right)
-                        triangle->edges |= TRIANGLE_EDGE_V1_V2_FAR;
-
-                    if (is_back_face_visible || block_bottom_back)
-                        triangle->edges |= TRIANGLE_EDGE_V2_V3_FAR;
-                }
-            }
-        }
+    const uint32_t front =
+        atomic_load_explicit(&self->front_meshes, memory_order_acquire);
+    if (drawn_kind == CHUNK_MESH_GREEDY) {
+        chunk_mesh_render(
+            &self->greedy_meshes[front >> CHUNK_GREEDY_MESH_BIT & 1], self->x,
+            self->z, camera, tiles, thread_index);
+        return;
+    }
+    if (drawn_kind != CHUNK_MESH_DETAILED) {
+        const uint8_t level = __builtin_ctz(drawn_kind) - 2;
+        chunk_mesh_render(
+            &self->lod_meshes[front >> CHUNK_LOD_MESH_BIT(level) & 1][level],
+            self->x, self->z, camera, tiles, thread_index);
+        return;
     }
-    self->mesh_dirty = false;
 
-    log_debugf("generated mesh for chunk (%d, %d) in %f ms", self->x, self->z,
-               (get_time_microseconds() - start) / 1000.0f);
+    for (uint8_t i = 0; i < CHUNK_SECTIONS_NUMBER; ++i) {
+        const ChunkMesh *const mesh = &self->meshes[front >> i & 1][i];
+        if (mesh->triangles.length == 0) continue;
+        chunk_mesh_render(mesh, self->x, self->z, camera, tiles, thread_index);
+    }
 }
 
 [[gnu::nonnull]]
-static void chunck_update_aabb(Chunk *const self) {
-    assert(self != NULL);
-    self->aabb.position.y = -1.0f;
-    self->aabb.size.y = -1.0f;
-    for (int y = 0; y < CHUNK_HEIGHT; ++y) {
-        for (int x = 0; x < CHUNK_SIZE; ++x) {
-            for (int z = 0; z < CHUNK_SIZE; ++z) {
-                if (self->blocks[x][y][z].type != BLOCK_TYPE_AIR) {
-                    self->aabb.position.y = y;
-                    goto end_loop;
-                }
-            }
-        }
-    }
-end_loop:
-    for (int y = CHUNK_HEIGHT - 1; y >= 0; --y) {
-        for (int x = 0; x < CHUNK_SIZE; ++x) {
-            for (int z = 0; z < CHUNK_SIZE; ++z) {
-                if (self->blocks[x][y][z].type != BLOCK_TYPE_AIR) {
-                    self->aabb.size.y = y + 1.0f - self->aabb.position.y;
-                    return;
-                }
-            }
-        }
-    }
+static void
+world_set_occluded_numbers(WorldView *const restrict view,
+                           const RenderTiles *const restrict tiles) {
+    assert(view != NULL);
+    assert(tiles != NULL);
+
+    atomic_store_explicit(&view->occluded_chunks_number,
+                          render_tiles_get_occluded_chunks_number(tiles),
+                          memory_order_relaxed);
+    atomic_store_explicit(
+        &view->occluded_triangles_number,
+        atomic_load_explicit(&tiles->occluded_triangles_number,
+                             memory_order_relaxed),
+        memory_order_relaxed);
 }
 
-[[gnu::returns_nonnull]]
-static Chunk *chunk_create(const int x, const int z, const uint32_t seed,
-                           const int8_t player_index) {
-    assert(0 <= player_index && player_index < 4);
-    log_debugf("load chunk (%d, %d)", x, z);
-    Chunk *const self = malloc_or_exit(sizeof(*self), "failed to create chunk");
-
-    self->x = x;
-    self->z = z;
-    self->aabb.position = (v3f){x * CHUNK_SIZE, 0.0f, z * CHUNK_SIZE};
-    self->aabb.size = (v3f){CHUNK_SIZE, 0.0f, CHUNK_SIZE};
-
-#ifndef __wasm__
-    pthread_mutex_init(&self->mesh_mutex, NULL);
-#endif
-
-    for (uint8_t i = 0; i < 4; ++i) {
-        self->loaded_by[i] = false;
-    }
-    self->loaded_by[player_index] = true;
-
-    const v2i chunk_origin = {
-        .x = (WORLD_ORIGIN + self->x) * CHUNK_SIZE,
-        .y = (WORLD_ORIGIN + self->z) * CHUNK_SIZE,
-    };
-
-    for (int x = 0; x < CHUNK_SIZE; ++x) {
-        for (int z = 0; z < CHUNK_SIZE; ++z) {
-            const v2i block_coordinate = v2i_add(chunk_origin, (v2i){x, z});
-
-            const float terrain_height_noise = powf(
-                perlin_noise(block_coordinate, seed,
-                             CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_FREQUENCY,
-                             CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_DEPTH),
-                CHUNK_GENERATION_TERRAIN_HEIGHT_NOISE_POW);
-            assert(0.0f <= terrain_height_noise);
-            assert(terrain_height_noise <= 1.0f);
-
-            const float desert_noise =
-                perlin_noise(block_coordinate, seed + 1,
-                             CHUNK_GENERATION_DESERT_NOISE_FREQUENCY,
-                             CHUNK_GENERATION_DESERT_NOISE_DEPTH);
-            assert(0.0f <= desert_noise);
-            assert(desert_noise <= 1.0f);
-
-            const float surface_layer_thickness_noise =
-                perlin_noise(block_coordinate, seed + 2,
-                             CHUNK_GENERATION_SURFACE_LAYER_NOISE_FREQUENCY,
-                             CHUNK_GENERATION_SURFACE_LAYER_NOISE_DEPTH);
-            assert(0.0f <= surface_layer_thickness_noise &&
-                   surface_layer_thickness_noise <= 1.0f);
-
-            const float min_snow_min_height_variation_noise =
-                perlin_noise(block_coordinate, seed + 3,
-                             CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_FREQUENCY,
-                             CHUNK_GENERATION_MIN_SNOW_HEIGHT_NOISE_DEPTH);
-            assert(0.0f <= min_snow_min_height_variation_noise);
-            assert(min_snow_min_height_variation_noise <= 1.0f);
-
-            int max_y =
-                terrain_height_noise * (CHUNK_GENERATION_MAX_TERRAIN_HEIGHT -
-                                        CHUNK_GENERATION_MIN_TERRAIN_HEIGHT) +
-                CHUNK_GENERATION_MIN_TERRAIN_HEIGHT;
-
-            const int surface_layer_thickness =
-                surface_layer_thickness_noise *
-                    (CHUNK_GENERATION_SURFACE_LAYER_MAX_THICKNESS -
-                     CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS) +
-                CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS;
-            assert(CHUNK_GENERATION_SURFACE_LAYER_MIN_THICKNESS <=
-                   surface_layer_thickness);
-            assert(surface_layer_thickness <=
-                   CHUNK_GENERATION_SURFACE_LAYER_MAX_THICKNESS);
-
-            const int max_stone_y = max_y - surface_layer_thickness;
-
-            const bool is_desert =
-                desert_noise > CHUNK_GENERATION_DESERT_NOISE_THRESHOLD;
-
-            const int min_snow_min_height_variation =
-                min_snow_min_height_variation_noise *
-                    CHUNK_GENERATION_MIN_SNOW_HEIGHT_VARIATION * 2 -
-                CHUNK_GENERATION_MIN_SNOW_HEIGHT_VARIATION;
-
-            block_init(&self->blocks[x][0][z], BLOCK_TYPE_BEDROCK);
-            for (int y = 1; y < CHUNK_HEIGHT; ++y) {
-                BlockType block_type;
-                if (y <= max_stone_y) {
-                    block_type = BLOCK_TYPE_STONE;
-                } else if (y <= max_y) {
-                    if (y > CHUNK_GENERATION_MIN_SNOW_HEIGHT +
-                                min_snow_min_height_variation) {
-                        block_type = BLOCK_TYPE_SNOW;
-                    } else if (is_desert) {
-                        block_type = BLOCK_TYPE_SAND;
-                    } else {
-                        if (y == max_y) {
-                            block_type = BLOCK_TYPE_GRASS;
-                        } else {
-                            block_type = BLOCK_TYPE_DIRT;
-                        }
-                    }
-                } else {
-                    block_type = BLOCK_TYPE_AIR;
-                }
-                block_init(&self->blocks[x][y][z], block_type);
-            }
-        }
+// Reset the arenas of the frame and keep the sum of their peak sizes.
+[[gnu::nonnull]]
+static void world_end_render(WorldView *const restrict view,
+                             RenderTiles *const restrict tiles) {
+    assert(view != NULL);
+    assert(tiles != NULL);
+
+    render_tiles_destroy(tiles);
+    size_t peak_size = 0;
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        peak_size += view->render_arenas[i].peak_size;
     }
-    chunck_update_aabb(self);
-
-    mesh_init(&self->mesh, 1024, 1024);
-    self->mesh_dirty = true;
-
-    return self;
+    peak_size /= 1024;
+    atomic_store_explicit(&view->render_arenas_peak_size,
+                          peak_size < UINT32_MAX ? peak_size : UINT32_MAX,
+                          memory_order_relaxed);
 }
 
 [[gnu::nonnull]]
-static void chunk_destroy(Chunk *const self) {
+static inline void world_make_chunk_mesh_dirty(World *const restrict self,
+                                               Chunk *const restrict chunk) {
     assert(self != NULL);
-#ifndef __wasm__
-    mutex_destroy(&self->mesh_mutex);
-#endif
-    mesh_destroy(&self->mesh);
-    free(self);
+    assert(chunk != NULL);
+    chunk_mesher_invalidate(&self->chunk_mesher, chunk,
+                            CHUNK_SECTION_MASK_ALL);
 }
 
+// The faces of the blocks around y and their outlines may have changed, only
+// the sections containing y - 1, y and y + 1 are rebuilt.
 [[gnu::nonnull]]
-static void chunk_render(Chunk *const restrict self,
-                         const Camera *const restrict camera,
-                         const World *const restrict world,
-                         const Viewport *const restrict viewport) {
+static inline void world_make_chunk_mesh_dirty_around(
+    World *const restrict self, Chunk *const restrict chunk, const int y) {
     assert(self != NULL);
-    assert(camera != NULL);
-    assert(world != NULL);
-    assert(viewport != NULL);
-
-    if (!camera_aabb_in_frustum(camera, &self->aabb)) return;
+    assert(chunk != NULL);
+    assert(0 <= y && y < CHUNK_HEIGHT);
 
-    mutex_lock(&self->mesh_mutex);
-    if (self->mesh_dirty) {
-        chunk_generate_mesh(self, world);
+    ChunkSectionMask sections = 0;
+    for (int i = max_int(y - 1, 0) / CHUNK_SECTION_HEIGHT;
+         i <= min_int(y + 1, CHUNK_HEIGHT - 1) / CHUNK_SECTION_HEIGHT; ++i) {
+        sections |= (ChunkSectionMask)(1u << i);
     }
-    mutex_unlock(&self->mesh_mutex);
-    mesh_render(&self->mesh, camera, viewport);
-}
-
-[[gnu::nonnull]]
-static inline void chunk_make_mesh_dirty(Chunk *const self) {
-    assert(self != NULL);
-    self->mesh_dirty = true;
+    chunk_mesher_invalidate(&self->chunk_mesher, chunk, sections);
 }
 
 World *world_create(const uint32_t seed) {
@@ -738,45 +180,162 @@ World *world_create(const uint32_t seed) {
     log_debugf("world seed: %u", seed);
     self->seed = seed;
 
-    for (int x = 0; x < WORLD_SIZE; ++x) {
-        for (int z = 0; z < WORLD_SIZE; ++z) {
-            self->chunks[x][z] = NULL;
+    chunk_map_init(&self->chunks, WORLD_CHUNK_MAP_DEFAULT_CAPACITY);
+    chunk_pool_init(&self->chunk_pool, WORLD_CHUNK_POOL_CAPACITY);
+#ifndef __wasm__
+    chunk_storage_init(&self->chunk_storage, seed);
+    chunk_generator_init(&self->chunk_generator, seed, &self->chunk_storage);
+#else
+    chunk_generator_init(&self->chunk_generator, seed, NULL);
+#endif
+    chunk_array_init(&self->generated_chunks, WORLD_LOAD_DISTANCE * 2 + 1);
+    chunk_mesher_init(&self->chunk_mesher, &self->chunks);
+    for (size_t i = 0; i < WORLD_VIEWS_NUMBER; ++i) {
+        WorldView *const view = &self->views[i];
+        atomic_init(&view->occluded_chunks_number, 0);
+        atomic_init(&view->occluded_triangles_number, 0);
+        for (size_t j = 0; j < WORLD_RENDER_THREADS_NUMBER; ++j) {
+            frame_arena_init(&view->render_arenas[j],
+                             RENDER_ARENA_DEFAULT_CAPACITY);
         }
+        atomic_init(&view->render_arenas_peak_size, 0);
+#ifndef __wasm__
+        for (size_t j = 0; j < WORLD_RENDER_THREADS_NUMBER; ++j) {
+            atomic_init(&view->render_thread_usages[j], 0);
+        }
+#endif
     }
     return self;
 }
 
 void world_destroy(World *const self) {
     assert(self != NULL);
-    for (size_t x = 0; x < WORLD_SIZE; ++x) {
-        for (size_t z = 0; z < WORLD_SIZE; ++z) {
-            if (self->chunks[x][z] != NULL) {
-                chunk_destroy(self->chunks[x][z]);
-            }
+    chunk_mesher_destroy(&self->chunk_mesher);
+    chunk_generator_destroy(&self->chunk_generator);
+    array_destroy((const Array *)&self->generated_chunks);
+#ifndef __wasm__
+    for (size_t i = 0; i < self->chunks.capacity; ++i) {
+        const Chunk *const chunk = self->chunks.slots[i].chunk;
+        if (chunk != NULL && chunk->modified) {
+            chunk_storage_save(&self->chunk_storage, chunk);
+        }
+    }
+    chunk_storage_destroy(&self->chunk_storage);
+#endif
+    for (size_t i = 0; i < self->chunks.capacity; ++i) {
+        if (self->chunks.slots[i].chunk != NULL) {
+            chunk_destroy(self->chunks.slots[i].chunk);
+        }
+    }
+    chunk_map_destroy(&self->chunks);
+    chunk_pool_destroy(&self->chunk_pool);
+    for (size_t i = 0; i < WORLD_VIEWS_NUMBER; ++i) {
+        for (size_t j = 0; j < WORLD_RENDER_THREADS_NUMBER; ++j) {
+            frame_arena_destroy(&self->views[i].render_arenas[j]);
         }
     }
     free(self);
 }
 
+// The positions are clamped to stay in the range of an int, past the border of
+// the world.
+#define WORLD_POSITION_LIMIT ((float)(1 << 30))
+
 v2i world_position_to_chunk_coordinate(const v3f position) {
+    const int x = (int)clamp_float(floorf(position.x), -WORLD_POSITION_LIMIT,
+                                   WORLD_POSITION_LIMIT);
+    const int z = (int)clamp_float(floorf(position.z), -WORLD_POSITION_LIMIT,
+                                   WORLD_POSITION_LIMIT);
     return (v2i){
-        .x = ((int)floorf(position.x) + WORLD_ORIGIN * CHUNK_SIZE) / CHUNK_SIZE,
-        .y = ((int)floorf(position.z) + WORLD_ORIGIN * CHUNK_SIZE) / CHUNK_SIZE,
+        .x = floor_div_int(x, CHUNK_SIZE),
+        .y = floor_div_int(z, CHUNK_SIZE),
     };
 }
 
 static v2i world_position_to_chunk_coordinate_v3i(const v3i position) {
     return (v2i){
-        .x = (position.x + WORLD_ORIGIN * CHUNK_SIZE) / CHUNK_SIZE,
-        .y = (position.z + WORLD_ORIGIN * CHUNK_SIZE) / CHUNK_SIZE,
+        .x = floor_div_int(position.x, CHUNK_SIZE),
+        .y = floor_div_int(position.z, CHUNK_SIZE),
     };
 }
 
+void world_update(World *const self) {
+    assert(self != NULL);
+
+    chunk_mesher_collect(&self->chunk_mesher);
+    chunk_generator_collect(&self->chunk_generator, &self->generated_chunks);
+    if (self->generated_chunks.length == 0) return;
+
+    chunk_mesher_lock_chunks(&self->chunk_mesher);
+    for (size_t i = 0; i < self->generated_chunks.length; ++i) {
+        Chunk *const chunk = self->generated_chunks.array[i];
+        if (chunk->unloaded) {
+            chunk_pool_release(&self->chunk_pool, chunk);
+            continue;
+        }
+
+        chunk->pending = false;
+
+        // The faces at the border of the neighbours may have changed.
+        for (int x = chunk->x - 1; x <= chunk->x + 1; ++x) {
+            for (int z = chunk->z - 1; z <= chunk->z + 1; ++z) {
+                Chunk *const neighbour = chunk_map_get(&self->chunks, x, z);
+                if (neighbour == NULL) continue;
+                world_make_chunk_mesh_dirty(self, neighbour);
+            }
+        }
+    }
+    chunk_mesher_unlock_chunks(&self->chunk_mesher);
+    self->generated_chunks.length = 0;
+}
+
 [[gnu::nonnull]]
-static inline bool chunk_need_to_be_loaded(const Chunk *const self) {
+static void world_unload_chunk(World *const restrict self,
+                               Chunk *const restrict chunk) {
     assert(self != NULL);
-    return self->loaded_by[0] || self->loaded_by[1] || self->loaded_by[2] ||
-           self->loaded_by[3];
+    assert(chunk != NULL);
+
+    log_debugf("unload chunk (%d, %d)", chunk->x, chunk->z);
+    chunk_mesher_lock_chunks(&self->chunk_mesher);
+    chunk_map_remove(&self->chunks, chunk->x, chunk->z);
+    chunk_mesher_cancel(&self->chunk_mesher, chunk);
+    chunk_mesher_unlock_chunks(&self->chunk_mesher);
+    if (chunk->pending &&
+        !chunk_generator_cancel(&self->chunk_generator, chunk)) {
+        return;
+    }
+#ifndef __wasm__
+    if (chunk->modified) chunk_storage_save(&self->chunk_storage, chunk);
+#endif
+    chunk_pool_release(&self->chunk_pool, chunk);
+}
+
+[[gnu::nonnull]]
+static void world_load_chunk(World *const self, const int x, const int z,
+                             const int8_t player_index) {
+    assert(self != NULL);
+
+    Chunk *const chunk =
+        chunk_pool_get(&self->chunk_pool, x, z, player_index);
+    chunk_mesher_lock_chunks(&self->chunk_mesher);
+    chunk_map_insert(&self->chunks, x, z, chunk);
+    chunk_mesher_unlock_chunks(&self->chunk_mesher);
+    chunk_generator_push(&self->chunk_generator, chunk);
+}
+
+// The chunk under the player is needed right away (spawn, teleportation).
+[[gnu::nonnull]]
+static void world_wait_chunk(World *const self, const v2i chunk_position) {
+    assert(self != NULL);
+
+    Chunk *const chunk =
+        chunk_map_get(&self->chunks, chunk_position.x, chunk_position.y);
+    assert(chunk != NULL);
+    if (!chunk->pending) return;
+
+    chunk_generator_wait(&self->chunk_generator, chunk);
+    world_update(self);
+    assert(!chunk->pending);
 }
 
 void world_update_loaded_chunks(World *const self, const v2i old_chunk_position,
@@ -784,38 +343,28 @@ void world_update_loaded_chunks(World *const self, const v2i old_chunk_position,
                                 const int8_t player_index) {
     assert(self != NULL);
 
-    const int old_load_min_x =
-        max_int(0, old_chunk_position.x - WORLD_LOAD_DISTANCE);
-    const int old_load_max_x =
-        min_int(old_chunk_position.x + WORLD_LOAD_DISTANCE + 1, WORLD_SIZE);
-    const int old_load_min_z =
-        max_int(0, old_chunk_position.y - WORLD_LOAD_DISTANCE);
-    const int old_load_max_z =
-        min_int(old_chunk_position.y + WORLD_LOAD_DISTANCE + 1, WORLD_SIZE);
-    assert(0 <= old_load_max_x && old_load_max_x <= WORLD_SIZE);
-    assert(0 <= old_load_max_z && old_load_max_z <= WORLD_SIZE);
-
-    const int new_load_min_x =
-        max_int(0, new_chunk_position.x - WORLD_LOAD_DISTANCE);
-    const int new_load_max_x =
-        min_int(new_chunk_position.x + WORLD_LOAD_DISTANCE + 1, WORLD_SIZE);
-    const int new_load_min_z =
-        max_int(0, new_chunk_position.y - WORLD_LOAD_DISTANCE);
-    const int new_load_max_z =
-        min_int(new_chunk_position.y + WORLD_LOAD_DISTANCE + 1, WORLD_SIZE);
-    assert(0 <= new_load_max_x && new_load_max_x <= WORLD_SIZE);
-    assert(0 <= new_load_max_z && new_load_max_z <= WORLD_SIZE);
+    const int old_load_min_x = old_chunk_position.x - WORLD_LOAD_DISTANCE;
+    const int old_load_max_x = old_chunk_position.x + WORLD_LOAD_DISTANCE + 1;
+    const int old_load_min_z = old_chunk_position.y - WORLD_LOAD_DISTANCE;
+    const int old_load_max_z = old_chunk_position.y + WORLD_LOAD_DISTANCE + 1;
+
+    const int new_load_min_x = new_chunk_position.x - WORLD_LOAD_DISTANCE;
+    const int new_load_max_x = new_chunk_position.x + WORLD_LOAD_DISTANCE + 1;
+    const int new_load_min_z = new_chunk_position.y - WORLD_LOAD_DISTANCE;
+    const int new_load_max_z = new_chunk_position.y + WORLD_LOAD_DISTANCE + 1;
+
+    chunk_generator_set_player_position(&self->chunk_generator, player_index,
+                                        new_chunk_position);
 
     for (int x = old_load_min_x; x < old_load_max_x; ++x) {
         for (int z = old_load_min_z; z < old_load_max_z; ++z) {
             if (x < new_load_min_x || x >= new_load_max_x ||
                 z < new_load_min_z || z >= new_load_max_z) {
-                self->chunks[x][z]->loaded_by[player_index] = false;
-                if (!chunk_need_to_be_loaded(self->chunks[x][z])) {
-                    log_debugf("unload chunk (%d, %d)", x - WORLD_ORIGIN,
-                               z - WORLD_ORIGIN);
-                    chunk_destroy(self->chunks[x][z]);
-                    self->chunks[x][z] = NULL;
+                Chunk *const chunk = chunk_map_get(&self->chunks, x, z);
+                assert(chunk != NULL);
+                chunk->loaded_by[player_index] = false;
+                if (!chunk_need_to_be_loaded(chunk)) {
+                    world_unload_chunk(self, chunk);
                 }
             }
         }
@@ -825,25 +374,123 @@ void world_update_loaded_chunks(World *const self, const v2i old_chunk_position,
         for (int z = new_load_min_z; z < new_load_max_z; ++z) {
             if (x < old_load_min_x || x >= old_load_max_x ||
                 z < old_load_min_z || z >= old_load_max_z) {
-                if (self->chunks[x][z] == NULL) {
-                    log_debugf("load chunk (%d, %d)", x - WORLD_ORIGIN,
-                               z - WORLD_ORIGIN);
-                    self->chunks[x][z] =
-                        chunk_create(x - WORLD_ORIGIN, z - WORLD_ORIGIN,
-                                     self->seed, player_index);
+                Chunk *const chunk = chunk_map_get(&self->chunks, x, z);
+                if (chunk == NULL) {
+                    world_load_chunk(self, x, z, player_index);
+                } else {
+                    chunk->loaded_by[player_index] = true;
                 }
-                self->chunks[x][z]->loaded_by[player_index] = true;
             }
         }
     }
+
+    world_wait_chunk(self, new_chunk_position);
 }
 
 #ifndef __wasm__
+// Returns the time taken in ns, it is kept as the cost of the chunk to balance
+// the render threads of the next frame.
+[[gnu::nonnull]]
+static uint64_t world_render_chunk(World *const restrict self,
+                                   Chunk *const restrict chunk,
+                                   const Camera *const restrict camera,
+                                   RenderTiles *const restrict tiles,
+                                   const size_t thread_index) {
+    assert(self != NULL);
+    assert(chunk != NULL);
+    assert(camera != NULL);
+    assert(tiles != NULL);
+
+    const uint64_t start = get_time_nanoseconds();
+    chunk_render(chunk, camera, &self->chunk_mesher, tiles, thread_index);
+    const uint64_t time = get_time_nanoseconds() - start;
+    atomic_store_explicit(&chunk->render_cost,
+                          time < UINT32_MAX ? time : UINT32_MAX,
+                          memory_order_relaxed);
+    return time;
+}
+
+[[gnu::nonnull]]
+static void world_set_render_thread_usages(
+    WorldView *const view, const uint64_t start,
+    const uint64_t busy_times[WORLD_RENDER_THREADS_NUMBER]) {
+    assert(view != NULL);
+    assert(busy_times != NULL);
+
+    const uint64_t time = get_time_nanoseconds() - start;
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        const uint64_t usage = time == 0 ? 0 : busy_times[i] * 1000 / time;
+        atomic_store_explicit(&view->render_thread_usages[i],
+                              usage < 1000 ? usage : 1000,
+                              memory_order_relaxed);
+    }
+}
+
+typedef struct {
+    RenderTiles *tiles;
+    _Atomic int next_tile;
+    uint64_t busy_times[WORLD_RENDER_THREADS_NUMBER];
+} WorldRasterizeContext;
+
+typedef struct {
+    WorldRasterizeContext *rasterize_context;
+    size_t thread_index;
+} WorldRasterizeJob;
+
+[[gnu::nonnull]]
+static void world_rasterize_job(void *const data) {
+    assert(data != NULL);
+
+    const WorldRasterizeJob *const job = data;
+    WorldRasterizeContext *const rasterize_context = job->rasterize_context;
+    RenderTiles *const tiles = rasterize_context->tiles;
+    const int tiles_number = tiles->columns * tiles->rows;
+
+    const uint64_t start = get_time_nanoseconds();
+    int tile_index;
+    while ((tile_index = atomic_fetch_add_explicit(
+                &rasterize_context->next_tile, 1, memory_order_relaxed)) <
+           tiles_number) {
+        render_tiles_rasterize(tiles, tile_index);
+    }
+    rasterize_context->busy_times[job->thread_index] =
+        get_time_nanoseconds() - start;
+}
+
+// Each tile is rasterized by a single thread, the time spent by each thread is
+// added to busy_times.
+[[gnu::nonnull]]
+static void world_rasterize_tiles(
+    RenderTiles *const restrict tiles,
+    uint64_t busy_times[restrict WORLD_RENDER_THREADS_NUMBER]) {
+    assert(tiles != NULL);
+    assert(busy_times != NULL);
+
+    WorldRasterizeContext rasterize_context = {.tiles = tiles};
+    atomic_init(&rasterize_context.next_tile, 0);
+
+    WorldRasterizeJob jobs_data[WORLD_RENDER_THREADS_NUMBER];
+    JobGroup group = {.pending = 0};
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        jobs_data[i] = (WorldRasterizeJob){
+            .rasterize_context = &rasterize_context,
+            .thread_index = i,
+        };
+        if (i != 0) jobs_fork(&group, world_rasterize_job, &jobs_data[i]);
+    }
+    world_rasterize_job(&jobs_data[0]);
+    jobs_join(&group);
+
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        busy_times[i] += rasterize_context.busy_times[i];
+    }
+}
+
 #ifndef WORLD_RENDER_SCHEDULER_DYNAMIC
 typedef struct {
-    const World *self;
+    World *self;
     const Camera *camera;
-    const Viewport *viewport;
+    RenderTiles *tiles;
     int min_x, min_z;
     int width;
 } WorldRenderContext;
@@ -852,59 +499,64 @@ typedef struct {
     const WorldRenderContext *render_context;
     int from;
     int to;
-} WorldRenderThread;
+    size_t thread_index;
+    uint64_t busy_time;
+} WorldRenderJob;
 
 [[gnu::nonnull]]
-static void *world_render_thread(void *const data) {
+static void world_render_job(void *const data) {
     assert(data != NULL);
 
-    const WorldRenderThread *const thread = data;
+    WorldRenderJob *const job = data;
 
-    const World *const self = thread->render_context->self;
-    const Camera *const camera = thread->render_context->camera;
-    const Viewport *const viewport = thread->render_context->viewport;
-    const int min_x = thread->render_context->min_x;
-    const int min_z = thread->render_context->min_z;
-    const int width = thread->render_context->width;
+    World *const self = job->render_context->self;
+    const Camera *const camera = job->render_context->camera;
+    RenderTiles *const tiles = job->render_context->tiles;
+    const int min_x = job->render_context->min_x;
+    const int min_z = job->render_context->min_z;
+    const int width = job->render_context->width;
 
-    for (int i = thread->from; i < thread->to; ++i) {
+    job->busy_time = 0;
+    for (int i = job->from; i < job->to; ++i) {
         const int x = min_x + i / width;
         const int z = min_z + i % width;
-        Chunk *const chunk = self->chunks[x][z];
+        Chunk *const chunk = chunk_map_get(&self->chunks, x, z);
         assert(chunk != NULL);
-        chunk_render(chunk, camera, self, viewport);
+        job->busy_time +=
+            world_render_chunk(self, chunk, camera, tiles, job->thread_index);
     }
-
-    return NULL;
 }
 
-void world_render(const World *const restrict self,
+void world_render(World *const restrict self, const uint8_t view_index,
                   const Camera *const restrict camera,
                   const Viewport *const restrict viewport) {
     assert(self != NULL);
+    assert(view_index < WORLD_VIEWS_NUMBER);
     assert(camera != NULL);
     assert(viewport != NULL);
+    WorldView *const view = &self->views[view_index];
+
+    const uint64_t start = get_time_nanoseconds();
 
     const v2i camera_chunk_position =
         world_position_to_chunk_coordinate(camera->position);
 
-    const int min_x =
-        max_int(0, camera_chunk_position.x - WORLD_RENDER_DISTANCE);
-    const int max_x = min_int(
-        camera_chunk_position.x + WORLD_RENDER_DISTANCE + 1, WORLD_SIZE);
-    const int min_z =
-        max_int(0, camera_chunk_position.y - WORLD_RENDER_DISTANCE);
-    const int max_z = min_int(
-        camera_chunk_position.y + WORLD_RENDER_DISTANCE + 1, WORLD_SIZE);
+    const int min_x = camera_chunk_position.x - WORLD_RENDER_DISTANCE;
+    const int max_x = camera_chunk_position.x + WORLD_RENDER_DISTANCE + 1;
+    const int min_z = camera_chunk_position.y - WORLD_RENDER_DISTANCE;
+    const int max_z = camera_chunk_position.y + WORLD_RENDER_DISTANCE + 1;
 
     const int width = max_x - min_x;
     const int height = max_z - min_z;
     const int size = width * height;
 
+    RenderTiles tiles;
+    render_tiles_init(&tiles, viewport, view->render_arenas);
+
     const WorldRenderContext render_context = {
         .self = self,
         .camera = camera,
-        .viewport = viewport,
+        .tiles = &tiles,
         .width = width,
         .min_x = min_x,
         .min_z = min_z,
@@ -914,208 +566,297 @@ void world_render(const World *const restrict self,
     const int remainingChunks = size % WORLD_RENDER_THREADS_NUMBER;
     int assignedChunks = chunkPerThread + (0 < remainingChunks);
 
-    WorldRenderThread threads_data[WORLD_RENDER_THREADS_NUMBER];
-
-    threads_data[0].render_context = &render_context;
-    threads_data[0].from = 0;
-    threads_data[0].to = assignedChunks;
-
-    pthread_t threads[WORLD_RENDER_THREADS_NUMBER - 1];
-
-    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER - 1; ++i) {
-        const int j = i + 1;
-        threads_data[j].render_context = &render_context;
-        threads_data[j].from = assignedChunks;
-        assignedChunks += chunkPerThread + (j < remainingChunks);
-        threads_data[j].to = assignedChunks;
-        const int return_code = pthread_create(
-            &threads[i], NULL, world_render_thread, &threads_data[j]);
-        if (return_code != 0) {
-            log_errorf("failed to create render thread: %s",
-                       strerror(return_code));
-            exit(EXIT_FAILURE);
-        }
+    WorldRenderJob jobs_data[WORLD_RENDER_THREADS_NUMBER];
+
+    jobs_data[0].render_context = &render_context;
+    jobs_data[0].from = 0;
+    jobs_data[0].to = assignedChunks;
+    jobs_data[0].thread_index = 0;
+
+    JobGroup group = {.pending = 0};
+
+    for (int i = 1; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        jobs_data[i].render_context = &render_context;
+        jobs_data[i].from = assignedChunks;
+        assignedChunks += chunkPerThread + (i < remainingChunks);
+        jobs_data[i].to = assignedChunks;
+        jobs_data[i].thread_index = i;
+        jobs_fork(&group, world_render_job, &jobs_data[i]);
     }
 
-    world_render_thread(&threads_data[0]);
+    world_render_job(&jobs_data[0]);
+    jobs_join(&group);
 
-    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER - 1; ++i) {
-        const int return_code = pthread_join(threads[i], NULL);
-        if (return_code != 0) {
-            log_errorf("failed to join render thread: %s",
-                       strerror(return_code));
-            exit(EXIT_FAILURE);
-        }
+    uint64_t busy_times[WORLD_RENDER_THREADS_NUMBER];
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        busy_times[i] = jobs_data[i].busy_time;
     }
+    world_rasterize_tiles(&tiles, busy_times);
+    world_set_occluded_numbers(view, &tiles);
+    world_end_render(view, &tiles);
+    world_set_render_thread_usages(view, start, busy_times);
 }
 
 #else
 
+#define WORLD_RENDER_DEQUE_BOUNDS(front, back) \
+    ((uint64_t)(back) << 32 | (uint32_t)(front))
+
+// Chunks of a render thread, sorted front to back. They are all pushed before
+// the render starts, then the thread pops them from the front while the idle
+// threads steal them from the back.
 typedef struct {
-    const World *self;
+    // Index of the front chunk in the low half and end of the back in the high
+    // half, updated together so a chunk is never taken twice.
+    _Atomic uint64_t bounds;
+} WorldRenderDeque;
+
+typedef struct {
+    World *self;
     const Camera *camera;
-    const Viewport *viewport;
-    pthread_mutex_t mutex;
-    int x, z;
-    int min_x, max_x;
-    int min_z, max_z;
+    RenderTiles *tiles;
+    // The chunks of the deques, one deque after the other.
+    Chunk *chunks[WORLD_RENDER_CHUNKS_NUMBER];
+    WorldRenderDeque deques[WORLD_RENDER_THREADS_NUMBER];
+    uint64_t busy_times[WORLD_RENDER_THREADS_NUMBER];
 } WorldRenderContext;
 
-[[gnu::nonnull]]
-static void *world_render_thread(void *const data) {
-    assert(data != NULL);
+typedef struct {
+    WorldRenderContext *render_context;
+    size_t thread_index;
+} WorldRenderJob;
 
-    WorldRenderContext *const render_context = data;
+typedef struct {
+    Chunk *chunk;
+    float distance_squared;
+    size_t thread_index;
+} WorldRenderChunk;
 
-    const World *const self = render_context->self;
-    const Camera *const camera = render_context->camera;
-    const Viewport *const viewport = render_context->viewport;
+[[gnu::nonnull]]
+static int world_render_chunk_compare(const void *const a,
+                                      const void *const b) {
+    assert(a != NULL);
+    assert(b != NULL);
+
+    const float distance_a = ((const WorldRenderChunk *)a)->distance_squared;
+    const float distance_b = ((const WorldRenderChunk *)b)->distance_squared;
+    return (distance_a > distance_b) - (distance_a < distance_b);
+}
+
+[[gnu::nonnull]]
+static Chunk *world_render_deque_pop(WorldRenderDeque *const restrict self,
+                                     Chunk *const *const restrict chunks,
+                                     const bool steal) {
+    assert(self != NULL);
+    assert(chunks != NULL);
 
+    uint64_t bounds = atomic_load_explicit(&self->bounds, memory_order_relaxed);
     while (true) {
-        mutex_lock(&render_context->mutex);
-        const int x = render_context->x;
-        if (x >= render_context->max_x) {
-            mutex_unlock(&render_context->mutex);
-            break;
+        const uint32_t front = bounds;
+        const uint32_t back = bounds >> 32;
+        if (front == back) return NULL;
+        const uint64_t new_bounds =
+            steal ? WORLD_RENDER_DEQUE_BOUNDS(front, back - 1)
+                  : WORLD_RENDER_DEQUE_BOUNDS(front + 1, back);
+        if (atomic_compare_exchange_weak_explicit(
+                &self->bounds, &bounds, new_bounds, memory_order_relaxed,
+                memory_order_relaxed)) {
+            return chunks[steal ? back - 1 : front];
         }
-        const int z = render_context->z++;
-        if (render_context->z >= render_context->max_z) {
-            ++render_context->x;
-            render_context->z = render_context->min_z;
-        }
-        mutex_unlock(&render_context->mutex);
-
-        Chunk *const chunk = self->chunks[x][z];
-        assert(chunk != NULL);
-        chunk_render(chunk, camera, self, viewport);
     }
+}
+
+[[gnu::nonnull]]
+static void world_render_job(void *const data) {
+    assert(data != NULL);
 
-    return NULL;
+    const WorldRenderJob *const job = data;
+    WorldRenderContext *const render_context = job->render_context;
+
+    World *const self = render_context->self;
+    const Camera *const camera = render_context->camera;
+    RenderTiles *const tiles = render_context->tiles;
+
+    // The chunks of the thread first, then the farthest ones of the others.
+    uint64_t busy_time = 0;
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        const size_t thread_index =
+            (job->thread_index + i) % WORLD_RENDER_THREADS_NUMBER;
+        WorldRenderDeque *const deque = &render_context->deques[thread_index];
+        Chunk *chunk;
+        while ((chunk = world_render_deque_pop(deque, render_context->chunks,
+                                               i != 0)) != NULL) {
+            busy_time += world_render_chunk(self, chunk, camera, tiles,
+                                            job->thread_index);
+        }
+    }
+    render_context->busy_times[job->thread_index] = busy_time;
 }
 
-void world_render(const World *const restrict self,
+void world_render(World *const restrict self, const uint8_t view_index,
                   const Camera *const restrict camera,
                   const Viewport *const restrict viewport) {
     assert(self != NULL);
+    assert(view_index < WORLD_VIEWS_NUMBER);
     assert(camera != NULL);
     assert(viewport != NULL);
+    WorldView *const view = &self->views[view_index];
+
+    const uint64_t start = get_time_nanoseconds();
 
     const v2i camera_chunk_position =
         world_position_to_chunk_coordinate(camera->position);
 
-    const int min_x =
-        max_int(0, camera_chunk_position.x - WORLD_RENDER_DISTANCE);
-    const int max_x = min_int(
-        camera_chunk_position.x + WORLD_RENDER_DISTANCE + 1, WORLD_SIZE);
-    const int min_z =
-        max_int(0, camera_chunk_position.y - WORLD_RENDER_DISTANCE);
-    const int max_z = min_int(
-        camera_chunk_position.y + WORLD_RENDER_DISTANCE + 1, WORLD_SIZE);
+    const int min_x = camera_chunk_position.x - WORLD_RENDER_DISTANCE;
+    const int max_x = camera_chunk_position.x + WORLD_RENDER_DISTANCE + 1;
+    const int min_z = camera_chunk_position.y - WORLD_RENDER_DISTANCE;
+    const int max_z = camera_chunk_position.y + WORLD_RENDER_DISTANCE + 1;
+
+    WorldRenderChunk chunks[WORLD_RENDER_CHUNKS_NUMBER];
+    size_t chunks_number = 0;
+    for (int x = min_x; x < max_x; ++x) {
+        for (int z = min_z; z < max_z; ++z) {
+            Chunk *const chunk = chunk_map_get(&self->chunks, x, z);
+            assert(chunk != NULL);
+            chunks[chunks_number++] = (WorldRenderChunk){
+                .chunk = chunk,
+                .distance_squared =
+                    aabb_get_distance_squared(&chunk->aabb, camera->position),
+            };
+        }
+    }
+    assert(chunks_number == WORLD_RENDER_CHUNKS_NUMBER);
+    qsort(chunks, chunks_number, sizeof(*chunks), world_render_chunk_compare);
+
+    // Each chunk goes to the thread with the lowest cost so far, according to
+    // the render times of the previous frame.
+    uint64_t costs[WORLD_RENDER_THREADS_NUMBER] = {0};
+    size_t lengths[WORLD_RENDER_THREADS_NUMBER] = {0};
+    for (size_t i = 0; i < chunks_number; ++i) {
+        size_t thread_index = 0;
+        for (size_t j = 1; j < WORLD_RENDER_THREADS_NUMBER; ++j) {
+            if (costs[j] < costs[thread_index]) thread_index = j;
+        }
+        const uint32_t cost = atomic_load_explicit(
+            &chunks[i].chunk->render_cost, memory_order_relaxed);
+        costs[thread_index] += cost + 1;
+        ++lengths[thread_index];
+        chunks[i].thread_index = thread_index;
+    }
+
+    RenderTiles tiles;
+    render_tiles_init(&tiles, viewport, view->render_arenas);
 
     WorldRenderContext render_context = {
         .self = self,
         .camera = camera,
-        .viewport = viewport,
-        .x = min_x,
-        .z = min_z,
-        .min_x = min_x,
-        .max_x = max_x,
-        .min_z = min_z,
-        .max_z = max_z,
+        .tiles = &tiles,
     };
-    pthread_mutex_init(&render_context.mutex, NULL);
 
-    pthread_t threads[WORLD_RENDER_THREADS_NUMBER - 1];
-
-    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER - 1; ++i) {
-        const int return_code = pthread_create(
-            &threads[i], NULL, world_render_thread, &render_context);
-        if (return_code != 0) {
-            log_errorf("failed to create render thread: %s",
-                       strerror(return_code));
-            exit(EXIT_FAILURE);
-        }
+    size_t ends[WORLD_RENDER_THREADS_NUMBER];
+    size_t end = 0;
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        atomic_init(&render_context.deques[i].bounds,
+                    WORLD_RENDER_DEQUE_BOUNDS(end, end + lengths[i]));
+        end += lengths[i];
+        ends[i] = end;
+    }
+    // Filled from the back to keep the deques sorted front to back.
+    for (size_t i = chunks_number; i-- > 0;) {
+        render_context.chunks[--ends[chunks[i].thread_index]] = chunks[i].chunk;
     }
 
-    world_render_thread(&render_context);
-
-    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER - 1; ++i) {
-        const int return_code = pthread_join(threads[i], NULL);
-        if (return_code != 0) {
-            log_errorf("failed to join render thread: %s",
-                       strerror(return_code));
-            exit(EXIT_FAILURE);
-        }
+    WorldRenderJob jobs_data[WORLD_RENDER_THREADS_NUMBER];
+    JobGroup group = {.pending = 0};
+    for (size_t i = 0; i < WORLD_RENDER_THREADS_NUMBER; ++i) {
+        jobs_data[i] = (WorldRenderJob){
+            .render_context = &render_context,
+            .thread_index = i,
+        };
+        if (i != 0) jobs_fork(&group, world_render_job, &jobs_data[i]);
     }
+    world_render_job(&jobs_data[0]);
+    jobs_join(&group);
 
-    mutex_destroy(&render_context.mutex);
+    world_rasterize_tiles(&tiles, render_context.busy_times);
+    world_set_occluded_numbers(view, &tiles);
+    world_end_render(view, &tiles);
+    world_set_render_thread_usages(view, start, render_context.busy_times);
 }
 #endif
 #else
-void world_render(const World *const restrict self,
+void world_render(World *const restrict self, const uint8_t view_index,
                   const Camera *const restrict camera,
                   const Viewport *const restrict viewport) {
     assert(self != NULL);
+    assert(view_index < WORLD_VIEWS_NUMBER);
     assert(camera != NULL);
     assert(viewport != NULL);
+    WorldView *const view = &self->views[view_index];
 
     const v2i camera_chunk_position =
         world_position_to_chunk_coordinate(camera->position);
 
-    const int min_x =
-        max_int(0, camera_chunk_position.x - WORLD_RENDER_DISTANCE);
-    const int max_x = min_int(
-        camera_chunk_position.x + WORLD_RENDER_DISTANCE + 1, WORLD_SIZE);
-    const int min_z =
-        max_int(0, camera_chunk_position.y - WORLD_RENDER_DISTANCE);
-    const int max_z = min_int(
-        camera_chunk_position.y + WORLD_RENDER_DISTANCE + 1, WORLD_SIZE);
+    const int min_x = camera_chunk_position.x - WORLD_RENDER_DISTANCE;
+    const int max_x = camera_chunk_position.x + WORLD_RENDER_DISTANCE + 1;
+    const int min_z = camera_chunk_position.y - WORLD_RENDER_DISTANCE;
+    const int max_z = camera_chunk_position.y + WORLD_RENDER_DISTANCE + 1;
+
+    RenderTiles tiles;
+    render_tiles_init(&tiles, viewport, view->render_arenas);
 
     for (int z = min_z; z < max_z; ++z) {
         for (int x = min_x; x < max_x; ++x) {
-            Chunk *const chunk = self->chunks[x][z];
+            Chunk *const chunk = chunk_map_get(&self->chunks, x, z);
             assert(chunk != NULL);
-            chunk_render(chunk, camera, self, viewport);
+            chunk_render(chunk, camera, &self->chunk_mesher, &tiles, 0);
         }
     }
+
+    for (int i = 0; i < tiles.columns * tiles.rows; ++i) {
+        render_tiles_rasterize(&tiles, i);
+    }
+    world_set_occluded_numbers(view, &tiles);
+    world_end_render(view, &tiles);
 }
 #endif
 
 Chunk *world_get_chunk(const World *const self, const int x, const int z) {
     assert(self != NULL);
-
-    const int x_index = x + WORLD_ORIGIN;
-    const int z_index = z + WORLD_ORIGIN;
-
-    if (x_index < 0 || x_index >= WORLD_SIZE || z_index < 0 ||
-        z_index >= WORLD_SIZE) {
-        return NULL;
-    }
-
-    return self->chunks[x_index][z_index];
+    return chunk_map_get(&self->chunks, x, z);
 }
 
-Block *world_get_block(const World *const self, const v3i block_position) {
+Block world_get_block(const World *const self, const v3i block_position) {
     assert(self != NULL);
     assert(0 <= block_position.y && block_position.y < CHUNK_HEIGHT);
 
-    const int shifted_x = block_position.x + WORLD_ORIGIN * CHUNK_SIZE;
-    const int shifted_z = block_position.z + WORLD_ORIGIN * CHUNK_SIZE;
-
-    assert(0 <= shifted_x && 0 <= shifted_z);
-
-    const int chunk_x = shifted_x / CHUNK_SIZE;
-    const int chunk_z = shifted_z / CHUNK_SIZE;
-
-    assert(chunk_x < WORLD_SIZE && chunk_z < WORLD_SIZE);
+    const v2i chunk_position =
+        world_position_to_chunk_coordinate_v3i(block_position);
+    const Chunk *const chunk =
+        chunk_map_get(&self->chunks, chunk_position.x, chunk_position.y);
+    assert(chunk != NULL);
+    assert(!chunk->pending);
 
     const int x_index = POSITIVE_MOD(block_position.x, CHUNK_SIZE);
     const int z_index = POSITIVE_MOD(block_position.z, CHUNK_SIZE);
 
-    assert(self->chunks[chunk_x][chunk_z] != NULL);
+    Block block;
+    block_init(&block,
+               chunk_get_block(chunk, x_index, block_position.y, z_index));
+    return block;
+}
+
+int world_get_height(const World *const self, const int x, const int z) {
+    assert(self != NULL);
+
+    const Chunk *const chunk =
+        chunk_map_get(&self->chunks, floor_div_int(x, CHUNK_SIZE),
+                      floor_div_int(z, CHUNK_SIZE));
+    assert(chunk != NULL);
+    assert(!chunk->pending);
 
-    return &self->chunks[chunk_x][chunk_z]
-                ->blocks[x_index][block_position.y][z_index];
+    return chunk_get_height(chunk, POSITIVE_MOD(x, CHUNK_SIZE),
+                            POSITIVE_MOD(z, CHUNK_SIZE));
 }
 
 bool world_block_is_solid(const World *const self, const v3i block_position) {
@@ -1123,23 +864,28 @@ bool world_block_is_solid(const World *const self, const v3i block_position) {
 
     if (block_position.y < 0 || block_position.y >= CHUNK_HEIGHT) return false;
 
-    const int shifted_x = block_position.x + WORLD_ORIGIN * CHUNK_SIZE;
-    const int shifted_z = block_position.z + WORLD_ORIGIN * CHUNK_SIZE;
-
-    if (shifted_x < 0 || shifted_z < 0) return true;
+    const v2i chunk_position =
+        world_position_to_chunk_coordinate_v3i(block_position);
+    const Chunk *const chunk =
+        chunk_map_get(&self->chunks, chunk_position.x, chunk_position.y);
+    assert(chunk != NULL);
 
-    const int chunk_x = shifted_x / CHUNK_SIZE;
-    const int chunk_z = shifted_z / CHUNK_SIZE;
+    if (chunk->pending) return true;
 
-    if (chunk_x >= WORLD_SIZE || chunk_z >= WORLD_SIZE) return true;
+    return chunk_block_is_solid(
+        chunk, POSITIVE_MOD(block_position.x, CHUNK_SIZE), block_position.y,
+        POSITIVE_MOD(block_position.z, CHUNK_SIZE));
+}
 
-    const int x_index = POSITIVE_MOD(block_position.x, CHUNK_SIZE);
-    const int z_index = POSITIVE_MOD(block_position.z, CHUNK_SIZE);
+bool world_block_is_generated(const World *const self,
+                              const v3i block_position) {
+    assert(self != NULL);
 
-    assert(self->chunks[chunk_x][chunk_z] != NULL);
-    return self->chunks[chunk_x][chunk_z]
-        ->blocks[x_index][block_position.y][z_index]
-        .type;
+    const v2i chunk_position =
+        world_position_to_chunk_coordinate_v3i(block_position);
+    const Chunk *const chunk =
+        chunk_map_get(&self->chunks, chunk_position.x, chunk_position.y);
+    return chunk != NULL && !chunk->pending;
 }
 
 void world_load_chunks_around_player(World *const self,
@@ -1147,71 +893,62 @@ void world_load_chunks_around_player(World *const self,
                                      const int8_t player_index) {
     assert(self != NULL);
 
-    const int min_x = max_int(0, player_chunk_position.x - WORLD_LOAD_DISTANCE);
-    const int max_x =
-        min_int(player_chunk_position.x + WORLD_LOAD_DISTANCE + 1, WORLD_SIZE);
-    const int min_z = max_int(0, player_chunk_position.y - WORLD_LOAD_DISTANCE);
-    const int max_z =
-        min_int(player_chunk_position.y + WORLD_LOAD_DISTANCE + 1, WORLD_SIZE);
+    const int min_x = player_chunk_position.x - WORLD_LOAD_DISTANCE;
+    const int max_x = player_chunk_position.x + WORLD_LOAD_DISTANCE + 1;
+    const int min_z = player_chunk_position.y - WORLD_LOAD_DISTANCE;
+    const int max_z = player_chunk_position.y + WORLD_LOAD_DISTANCE + 1;
+
+    chunk_generator_set_player_position(&self->chunk_generator, player_index,
+                                        player_chunk_position);
 
     for (int x = min_x; x < max_x; ++x) {
         for (int z = min_z; z < max_z; ++z) {
-            if (self->chunks[x][z] == NULL) {
-                self->chunks[x][z] =
-                    chunk_create(x - WORLD_ORIGIN, z - WORLD_ORIGIN, self->seed,
-                                 player_index);
-            } else if (!self->chunks[x][z]->loaded_by[player_index]) {
-                self->chunks[x][z]->loaded_by[player_index] = true;
+            Chunk *const chunk = chunk_map_get(&self->chunks, x, z);
+            if (chunk == NULL) {
+                world_load_chunk(self, x, z, player_index);
+            } else if (!chunk->loaded_by[player_index]) {
+                chunk->loaded_by[player_index] = true;
             }
         }
     }
+
+    world_wait_chunk(self, player_chunk_position);
 }
 
 [[gnu::nonnull(1, 2)]]
 static void world_update_chunk_mesh_around_block(World *const restrict self,
                                                  Chunk *const restrict chunk,
                                                  const uint8_t x_index,
+                                                 const int y,
                                                  const uint8_t z_index) {
     assert(self != NULL);
     assert(chunk != NULL);
 
-    chunk_make_mesh_dirty(chunk);
+    world_make_chunk_mesh_dirty_around(self, chunk, y);
 
-    const int chunk_x = chunk->x + WORLD_ORIGIN;
-    const int chunk_z = chunk->z + WORLD_ORIGIN;
+    const int dx = x_index == 0 ? -1 : x_index == CHUNK_SIZE - 1 ? 1 : 0;
+    const int dz = z_index == 0 ? -1 : z_index == CHUNK_SIZE - 1 ? 1 : 0;
 
-    if (x_index == 0) {
-        if (chunk_x != 0) {
-            chunk_make_mesh_dirty(self->chunks[chunk_x - 1][chunk_z]);
-            if (z_index == 0) {
-                if (chunk_z != 0) {
-                    chunk_make_mesh_dirty(
-                        self->chunks[chunk_x - 1][chunk_z - 1]);
-                }
-            } else if (z_index == CHUNK_SIZE - 1 && chunk_z != WORLD_SIZE - 1) {
-                chunk_make_mesh_dirty(self->chunks[chunk_x - 1][chunk_z + 1]);
-            }
+    Chunk *neighbour;
+    if (dx != 0) {
+        neighbour = chunk_map_get(&self->chunks, chunk->x + dx, chunk->z);
+        if (neighbour != NULL) {
+            world_make_chunk_mesh_dirty_around(self, neighbour, y);
         }
-    } else if (x_index == CHUNK_SIZE - 1) {
-        if (chunk_x != WORLD_SIZE - 1) {
-            chunk_make_mesh_dirty(self->chunks[chunk_x + 1][chunk_z]);
-            if (z_index == 0) {
-                if (chunk_z != 0) {
-                    chunk_make_mesh_dirty(
-                        self->chunks[chunk_x + 1][chunk_z - 1]);
-                }
-            } else if (z_index == CHUNK_SIZE - 1 && chunk_z != WORLD_SIZE - 1) {
-                chunk_make_mesh_dirty(self->chunks[chunk_x + 1][chunk_z + 1]);
+        if (dz != 0) {
+            neighbour =
+                chunk_map_get(&self->chunks, chunk->x + dx, chunk->z + dz);
+            if (neighbour != NULL) {
+                world_make_chunk_mesh_dirty_around(self, neighbour, y);
             }
         }
     }
 
-    if (z_index == 0) {
-        if (chunk_z != 0) {
-            chunk_make_mesh_dirty(self->chunks[chunk_x][chunk_z - 1]);
+    if (dz != 0) {
+        neighbour = chunk_map_get(&self->chunks, chunk->x, chunk->z + dz);
+        if (neighbour != NULL) {
+            world_make_chunk_mesh_dirty_around(self, neighbour, y);
         }
-    } else if (z_index == CHUNK_SIZE - 1 && chunk_z != WORLD_SIZE - 1) {
-        chunk_make_mesh_dirty(self->chunks[chunk_x][chunk_z + 1]);
     }
 }
 
@@ -1220,47 +957,56 @@ void world_place_block(World *const self, const v3i block_position) {
 
     const v2i chunk_position =
         world_position_to_chunk_coordinate_v3i(block_position);
-    assert(0 <= chunk_position.x && chunk_position.x < WORLD_SIZE);
-    assert(0 <= chunk_position.y && chunk_position.y < WORLD_SIZE);
-
-    Chunk *const chunk = self->chunks[chunk_position.x][chunk_position.y];
+    Chunk *const chunk =
+        chunk_map_get(&self->chunks, chunk_position.x, chunk_position.y);
     assert(chunk != NULL);
 
+    // The generator may still be writing the blocks.
+    if (chunk->pending) return;
+
     const int x_index = POSITIVE_MOD(block_position.x, CHUNK_SIZE);
     const int z_index = POSITIVE_MOD(block_position.z, CHUNK_SIZE);
 
-    assert(chunk->blocks[x_index][block_position.y][z_index].type ==
+    assert(chunk_get_block(chunk, x_index, block_position.y, z_index) ==
            BLOCK_TYPE_AIR);
 
-    chunk->blocks[x_index][block_position.y][z_index].type = self->place_block;
-    chunck_update_aabb(chunk);
+    chunk_mesher_lock_chunks(&self->chunk_mesher);
+    chunk_set_block(chunk, x_index, block_position.y, z_index,
+                    self->place_block);
+    chunk_mesher_unlock_chunks(&self->chunk_mesher);
+    chunk->modified = true;
 
-    world_update_chunk_mesh_around_block(self, chunk, x_index, z_index);
+    world_update_chunk_mesh_around_block(self, chunk, x_index,
+                                         block_position.y, z_index);
 }
 
 void world_break_block(World *const self, const v3i block_position) {
-    const int chunk_x =
-        (block_position.x + WORLD_ORIGIN * CHUNK_SIZE) / CHUNK_SIZE;
-    const int chunk_z =
-        (block_position.z + WORLD_ORIGIN * CHUNK_SIZE) / CHUNK_SIZE;
-    assert(0 <= chunk_x && chunk_x < WORLD_SIZE);
-    assert(0 <= chunk_z && chunk_z < WORLD_SIZE);
-
-    Chunk *const chunk = self->chunks[chunk_x][chunk_z];
+    assert(self != NULL);
+
+    const v2i chunk_position =
+        world_position_to_chunk_coordinate_v3i(block_position);
+    Chunk *const chunk =
+        chunk_map_get(&self->chunks, chunk_position.x, chunk_position.y);
     assert(chunk != NULL);
 
+    if (chunk->pending) return;
+
     const int x_index = POSITIVE_MOD(block_position.x, CHUNK_SIZE);
     const int z_index = POSITIVE_MOD(block_position.z, CHUNK_SIZE);
 
-    assert(chunk->blocks[x_index][block_position.y][z_index].type !=
+    assert(chunk_get_block(chunk, x_index, block_position.y, z_index) !=
            BLOCK_TYPE_AIR);
 
-    if (chunk->blocks[x_index][block_position.y][z_index].type ==
+    if (chunk_get_block(chunk, x_index, block_position.y, z_index) ==
         BLOCK_TYPE_BEDROCK)
         return;
 
-    chunk->blocks[x_index][block_position.y][z_index].type = BLOCK_TYPE_AIR;
-    chunck_update_aabb(chunk);
+    chunk_mesher_lock_chunks(&self->chunk_mesher);
+    chunk_set_block(chunk, x_index, block_position.y, z_index,
+                    BLOCK_TYPE_AIR);
+    chunk_mesher_unlock_chunks(&self->chunk_mesher);
+    chunk->modified = true;
 
-    world_update_chunk_mesh_around_block(self, chunk, x_index, z_index);
+    world_update_chunk_mesh_around_block(self, chunk, x_index,
+                                         block_position.y, z_index);
 }
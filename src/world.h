@@ -1,32 +1,49 @@
 #pragma once
 
-#ifndef __wasm__
-#include <pthread.h>
-#endif
-
 #include "block.h"
 #include "camera_defs.h"
-#include "collision_defs.h"
-#include "config.h"
-#include "mesh_defs.h"
+#include "chunk_array_defs.h"
+#include "chunk_defs.h"
+#include "chunk_generator_defs.h"
+#include "chunk_map_defs.h"
+#include "chunk_mesher_defs.h"
+#include "chunk_pool_defs.h"
+#ifndef __wasm__
+#include "chunk_storage_defs.h"
+#endif
+#include "frame_arena_defs.h"
 #include "viewport.h"
 
+// The memory and the statistics of world_render() in a view.
 typedef struct {
-    int x, z;
-    Aabb aabb;
-    Mesh mesh;
-    bool mesh_dirty;
+    // Chunks and triangles skipped because they were behind the blocks
+    // already drawn.
+    _Atomic uint32_t occluded_chunks_number;
+    _Atomic uint32_t occluded_triangles_number;
+    // One per render thread, kept between the frames. The renders of the other
+    // views run at the same time and use their own.
+    FrameArena render_arenas[WORLD_RENDER_THREADS_NUMBER];
+    // Sum of the peak sizes of the render arenas, in KiB.
+    _Atomic uint32_t render_arenas_peak_size;
 #ifndef __wasm__
-    pthread_mutex_t mesh_mutex;
+    // Share of the render spent rendering chunks by each of its threads, in
+    // per mille.
+    _Atomic uint16_t render_thread_usages[WORLD_RENDER_THREADS_NUMBER];
 #endif
-    bool loaded_by[4];
-    Block blocks[CHUNK_SIZE][CHUNK_HEIGHT][CHUNK_SIZE];  // blocks[x][y][z]
-} Chunk;
+} WorldView;
 
 typedef struct {
-    Chunk *chunks[WORLD_SIZE][WORLD_SIZE];  // chunks[x][z]
+    ChunkMap chunks;
+    ChunkPool chunk_pool;
+#ifndef __wasm__
+    ChunkStorage chunk_storage;
+#endif
+    ChunkGenerator chunk_generator;
+    ChunkMesher chunk_mesher;
+    ChunkArray generated_chunks;
     uint32_t seed;
     BlockType place_block;
+    WorldView views[WORLD_VIEWS_NUMBER];
 } World;
 
 [[gnu::returns_nonnull]]
@@ -35,8 +52,13 @@ World *world_create(const uint32_t seed);
 [[gnu::nonnull]]
 void world_destroy(World *const self);
 
+// Collect the chunks generated in the background.
 [[gnu::nonnull]]
-void world_render(const World *const restrict self,
+void world_update(World *const self);
+
+// Several views can be rendered at the same time, each in its own thread.
+[[gnu::nonnull]]
+void world_render(World *const restrict self, const uint8_t view_index,
                   const Camera *const restrict camera,
                   const Viewport *const restrict viewport);
 
@@ -44,11 +66,20 @@ void world_render(const World *const restrict self,
 Chunk *world_get_chunk(const World *const self, const int x, const int z);
 
 [[gnu::nonnull(1)]]
-Block *world_get_block(const World *const self, const v3i block_position);
+Block world_get_block(const World *const self, const v3i block_position);
+
+// Return the y above the highest block of the column, 0 if it is empty.
+[[gnu::nonnull]]
+int world_get_height(const World *const self, const int x, const int z);
 
+// Blocks in chunks which are still pending are considered solid.
 [[gnu::nonnull(1)]]
 bool world_block_is_solid(const World *const self, const v3i block_position);
 
+[[gnu::nonnull(1)]]
+bool world_block_is_generated(const World *const self,
+                              const v3i block_position);
+
 v2i world_position_to_chunk_coordinate(const v3f position);
 
 [[gnu::nonnull(1)]]
@@ -1,18 +1,39 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include "log.h"
+#include "test_camera.h"
+#include "test_chunk.h"
+#include "test_chunk_map.h"
+#include "test_chunk_section.h"
+#include "test_chunk_storage.h"
 #include "test_event_queue.h"
+#include "test_frame_arena.h"
+#include "test_perlin_noise.h"
+#include "test_vertex_transform.h"
 #include "test_viewport.h"
 
 int main(void) {
+    // Some of the tested modules log.
+    logger_init("test");
+
     SRunner *const suite_runner = srunner_create(NULL);
     assert(suite_runner != NULL);
 
+    srunner_add_suite(suite_runner, camera_suite());
+    srunner_add_suite(suite_runner, chunk_suite());
+    srunner_add_suite(suite_runner, chunk_map_suite());
+    srunner_add_suite(suite_runner, chunk_section_suite());
+    srunner_add_suite(suite_runner, chunk_storage_suite());
     srunner_add_suite(suite_runner, event_queue_suite());
+    srunner_add_suite(suite_runner, frame_arena_suite());
+    srunner_add_suite(suite_runner, perlin_noise_suite());
+    srunner_add_suite(suite_runner, vertex_transform_suite());
     srunner_add_suite(suite_runner, viewport_suite());
 
     srunner_run_all(suite_runner, CK_NORMAL);
     const int number_tests_failed = srunner_ntests_failed(suite_runner);
     srunner_free(suite_runner);
+    log_quit();
     return number_tests_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,90 @@
+#include "test_camera.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "camera.h"
+#include "config.h"
+#include "test.h"
+
+static Camera camera;
+
+// Looking toward +z from the origin.
+static void setup(void) {
+    camera_init(&camera, (v3f){0.0f, 0.0f, 0.0f}, 0.0f, 0.0f, 200.0f / 60.0f,
+                0.5f);
+    camera_update_frustum_planes(&camera);
+}
+
+static uint8_t get_plane_bit(const Plane *const plane) {
+    return 1 << (plane - camera.frustum_planes.planes);
+}
+
+START_TEST(test_camera_aabb_in_frustum_inside) {
+    uint8_t plane_mask = UINT8_MAX;
+    const Aabb aabb = {{-0.5f, -0.5f, 10.0f}, {1.0f, 1.0f, 1.0f}};
+    ck_assert(camera_aabb_in_frustum(&camera, &aabb, &plane_mask));
+    ck_assert_uint_eq(plane_mask, 0);
+    ck_assert(camera_aabb_in_frustum(&camera, &aabb, NULL));
+}
+END_TEST
+
+START_TEST(test_camera_aabb_in_frustum_crossing) {
+    // Across the near plane only, close enough to the axis of the camera to be
+    // inside the side planes.
+    uint8_t plane_mask = 0;
+    const Aabb near_aabb = {
+        {-0.0005f, -0.0005f, CAMERA_Z_NEAR * 0.5f},
+        {0.001f, 0.001f, CAMERA_Z_NEAR},
+    };
+    ck_assert(camera_aabb_in_frustum(&camera, &near_aabb, &plane_mask));
+    ck_assert_uint_eq(plane_mask, get_plane_bit(&camera.frustum_planes.near));
+
+    // Across the far plane only.
+    const Aabb far_aabb = {
+        {-0.5f, -0.5f, CAMERA_Z_FAR - 0.5f},
+        {1.0f, 1.0f, 1.0f},
+    };
+    ck_assert(camera_aabb_in_frustum(&camera, &far_aabb, &plane_mask));
+    ck_assert_uint_eq(plane_mask, get_plane_bit(&camera.frustum_planes.far));
+
+    // Around the camera, across every plane but the far one.
+    const Aabb camera_aabb = {{-1.0f, -1.0f, -1.0f}, {2.0f, 2.0f, 2.0f}};
+    ck_assert(camera_aabb_in_frustum(&camera, &camera_aabb, &plane_mask));
+    ck_assert_uint_eq(plane_mask,
+                      CAMERA_FRUSTUM_PLANE_MASK_ALL &
+                          ~get_plane_bit(&camera.frustum_planes.far));
+}
+END_TEST
+
+START_TEST(test_camera_aabb_in_frustum_outside) {
+    const uint8_t unchanged = UINT8_MAX;
+    uint8_t plane_mask = unchanged;
+    const Aabb outside_aabbs[] = {
+        {{-0.5f, -0.5f, -10.0f}, {1.0f, 1.0f, 1.0f}},  // behind
+        {{-0.5f, -0.5f, CAMERA_Z_FAR + 1.0f}, {1.0f, 1.0f, 1.0f}},
+        {{-100.0f, -0.5f, 10.0f}, {1.0f, 1.0f, 1.0f}},  // on a side
+        {{-0.5f, 100.0f, 10.0f}, {1.0f, 1.0f, 1.0f}},   // above
+    };
+    for (size_t i = 0; i < sizeof(outside_aabbs) / sizeof(*outside_aabbs);
+         ++i) {
+        ck_assert(!camera_aabb_in_frustum(&camera, &outside_aabbs[i],
+                                          &plane_mask));
+        ck_assert_uint_eq(plane_mask, unchanged);
+    }
+}
+END_TEST
+
+// clang-format off
+TEST_SUITE(
+    camera,
+    TEST_CASE_WITH_SETUP(
+        "camera_aabb_in_frustum",
+        TEST(test_camera_aabb_in_frustum_inside)
+        TEST(test_camera_aabb_in_frustum_crossing)
+        TEST(test_camera_aabb_in_frustum_outside),
+        setup,
+        NULL
+    )
+)
+// clang-format on
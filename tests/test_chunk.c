@@ -0,0 +1,177 @@
+#include "test_chunk.h"
+
+#include <string.h>
+
+#include "chunk.h"
+#include "test.h"
+
+// The chunk and its neighbours on the -x and +x sides.
+static Chunk *chunk;
+static Chunk *left_chunk;
+static Chunk *right_chunk;
+
+static void setup(void) {
+    chunk = chunk_create(0, 0, 0);
+    left_chunk = chunk_create(-1, 0, 0);
+    right_chunk = chunk_create(1, 0, 0);
+    chunk_update_heightmap(chunk);
+    chunk_update_heightmap(left_chunk);
+    chunk_update_heightmap(right_chunk);
+}
+
+static void teardown(void) {
+    chunk_destroy(right_chunk);
+    chunk_destroy(left_chunk);
+    chunk_destroy(chunk);
+}
+
+// Whether the block at x of the row is solid, the blocks out of the chunk being
+// in its neighbours.
+static bool is_solid(const int x, const int y, const int z) {
+    if (x < 0) {
+        return chunk_get_block(left_chunk, x + CHUNK_SIZE, y, z) !=
+               BLOCK_TYPE_AIR;
+    }
+    if (x >= CHUNK_SIZE) {
+        return chunk_get_block(right_chunk, x - CHUNK_SIZE, y, z) !=
+               BLOCK_TYPE_AIR;
+    }
+    return chunk_get_block(chunk, x, y, z) != BLOCK_TYPE_AIR;
+}
+
+static void check_row_masks(const int y, const int z) {
+    const ChunkRowMask row = chunk_get_row_mask(chunk, y, z);
+    const ChunkRowMask left_neighbours = chunk_row_mask_left_neighbours(
+        row, chunk_get_row_mask(left_chunk, y, z));
+    const ChunkRowMask right_neighbours = chunk_row_mask_right_neighbours(
+        row, chunk_get_row_mask(right_chunk, y, z));
+    for (int x = 0; x < CHUNK_SIZE; ++x) {
+        ck_assert_int_eq(row >> x & 1, is_solid(x, y, z));
+        ck_assert_int_eq(left_neighbours >> x & 1, is_solid(x - 1, y, z));
+        ck_assert_int_eq(right_neighbours >> x & 1, is_solid(x + 1, y, z));
+    }
+    ck_assert_int_eq(row & ~CHUNK_ROW_MASK_FULL, 0);
+    ck_assert_int_eq(left_neighbours & ~CHUNK_ROW_MASK_FULL, 0);
+    ck_assert_int_eq(right_neighbours & ~CHUNK_ROW_MASK_FULL, 0);
+}
+
+START_TEST(test_chunk_row_masks) {
+    // Rows with blocks on the borders of the chunk and of its neighbours, in
+    // every combination, and a full row.
+    static_assert(CHUNK_SIZE >= 16);
+    const int y = 10;
+    for (int z = 0; z < 16; ++z) {
+        if (z & 1) chunk_set_block(chunk, 0, y, z, BLOCK_TYPE_STONE);
+        if (z & 2) {
+            chunk_set_block(chunk, CHUNK_SIZE - 1, y, z, BLOCK_TYPE_DIRT);
+        }
+        if (z & 4) {
+            chunk_set_block(left_chunk, CHUNK_SIZE - 1, y, z, BLOCK_TYPE_STONE);
+        }
+        if (z & 8) chunk_set_block(right_chunk, 0, y, z, BLOCK_TYPE_STONE);
+        chunk_set_block(chunk, z, y, z, BLOCK_TYPE_GRASS);
+    }
+    for (int x = 0; x < CHUNK_SIZE; ++x) {
+        chunk_set_block(chunk, x, 11, 0, BLOCK_TYPE_STONE);
+        chunk_set_block(left_chunk, x, 11, 0, BLOCK_TYPE_STONE);
+        chunk_set_block(right_chunk, x, 11, 0, BLOCK_TYPE_STONE);
+    }
+    // A block removed on a border.
+    chunk_set_block(chunk, 0, 11, 0, BLOCK_TYPE_AIR);
+
+    for (int y = 9; y <= 12; ++y) {
+        for (int z = 0; z < CHUNK_SIZE; ++z) check_row_masks(y, z);
+    }
+
+    // The occupancy computed from the blocks is the one kept by
+    // chunk_set_block().
+    ChunkRowMask occupancy[CHUNK_HEIGHT][CHUNK_SIZE];
+    memcpy(occupancy, chunk->occupancy, sizeof(occupancy));
+    chunk_update_occupancy(chunk);
+    ck_assert_mem_eq(chunk->occupancy, occupancy, sizeof(occupancy));
+}
+END_TEST
+
+// Check the column and the AABB, whose y is -1 when the chunk is empty, then
+// that chunk_update_heightmap() finds the same heightmap.
+static void check_heightmap(const int x, const int z, const int min_y,
+                            const int max_y, const int chunk_min_y,
+                            const int chunk_max_y) {
+    ck_assert_int_eq(chunk->heightmap[z][x].min_y, min_y);
+    ck_assert_int_eq(chunk->heightmap[z][x].max_y, max_y);
+    ck_assert_int_eq(chunk_get_height(chunk, x, z), max_y + 1);
+
+    if (chunk_max_y < 0) {
+        ck_assert_float_eq(chunk->aabb.position.y, -1.0f);
+        ck_assert_float_eq(chunk->aabb.size.y, -1.0f);
+    } else {
+        ck_assert_float_eq(chunk->aabb.position.y, chunk_min_y);
+        ck_assert_float_eq(chunk->aabb.size.y, chunk_max_y + 1 - chunk_min_y);
+    }
+
+    ChunkHeight heightmap[CHUNK_SIZE][CHUNK_SIZE];
+    memcpy(heightmap, chunk->heightmap, sizeof(heightmap));
+    const Aabb aabb = chunk->aabb;
+    chunk_update_heightmap(chunk);
+    ck_assert_mem_eq(chunk->heightmap, heightmap, sizeof(heightmap));
+    ck_assert_float_eq(chunk->aabb.position.y, aabb.position.y);
+    ck_assert_float_eq(chunk->aabb.size.y, aabb.size.y);
+}
+
+START_TEST(test_chunk_heightmap) {
+    check_heightmap(3, 5, CHUNK_HEIGHT, -1, CHUNK_HEIGHT, -1);
+
+    chunk_set_block(chunk, 3, 50, 5, BLOCK_TYPE_STONE);
+    check_heightmap(3, 5, 50, 50, 50, 50);
+    chunk_set_block(chunk, 3, 20, 5, BLOCK_TYPE_STONE);
+    check_heightmap(3, 5, 20, 50, 20, 50);
+    chunk_set_block(chunk, 3, 80, 5, BLOCK_TYPE_DIRT);
+    check_heightmap(3, 5, 20, 80, 20, 80);
+    chunk_set_block(chunk, 3, 60, 5, BLOCK_TYPE_DIRT);
+    check_heightmap(3, 5, 20, 80, 20, 80);
+    chunk_set_block(chunk, 10, 5, 1, BLOCK_TYPE_STONE);
+    check_heightmap(10, 1, 5, 5, 5, 80);
+
+    // Removing the block in the middle keeps the heights, removing the top or
+    // the bottom one finds the next.
+    chunk_set_block(chunk, 3, 60, 5, BLOCK_TYPE_AIR);
+    check_heightmap(3, 5, 20, 80, 5, 80);
+    chunk_set_block(chunk, 3, 80, 5, BLOCK_TYPE_AIR);
+    check_heightmap(3, 5, 20, 50, 5, 50);
+    chunk_set_block(chunk, 3, 20, 5, BLOCK_TYPE_AIR);
+    check_heightmap(3, 5, 50, 50, 5, 50);
+    // Removing air changes nothing.
+    chunk_set_block(chunk, 3, 21, 5, BLOCK_TYPE_AIR);
+    check_heightmap(3, 5, 50, 50, 5, 50);
+
+    // The emptied columns are cleared.
+    chunk_set_block(chunk, 3, 50, 5, BLOCK_TYPE_AIR);
+    check_heightmap(3, 5, CHUNK_HEIGHT, -1, 5, 5);
+    chunk_set_block(chunk, 10, 5, 1, BLOCK_TYPE_AIR);
+    check_heightmap(10, 1, CHUNK_HEIGHT, -1, CHUNK_HEIGHT, -1);
+
+    // The bottom and the top of the chunk.
+    chunk_set_block(chunk, 0, CHUNK_HEIGHT - 1, 0, BLOCK_TYPE_STONE);
+    check_heightmap(0, 0, CHUNK_HEIGHT - 1, CHUNK_HEIGHT - 1,
+                    CHUNK_HEIGHT - 1, CHUNK_HEIGHT - 1);
+    chunk_set_block(chunk, 0, 0, 0, BLOCK_TYPE_BEDROCK);
+    check_heightmap(0, 0, 0, CHUNK_HEIGHT - 1, 0, CHUNK_HEIGHT - 1);
+    chunk_set_block(chunk, 0, CHUNK_HEIGHT - 1, 0, BLOCK_TYPE_AIR);
+    check_heightmap(0, 0, 0, 0, 0, 0);
+    chunk_set_block(chunk, 0, 0, 0, BLOCK_TYPE_AIR);
+    check_heightmap(0, 0, CHUNK_HEIGHT, -1, CHUNK_HEIGHT, -1);
+}
+END_TEST
+
+// clang-format off
+TEST_SUITE(
+    chunk,
+    TEST_CASE_WITH_SETUP(
+        "chunk",
+        TEST(test_chunk_row_masks)
+        TEST(test_chunk_heightmap),
+        setup,
+        teardown
+    )
+)
+// clang-format on
@@ -0,0 +1,134 @@
+#include "test_chunk_map.h"
+
+#include <stdint.h>
+
+#include "chunk_map.h"
+#include "test.h"
+
+// The map only stores the pointers, so fake chunks are enough.
+#define fake_chunk(x, z) ((Chunk *)(uintptr_t)(((x) + 1000) * 4096 + (z) + 1000))
+
+static ChunkMap chunk_map;
+
+static void setup(void) {
+    chunk_map_init(&chunk_map, 4);
+}
+
+static void teardown(void) {
+    chunk_map_destroy(&chunk_map);
+}
+
+START_TEST(test_chunk_map_get_missing) {
+    ck_assert_ptr_null(chunk_map_get(&chunk_map, 0, 0));
+    ck_assert_ptr_null(chunk_map_remove(&chunk_map, 0, 0));
+    ck_assert_int_eq(chunk_map.length, 0);
+}
+END_TEST
+
+START_TEST(test_chunk_map_insert_and_get) {
+    chunk_map_insert(&chunk_map, 0, 0, fake_chunk(0, 0));
+    chunk_map_insert(&chunk_map, -1, 0, fake_chunk(-1, 0));
+    chunk_map_insert(&chunk_map, 0, -1, fake_chunk(0, -1));
+
+    ck_assert_int_eq(chunk_map.length, 3);
+    ck_assert_ptr_eq(chunk_map_get(&chunk_map, 0, 0), fake_chunk(0, 0));
+    ck_assert_ptr_eq(chunk_map_get(&chunk_map, -1, 0), fake_chunk(-1, 0));
+    ck_assert_ptr_eq(chunk_map_get(&chunk_map, 0, -1), fake_chunk(0, -1));
+    ck_assert_ptr_null(chunk_map_get(&chunk_map, 1, 1));
+}
+END_TEST
+
+START_TEST(test_chunk_map_grow) {
+    for (int x = -20; x < 20; ++x) {
+        for (int z = -20; z < 20; ++z) {
+            chunk_map_insert(&chunk_map, x, z, fake_chunk(x, z));
+        }
+    }
+
+    ck_assert_int_eq(chunk_map.length, 40 * 40);
+    ck_assert_int_le(chunk_map.length * 2, chunk_map.capacity);
+
+    for (int x = -20; x < 20; ++x) {
+        for (int z = -20; z < 20; ++z) {
+            ck_assert_ptr_eq(chunk_map_get(&chunk_map, x, z),
+                             fake_chunk(x, z));
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_chunk_map_remove) {
+    for (int x = -20; x < 20; ++x) {
+        for (int z = -20; z < 20; ++z) {
+            chunk_map_insert(&chunk_map, x, z, fake_chunk(x, z));
+        }
+    }
+
+    // Remove every other chunk, the remaining ones must still be reachable.
+    for (int x = -20; x < 20; ++x) {
+        for (int z = -20; z < 20; ++z) {
+            if ((x + z) % 2 != 0) continue;
+            ck_assert_ptr_eq(chunk_map_remove(&chunk_map, x, z),
+                             fake_chunk(x, z));
+        }
+    }
+
+    ck_assert_int_eq(chunk_map.length, 40 * 40 / 2);
+
+    for (int x = -20; x < 20; ++x) {
+        for (int z = -20; z < 20; ++z) {
+            if ((x + z) % 2 == 0) {
+                ck_assert_ptr_null(chunk_map_get(&chunk_map, x, z));
+            } else {
+                ck_assert_ptr_eq(chunk_map_get(&chunk_map, x, z),
+                                 fake_chunk(x, z));
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_chunk_map_reinsert) {
+    // Simulate a player walking in a straight line: load the front column and
+    // unload the back one, the map must not grow.
+    for (int z = -7; z <= 7; ++z) {
+        for (int x = -7; x <= 7; ++x) {
+            chunk_map_insert(&chunk_map, x, z, fake_chunk(x, z));
+        }
+    }
+    const size_t capacity = chunk_map.capacity;
+
+    for (int step = 0; step < 100; ++step) {
+        for (int z = -7; z <= 7; ++z) {
+            ck_assert_ptr_eq(chunk_map_remove(&chunk_map, step - 7, z),
+                             fake_chunk(step - 7, z));
+            chunk_map_insert(&chunk_map, step + 8, z, fake_chunk(step + 8, z));
+        }
+    }
+
+    ck_assert_int_eq(chunk_map.length, 15 * 15);
+    ck_assert_int_eq(chunk_map.capacity, capacity);
+    for (int z = -7; z <= 7; ++z) {
+        for (int x = 93; x <= 107; ++x) {
+            ck_assert_ptr_eq(chunk_map_get(&chunk_map, x, z),
+                             fake_chunk(x, z));
+        }
+    }
+}
+END_TEST
+
+// clang-format off
+TEST_SUITE(
+    chunk_map,
+    TEST_CASE_WITH_SETUP(
+        "chunk_map",
+        TEST(test_chunk_map_get_missing)
+        TEST(test_chunk_map_insert_and_get)
+        TEST(test_chunk_map_grow)
+        TEST(test_chunk_map_remove)
+        TEST(test_chunk_map_reinsert),
+        setup,
+        teardown
+    )
+)
+// clang-format on
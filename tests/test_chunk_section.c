@@ -0,0 +1,146 @@
+#include "test_chunk_section.h"
+
+#include "chunk_section.h"
+#include "test.h"
+
+static ChunkSection chunk_section;
+
+static void setup(void) {
+    chunk_section_init(&chunk_section, BLOCK_TYPE_AIR);
+}
+
+static void teardown(void) {
+    chunk_section_destroy(&chunk_section);
+}
+
+START_TEST(test_chunk_section_uniform) {
+    ck_assert(chunk_section_is_uniform(&chunk_section));
+    ck_assert(chunk_section_is_empty(&chunk_section));
+    ck_assert_ptr_null(chunk_section.data);
+    ck_assert_int_eq(chunk_section_get_block(&chunk_section,
+                                             chunk_section_index(3, 7, 11)),
+                     BLOCK_TYPE_AIR);
+
+    // Setting the same block keeps the section uniform.
+    chunk_section_set_block(&chunk_section, chunk_section_index(3, 7, 11),
+                            BLOCK_TYPE_AIR);
+    ck_assert(chunk_section_is_uniform(&chunk_section));
+}
+END_TEST
+
+START_TEST(test_chunk_section_fill) {
+    BlockType blocks[CHUNK_SECTION_VOLUME];
+    for (size_t i = 0; i < CHUNK_SECTION_VOLUME; ++i) {
+        blocks[i] = BLOCK_TYPE_STONE;
+    }
+    chunk_section_fill(&chunk_section, blocks);
+    ck_assert(chunk_section_is_uniform(&chunk_section));
+    ck_assert(!chunk_section_is_empty(&chunk_section));
+
+    for (size_t i = 0; i < CHUNK_SECTION_VOLUME; ++i) {
+        blocks[i] = i % 3 == 0 ? BLOCK_TYPE_DIRT : (BlockType)(i % 5);
+    }
+    chunk_section_fill(&chunk_section, blocks);
+    ck_assert(!chunk_section_is_uniform(&chunk_section));
+    ck_assert_int_eq(chunk_section.bits_per_block, 4);
+    for (size_t i = 0; i < CHUNK_SECTION_VOLUME; ++i) {
+        ck_assert_int_eq(chunk_section_get_block(&chunk_section, i),
+                         blocks[i]);
+    }
+}
+END_TEST
+
+START_TEST(test_chunk_section_set_block) {
+    // Adding block types must grow the indices without losing blocks.
+    for (BlockType type = 1; type < BLOCK_TYPE_COUNT; ++type) {
+        for (int x = 0; x < CHUNK_SIZE; ++x) {
+            chunk_section_set_block(&chunk_section,
+                                    chunk_section_index(x, type, x), type);
+        }
+    }
+    ck_assert_int_eq(chunk_section.palette_length, BLOCK_TYPE_COUNT);
+    ck_assert_int_eq(chunk_section.block_count,
+                     CHUNK_SIZE * (BLOCK_TYPE_COUNT - 1));
+
+    for (int y = 0; y < CHUNK_SECTION_HEIGHT; ++y) {
+        for (int z = 0; z < CHUNK_SIZE; ++z) {
+            for (int x = 0; x < CHUNK_SIZE; ++x) {
+                const BlockType expected =
+                    x == z && 0 < y && y < BLOCK_TYPE_COUNT ? (BlockType)y
+                                                            : BLOCK_TYPE_AIR;
+                ck_assert_int_eq(
+                    chunk_section_get_block(&chunk_section,
+                                            chunk_section_index(x, y, z)),
+                    expected);
+            }
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_chunk_section_serialize) {
+    uint8_t buffer[CHUNK_SECTION_MAX_SERIALIZED_SIZE];
+    ck_assert_int_eq(chunk_section_serialize(&chunk_section, buffer), 2);
+
+    for (int x = 0; x < CHUNK_SIZE; ++x) {
+        chunk_section_set_block(&chunk_section, chunk_section_index(x, 0, x),
+                                BLOCK_TYPE_SAND);
+    }
+    const size_t size = chunk_section_serialize(&chunk_section, buffer);
+
+    ChunkSection section;
+    chunk_section_init(&section, BLOCK_TYPE_STONE);
+    ck_assert_int_eq(chunk_section_deserialize(&section, buffer, size), size);
+    for (size_t i = 0; i < CHUNK_SECTION_VOLUME; ++i) {
+        ck_assert_int_eq(chunk_section_get_block(&section, i),
+                         chunk_section_get_block(&chunk_section, i));
+    }
+
+    // Truncated data and unknown block types are rejected.
+    ck_assert_int_eq(chunk_section_deserialize(&section, buffer, size - 1), 0);
+    buffer[0] = 1;
+    buffer[1] = BLOCK_TYPE_COUNT;
+    ck_assert_int_eq(chunk_section_deserialize(&section, buffer, size), 0);
+    chunk_section_destroy(&section);
+}
+END_TEST
+
+START_TEST(test_chunk_section_block_count) {
+    chunk_section_set_block(&chunk_section, chunk_section_index(1, 2, 3),
+                            BLOCK_TYPE_STONE);
+    chunk_section_set_block(&chunk_section, chunk_section_index(4, 5, 6),
+                            BLOCK_TYPE_DIRT);
+    ck_assert_int_eq(chunk_section.block_count, 2);
+
+    chunk_section_set_block(&chunk_section, chunk_section_index(1, 2, 3),
+                            BLOCK_TYPE_SAND);
+    ck_assert_int_eq(chunk_section.block_count, 2);
+
+    // An emptied section is freed.
+    chunk_section_set_block(&chunk_section, chunk_section_index(1, 2, 3),
+                            BLOCK_TYPE_AIR);
+    chunk_section_set_block(&chunk_section, chunk_section_index(4, 5, 6),
+                            BLOCK_TYPE_AIR);
+    ck_assert(chunk_section_is_empty(&chunk_section));
+    ck_assert_ptr_null(chunk_section.data);
+
+    chunk_section_clear(&chunk_section, BLOCK_TYPE_STONE);
+    ck_assert_int_eq(chunk_section.block_count, CHUNK_SECTION_VOLUME);
+}
+END_TEST
+
+// clang-format off
+TEST_SUITE(
+    chunk_section,
+    TEST_CASE_WITH_SETUP(
+        "chunk_section",
+        TEST(test_chunk_section_uniform)
+        TEST(test_chunk_section_fill)
+        TEST(test_chunk_section_set_block)
+        TEST(test_chunk_section_block_count)
+        TEST(test_chunk_section_serialize),
+        setup,
+        teardown
+    )
+)
+// clang-format on
@@ -0,0 +1,4 @@
+#include <check.h>
+
+[[gnu::returns_nonnull]]
+Suite *chunk_section_suite(void);
@@ -0,0 +1,276 @@
+#include "test_chunk_storage.h"
+
+#include <dirent.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "chunk.h"
+#include "chunk_storage.h"
+#include "config.h"
+#include "test.h"
+
+#define DATA_MAX_SIZE 1024
+#define SEED 1234
+
+static void check_round_trip(const uint8_t *const data, const size_t size) {
+    uint8_t compressed[DATA_MAX_SIZE + DATA_MAX_SIZE / 128 + 1];
+    const size_t compressed_size =
+        chunk_storage_compress(data, size, compressed);
+    ck_assert_uint_le(compressed_size, size + size / 128 + 1);
+
+    uint8_t decompressed[DATA_MAX_SIZE];
+    ck_assert_uint_eq(chunk_storage_decompress(compressed, compressed_size,
+                                               decompressed, size),
+                      size);
+    ck_assert_mem_eq(decompressed, data, size);
+}
+
+// A run of length bytes between two different bytes.
+static void check_run(const size_t length) {
+    uint8_t data[DATA_MAX_SIZE];
+    data[0] = 1;
+    memset(&data[1], 7, length);
+    data[length + 1] = 2;
+    check_round_trip(data, length + 2);
+    // Alone.
+    check_round_trip(&data[1], length);
+}
+
+START_TEST(test_chunk_storage_compress_runs) {
+    check_run(1);
+    check_run(2);
+    check_run(3);
+    check_run(127);
+    check_run(128);
+    check_run(129);
+    check_run(130);
+    check_run(257);
+
+    // A run of 3 bytes takes 2, a run of 128 too.
+    uint8_t data[128];
+    memset(data, 7, sizeof(data));
+    uint8_t compressed[2];
+    ck_assert_uint_eq(chunk_storage_compress(data, 3, compressed), 2);
+    ck_assert_uint_eq(chunk_storage_compress(data, 128, compressed), 2);
+}
+END_TEST
+
+START_TEST(test_chunk_storage_compress_literals) {
+    uint8_t data[DATA_MAX_SIZE];
+    for (size_t i = 0; i < DATA_MAX_SIZE; ++i) data[i] = i % 251;
+
+    check_round_trip(data, 1);
+    check_round_trip(data, 127);
+    check_round_trip(data, 128);
+    check_round_trip(data, 129);
+    check_round_trip(data, 256);
+    check_round_trip(data, DATA_MAX_SIZE);
+
+    // A literal run holds at most 128 bytes.
+    uint8_t compressed[DATA_MAX_SIZE + DATA_MAX_SIZE / 128 + 1];
+    ck_assert_uint_eq(chunk_storage_compress(data, 128, compressed), 129);
+    ck_assert_uint_eq(compressed[0], 127);
+    ck_assert_uint_eq(chunk_storage_compress(data, 129, compressed), 131);
+
+    // Literals mixed with runs.
+    for (size_t i = 0; i < DATA_MAX_SIZE; ++i) data[i] = i / 5 % 3 ? i : 0;
+    check_round_trip(data, DATA_MAX_SIZE);
+}
+END_TEST
+
+START_TEST(test_chunk_storage_decompress_invalid) {
+    uint8_t buffer[DATA_MAX_SIZE];
+
+    // The header 128 is not used.
+    const uint8_t no_op[] = {128, 0};
+    ck_assert_uint_eq(
+        chunk_storage_decompress(no_op, sizeof(no_op), buffer, sizeof(buffer)),
+        0);
+
+    // Truncated literals and runs.
+    const uint8_t literals[] = {3, 1, 2, 3};
+    ck_assert_uint_eq(chunk_storage_decompress(literals, sizeof(literals),
+                                               buffer, sizeof(buffer)),
+                      0);
+    const uint8_t run[] = {0, 1, 250};
+    ck_assert_uint_eq(
+        chunk_storage_decompress(run, sizeof(run), buffer, sizeof(buffer)), 0);
+
+    // Larger than the buffer.
+    const uint8_t large_run[] = {129, 7};
+    ck_assert_uint_eq(chunk_storage_decompress(large_run, sizeof(large_run),
+                                               buffer, 127),
+                      0);
+    ck_assert_uint_eq(chunk_storage_decompress(large_run, sizeof(large_run),
+                                               buffer, 128),
+                      128);
+}
+END_TEST
+
+#define DIRECTORY_TEMPLATE "/tmp/test_chunk_storage.XXXXXX"
+
+static char directory[sizeof(DIRECTORY_TEMPLATE)];
+static char previous_directory[PATH_MAX];
+
+// The saves are written in a temporary directory.
+static void setup(void) {
+    ck_assert_ptr_nonnull(getcwd(previous_directory,
+                                 sizeof(previous_directory)));
+    memcpy(directory, DIRECTORY_TEMPLATE, sizeof(directory));
+    ck_assert_ptr_nonnull(mkdtemp(directory));
+    ck_assert_int_eq(chdir(directory), 0);
+}
+
+static void teardown(void) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%u", CHUNK_STORAGE_DIRECTORY, SEED);
+    DIR *const saves = opendir(path);
+    if (saves != NULL) {
+        const struct dirent *entry;
+        while ((entry = readdir(saves)) != NULL) {
+            if (entry->d_name[0] == '.') continue;
+            char file_path[PATH_MAX];
+            snprintf(file_path, sizeof(file_path), "%s/%s", path,
+                     entry->d_name);
+            unlink(file_path);
+        }
+        closedir(saves);
+    }
+    rmdir(path);
+    rmdir(CHUNK_STORAGE_DIRECTORY);
+    ck_assert_int_eq(chdir(previous_directory), 0);
+    ck_assert_int_eq(rmdir(directory), 0);
+}
+
+// Blocks up to the height, different for each pattern.
+static void fill_chunk(Chunk *const chunk, const int height,
+                       const int pattern) {
+    chunk_update_heightmap(chunk);
+    for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+        for (int z = 0; z < CHUNK_SIZE; ++z) {
+            for (int x = 0; x < CHUNK_SIZE; ++x) {
+                const BlockType type =
+                    y < height ? 1 + (x * 7 + y * 3 + z * 5 + pattern) %
+                                         (BLOCK_TYPE_COUNT - 1)
+                               : BLOCK_TYPE_AIR;
+                chunk_set_block(chunk, x, y, z, type);
+            }
+        }
+    }
+    chunk->pending = false;
+}
+
+static void check_chunk(ChunkStorage *const storage, const int x, const int z,
+                        const int height, const int pattern) {
+    Chunk *const expected = chunk_create(x, z, 0);
+    fill_chunk(expected, height, pattern);
+    Chunk *const chunk = chunk_create(x, z, 0);
+    ck_assert(chunk_storage_load(storage, chunk));
+    for (int y = 0; y < CHUNK_HEIGHT; ++y) {
+        for (int block_z = 0; block_z < CHUNK_SIZE; ++block_z) {
+            for (int block_x = 0; block_x < CHUNK_SIZE; ++block_x) {
+                ck_assert_int_eq(
+                    chunk_get_block(chunk, block_x, y, block_z),
+                    chunk_get_block(expected, block_x, y, block_z));
+            }
+        }
+    }
+    chunk_destroy(chunk);
+    chunk_destroy(expected);
+}
+
+static void save_chunk(ChunkStorage *const storage, const int x, const int z,
+                       const int height, const int pattern) {
+    Chunk *const chunk = chunk_create(x, z, 0);
+    fill_chunk(chunk, height, pattern);
+    chunk_storage_save(storage, chunk);
+    chunk_destroy(chunk);
+}
+
+START_TEST(test_chunk_storage_region) {
+    ChunkStorage storage;
+    chunk_storage_init(&storage, SEED);
+    Chunk *const chunk = chunk_create(3, -2, 0);
+    ck_assert(!chunk_storage_load(&storage, chunk));
+    chunk_destroy(chunk);
+
+    // Chunks of the same region, and of the one before.
+    save_chunk(&storage, 3, -2, 40, 0);
+    save_chunk(&storage, 4, -2, 20, 1);
+    save_chunk(&storage, -1, 5, 10, 2);
+    chunk_storage_destroy(&storage);
+
+    chunk_storage_init(&storage, SEED);
+    check_chunk(&storage, 3, -2, 40, 0);
+    check_chunk(&storage, 4, -2, 20, 1);
+    check_chunk(&storage, -1, 5, 10, 2);
+
+    // The first chunk grows, then shrinks.
+    save_chunk(&storage, 3, -2, 100, 3);
+    chunk_storage_destroy(&storage);
+    chunk_storage_init(&storage, SEED);
+    check_chunk(&storage, 3, -2, 100, 3);
+    check_chunk(&storage, 4, -2, 20, 1);
+
+    save_chunk(&storage, 3, -2, 5, 4);
+    chunk_storage_destroy(&storage);
+    chunk_storage_init(&storage, SEED);
+    check_chunk(&storage, 3, -2, 5, 4);
+    check_chunk(&storage, 4, -2, 20, 1);
+    check_chunk(&storage, -1, 5, 10, 2);
+    chunk_storage_destroy(&storage);
+}
+END_TEST
+
+static size_t get_region_size(void) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%u/r.0.0.bin", CHUNK_STORAGE_DIRECTORY,
+             SEED);
+    struct stat file_stat;
+    ck_assert_int_eq(stat(path, &file_stat), 0);
+    return file_stat.st_size;
+}
+
+START_TEST(test_chunk_storage_region_compaction) {
+    ChunkStorage storage;
+    chunk_storage_init(&storage, SEED);
+    save_chunk(&storage, 1, 1, 30, 0);
+    save_chunk(&storage, 2, 1, 30, 1);
+    chunk_storage_destroy(&storage);
+    const size_t size = get_region_size();
+
+    // The previous versions don't accumulate.
+    chunk_storage_init(&storage, SEED);
+    for (int i = 0; i < 20; ++i) save_chunk(&storage, 1, 1, 30 + i % 2, i);
+    chunk_storage_destroy(&storage);
+    ck_assert_uint_le(get_region_size(), 3 * size);
+
+    chunk_storage_init(&storage, SEED);
+    check_chunk(&storage, 1, 1, 30 + 19 % 2, 19);
+    check_chunk(&storage, 2, 1, 30, 1);
+    chunk_storage_destroy(&storage);
+}
+END_TEST
+
+// clang-format off
+TEST_SUITE(
+    chunk_storage,
+    TEST_CASE(
+        "chunk_storage_compress",
+        TEST(test_chunk_storage_compress_runs)
+        TEST(test_chunk_storage_compress_literals)
+        TEST(test_chunk_storage_decompress_invalid)
+    )
+    TEST_CASE_WITH_SETUP(
+        "chunk_storage_region",
+        TEST(test_chunk_storage_region)
+        TEST(test_chunk_storage_region_compaction),
+        setup,
+        teardown
+    )
+)
+// clang-format on
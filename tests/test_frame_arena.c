@@ -0,0 +1,81 @@
+#include "test_frame_arena.h"
+
+#include <stdint.h>
+
+#include "frame_arena.h"
+#include "test.h"
+
+static FrameArena arena;
+
+static void setup(void) {
+    frame_arena_init(&arena, 256);
+}
+
+static void teardown(void) {
+    frame_arena_destroy(&arena);
+}
+
+START_TEST(test_frame_arena_alloc) {
+    char *const a = frame_arena_alloc(&arena, 1);
+    char *const b = frame_arena_alloc(&arena, 3);
+    ck_assert_uint_eq((uintptr_t)a % FRAME_ARENA_ALIGNMENT, 0);
+    ck_assert_uint_eq((uintptr_t)b % FRAME_ARENA_ALIGNMENT, 0);
+    ck_assert_ptr_eq(b, a + FRAME_ARENA_ALIGNMENT);
+    ck_assert_uint_eq(arena.size, 2 * FRAME_ARENA_ALIGNMENT);
+
+    // Larger than the blocks.
+    char *const c = frame_arena_alloc(&arena, 1000);
+    c[999] = 'c';
+    const size_t size = 2 * FRAME_ARENA_ALIGNMENT + FRAME_ARENA_ALIGN(1000);
+    ck_assert_uint_eq(arena.size, size);
+
+    frame_arena_reset(&arena);
+    ck_assert_uint_eq(arena.size, 0);
+    ck_assert_uint_eq(arena.peak_size, size);
+}
+END_TEST
+
+START_TEST(test_frame_arena_reset) {
+    for (int i = 0; i < 100; ++i) frame_arena_alloc(&arena, 64);
+    ck_assert_ptr_nonnull(arena.block->previous);
+    frame_arena_reset(&arena);
+
+    // The blocks are merged, the next frames fit in one.
+    ck_assert_ptr_null(arena.block->previous);
+    ck_assert_uint_eq(arena.block->capacity, 100 * FRAME_ARENA_ALIGN(64));
+    const FrameArenaBlock *const block = arena.block;
+    for (int i = 0; i < 100; ++i) frame_arena_alloc(&arena, 64);
+    ck_assert_ptr_eq(arena.block, block);
+    frame_arena_reset(&arena);
+    ck_assert_ptr_eq(arena.block, block);
+    ck_assert_uint_eq(arena.peak_size, 100 * FRAME_ARENA_ALIGN(64));
+}
+END_TEST
+
+START_TEST(test_frame_arena_resize) {
+    int *const a = frame_arena_alloc(&arena, sizeof(int));
+    *a = 42;
+    int *const b = frame_arena_resize(&arena, a, sizeof(int), 8 * sizeof(int));
+    ck_assert_ptr_eq(b, a);
+
+    frame_arena_alloc(&arena, 1);
+    int *const c = frame_arena_resize(&arena, b, 8 * sizeof(int),
+                                      16 * sizeof(int));
+    ck_assert_ptr_ne(c, b);
+    ck_assert_int_eq(*c, 42);
+}
+END_TEST
+
+// clang-format off
+TEST_SUITE(
+    frame_arena,
+    TEST_CASE_WITH_SETUP(
+        "frame_arena",
+        TEST(test_frame_arena_alloc)
+        TEST(test_frame_arena_reset)
+        TEST(test_frame_arena_resize),
+        setup,
+        teardown
+    )
+)
+// clang-format on
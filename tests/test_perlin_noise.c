@@ -0,0 +1,152 @@
+#include "test_perlin_noise.h"
+
+#include <math.h>
+#include <stdint.h>
+
+#include "perlin_noise.h"
+#include "test.h"
+
+#define GRID_MAX_SIZE 64
+#define TOLERANCE 1e-5f
+
+static void check_variant(const PerlinNoiseVariant variant, const v2i origin,
+                          const int width, const int height,
+                          const uint32_t seed, const float frequency,
+                          const uint8_t depth) {
+    float values[GRID_MAX_SIZE * GRID_MAX_SIZE];
+    perlin_noise_grid_with(variant, values, origin, width, height, seed,
+                           frequency, depth);
+    for (int z = 0; z < height; ++z) {
+        for (int x = 0; x < width; ++x) {
+            const float expected = perlin_noise(
+                (v2i){origin.x + x, origin.y + z}, seed, frequency, depth);
+            ck_assert_float_eq_tol(values[z * width + x], expected,
+                                   TOLERANCE);
+        }
+    }
+}
+
+static void check_grid(const v2i origin, const int width, const int height,
+                       const uint32_t seed, const float frequency,
+                       const uint8_t depth) {
+    // Every variant the CPU supports is checked against perlin_noise().
+    for (PerlinNoiseVariant variant = 0; variant < PERLIN_NOISE_VARIANT_COUNT;
+         ++variant) {
+        if (perlin_noise_is_supported(variant)) {
+            check_variant(variant, origin, width, height, seed, frequency,
+                          depth);
+        }
+    }
+}
+
+START_TEST(test_perlin_noise_grid_chunk) {
+    check_grid((v2i){0, 0}, 16, 16, 1234, 0.005f, 5);
+    check_grid((v2i){-32, 48}, 16, 16, 1234, 0.0025f, 1);
+    check_grid((v2i){160, -16}, 16, 16, 42, 0.1f, 1);
+}
+END_TEST
+
+START_TEST(test_perlin_noise_grid_lattice_borders) {
+    // The grid crosses lattice cells in both directions and around 0.
+    check_grid((v2i){-20, -20}, 40, 40, 7, 0.1f, 3);
+    check_grid((v2i){-1, -1}, 2, 2, 7, 0.5f, 2);
+}
+END_TEST
+
+START_TEST(test_perlin_noise_grid_odd_size) {
+    // The width is not a multiple of the vector size.
+    check_grid((v2i){3, -5}, 13, 5, 99, 0.05f, 4);
+    check_grid((v2i){-7, 11}, 1, 9, 99, 0.05f, 4);
+    check_grid((v2i){-9, 2}, 7, 3, 99, 0.2f, 3);
+    check_grid((v2i){25, -3}, 9, 4, 99, 0.3f, 2);
+    check_grid((v2i){-40, 17}, 31, 6, 99, 0.07f, 5);
+}
+END_TEST
+
+START_TEST(test_perlin_noise_grid_high_frequency) {
+    // Too many lattice points for the gradients table.
+    check_grid((v2i){-30, 10}, GRID_MAX_SIZE, GRID_MAX_SIZE, 5, 0.9f, 2);
+}
+END_TEST
+
+// Largest difference between the coarse and the full rate grids.
+static float coarse_grid_max_error(const v2i origin, const int width,
+                                   const int height, const uint32_t seed,
+                                   const float frequency, const uint8_t depth,
+                                   const int resolution) {
+    float values[GRID_MAX_SIZE * GRID_MAX_SIZE];
+    float coarse_values[GRID_MAX_SIZE * GRID_MAX_SIZE];
+    perlin_noise_grid(values, origin, width, height, seed, frequency, depth);
+    perlin_noise_grid_coarse(coarse_values, origin, width, height, seed,
+                             frequency, depth, resolution);
+    float max_error = 0.0f;
+    for (int i = 0; i < width * height; ++i) {
+        max_error = fmaxf(max_error, fabsf(values[i] - coarse_values[i]));
+    }
+    return max_error;
+}
+
+START_TEST(test_perlin_noise_grid_coarse_full_resolution) {
+    ck_assert_float_eq_tol(
+        coarse_grid_max_error((v2i){-16, 32}, 16, 16, 3, 0.1f, 2, 1), 0.0f,
+        TOLERANCE);
+}
+END_TEST
+
+START_TEST(test_perlin_noise_grid_coarse_lattice_points) {
+    // The coarse lattice is aligned on the world origin, so the samples on it
+    // are exact whatever the origin of the grid.
+    const v2i origin = {-13, 6};
+    const int resolution = 4;
+    float values[GRID_MAX_SIZE * GRID_MAX_SIZE];
+    perlin_noise_grid_coarse(values, origin, 32, 32, 11, 0.005f, 5,
+                             resolution);
+    for (int z = 0; z < 32; ++z) {
+        for (int x = 0; x < 32; ++x) {
+            const v2i position = {origin.x + x, origin.y + z};
+            if (position.x % resolution != 0 || position.y % resolution != 0) {
+                continue;
+            }
+            ck_assert_float_eq_tol(values[z * 32 + x],
+                                   perlin_noise(position, 11, 0.005f, 5),
+                                   TOLERANCE);
+        }
+    }
+}
+END_TEST
+
+START_TEST(test_perlin_noise_grid_coarse_quality) {
+    // Same layers as the terrain height and the desert.
+    for (int i = 0; i < 16; ++i) {
+        const v2i origin = {(i % 4 - 2) * GRID_MAX_SIZE,
+                            (i / 4 - 2) * GRID_MAX_SIZE};
+        ck_assert_float_le(
+            coarse_grid_max_error(origin, GRID_MAX_SIZE, GRID_MAX_SIZE, 1234,
+                                  0.005f, 5, 4),
+            0.01f);
+        ck_assert_float_le(
+            coarse_grid_max_error(origin, GRID_MAX_SIZE, GRID_MAX_SIZE, 1235,
+                                  0.0025f, 1, 16),
+            0.005f);
+    }
+}
+END_TEST
+
+// clang-format off
+TEST_SUITE(
+    perlin_noise,
+    TEST_CASE(
+        "perlin_noise_grid",
+        TEST(test_perlin_noise_grid_chunk)
+        TEST(test_perlin_noise_grid_lattice_borders)
+        TEST(test_perlin_noise_grid_odd_size)
+        TEST(test_perlin_noise_grid_high_frequency)
+    )
+    TEST_CASE(
+        "perlin_noise_grid_coarse",
+        TEST(test_perlin_noise_grid_coarse_full_resolution)
+        TEST(test_perlin_noise_grid_coarse_lattice_points)
+        TEST(test_perlin_noise_grid_coarse_quality)
+    )
+)
+// clang-format on
@@ -0,0 +1,120 @@
+#include "test_vertex_transform.h"
+
+#include <stddef.h>
+
+#include "camera.h"
+#include "test.h"
+#include "vec.h"
+#include "vertex_transform.h"
+
+#define VERTICES_MAX_NUMBER 64
+#define TOLERANCE 1e-3f
+
+[[gnu::nonnull]]
+static void check_variant(const VertexTransformVariant variant,
+                          const float *const xs, const float *const ys,
+                          const float *const zs, const size_t length,
+                          const m4f view_matrix, const Camera *const camera,
+                          const Viewport *const viewport) {
+    v4f view_vertices[VERTICES_MAX_NUMBER];
+    v4f screen_vertices[VERTICES_MAX_NUMBER];
+    vertex_transform_soa_with(variant, xs, ys, zs, length, view_matrix, camera,
+                              viewport, view_vertices, screen_vertices);
+
+    for (size_t i = 0; i < length; ++i) {
+        const v4f view_vertex =
+            mul_m4f_v3f(view_matrix, (v3f){xs[i], ys[i], zs[i]});
+        ck_assert_float_eq_tol(view_vertices[i].x, view_vertex.x, TOLERANCE);
+        ck_assert_float_eq_tol(view_vertices[i].y, view_vertex.y, TOLERANCE);
+        ck_assert_float_eq_tol(view_vertices[i].z, view_vertex.z, TOLERANCE);
+        ck_assert_float_eq_tol(view_vertices[i].w, view_vertex.w, TOLERANCE);
+
+        // The projection of the vertices behind the camera is not used.
+        if (view_vertex.z <= 0.0f) continue;
+        const v4f screen_vertex =
+            vertex_transform_project(view_vertex.xyz, camera, viewport);
+        ck_assert_float_eq_tol(screen_vertices[i].x, screen_vertex.x,
+                               TOLERANCE);
+        ck_assert_float_eq_tol(screen_vertices[i].y, screen_vertex.y,
+                               TOLERANCE);
+        ck_assert_float_eq_tol(screen_vertices[i].z, screen_vertex.z,
+                               TOLERANCE);
+        ck_assert_float_eq_tol(screen_vertices[i].w, screen_vertex.w,
+                               TOLERANCE);
+    }
+}
+
+static void check_vertices(const v3f position, const float yaw,
+                           const float pitch, const Viewport viewport,
+                           const size_t length) {
+    assert(length <= VERTICES_MAX_NUMBER);
+
+    Camera camera;
+    camera_init(&camera, position, yaw, pitch,
+                (float)viewport.width / viewport.height, 0.5f);
+    m4f view_matrix;
+    camera_get_view_matrix(&camera, view_matrix);
+
+    // A grid of vertices around the camera, some of them behind it.
+    float xs[VERTICES_MAX_NUMBER];
+    float ys[VERTICES_MAX_NUMBER];
+    float zs[VERTICES_MAX_NUMBER];
+    for (size_t i = 0; i < length; ++i) {
+        xs[i] = position.x + (float)(i % 4) * 3.0f - 4.5f;
+        ys[i] = position.y + (float)(i / 4 % 4) * 2.0f - 3.0f;
+        zs[i] = position.z + (float)(i / 16) * 5.0f + 2.5f;
+    }
+
+    // Every variant the CPU supports is checked against the scalar projection.
+    for (VertexTransformVariant variant = 0;
+         variant < VERTEX_TRANSFORM_VARIANT_COUNT; ++variant) {
+        if (vertex_transform_is_supported(variant)) {
+            check_variant(variant, xs, ys, zs, length, view_matrix, &camera,
+                          &viewport);
+        }
+    }
+}
+
+START_TEST(test_vertex_transform_soa_facing_forward) {
+    check_vertices((v3f){0.5f, 70.0f, 0.5f}, 0.0f, 0.0f,
+                   (Viewport){0, 0, 200, 60}, VERTICES_MAX_NUMBER);
+}
+END_TEST
+
+START_TEST(test_vertex_transform_soa_rotated) {
+    check_vertices((v3f){-120.25f, 40.0f, 300.75f}, 2.3f, -0.6f,
+                   (Viewport){0, 0, 200, 60}, VERTICES_MAX_NUMBER);
+    check_vertices((v3f){17.0f, 90.5f, -45.0f}, -0.8f, 0.4f,
+                   (Viewport){0, 0, 80, 40}, VERTICES_MAX_NUMBER);
+}
+END_TEST
+
+START_TEST(test_vertex_transform_soa_viewport_offset) {
+    check_vertices((v3f){3.0f, 65.0f, -8.0f}, 0.3f, -0.2f,
+                   (Viewport){100, 30, 100, 30}, VERTICES_MAX_NUMBER);
+}
+END_TEST
+
+START_TEST(test_vertex_transform_soa_odd_length) {
+    // The length is not a multiple of the vector size.
+    check_vertices((v3f){0.5f, 70.0f, 0.5f}, 0.3f, -0.2f,
+                   (Viewport){0, 0, 200, 60}, 1);
+    check_vertices((v3f){0.5f, 70.0f, 0.5f}, 0.3f, -0.2f,
+                   (Viewport){0, 0, 200, 60}, 7);
+    check_vertices((v3f){0.5f, 70.0f, 0.5f}, 0.3f, -0.2f,
+                   (Viewport){0, 0, 200, 60}, 13);
+}
+END_TEST
+
+// clang-format off
+TEST_SUITE(
+    vertex_transform,
+    TEST_CASE(
+        "vertex_transform_soa",
+        TEST(test_vertex_transform_soa_facing_forward)
+        TEST(test_vertex_transform_soa_rotated)
+        TEST(test_vertex_transform_soa_viewport_offset)
+        TEST(test_vertex_transform_soa_odd_length)
+    )
+)
+// clang-format on